@@ -29,7 +29,10 @@
 #include <iostream>
 #include <sstream>
 
+#include <algorithm>
+
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 
 #define CHECK_BIT(value, b) (((value) >> (b))&1)
@@ -50,10 +53,47 @@ struct CardContents {
 
 int main(int argc, char **argv)
 {
+    // optional extra keys dictionary and key statistics file
+    std::string keys_file;
+    std::string stats_file;
+    const char * home = getenv("HOME");
+    if (home != 0) {
+        stats_file = std::string(home) + "/.xpcsc-mifare-keys.stats";
+    }
+
+    for (int i=1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "-h") {
+            std::cout << "Usage:\n"
+                "    " << argv[0] << " [-h] [-k KEYS_FILE] [-s STATS_FILE]\n"
+                "\n"
+                "    -k  additional keys dictionary, one hex key per line\n"
+                "    -s  key hit statistics file, default is ~/.xpcsc-mifare-keys.stats" << std::endl;
+            return 0;
+        }
+        if (arg == "-k" && i + 1 < argc) {
+            keys_file = argv[++i];
+            continue;
+        }
+        if (arg == "-s" && i + 1 < argc) {
+            stats_file = argv[++i];
+            continue;
+        }
+        std::cerr << "Unknown argument: " << arg << std::endl;
+        return 1;
+    }
+
     xpcsc::Connection c;
 
+    // card image named by XPCSC_VIRTUAL_MIFARE replaces reader and card
+    xpcsc::VirtualMifareImageFile virtual_card;
     try {
-        c.init();
+        if (!virtual_card.attach(c)) {
+            c.init();
+        }
+    } catch (xpcsc::ConnectionError &e) {
+        std::cerr << "[E] " << e.what() << std::endl;
+        return 1;
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
         return 1;
@@ -96,35 +136,27 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    // template for Load Keys command
-    const xpcsc::Byte CMD_LOAD_KEYS[] = {0xFF, 0x82, 0x00, 0x00, 
-        0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-    // template for General Auth command
-    const xpcsc::Byte CMD_GENERAL_AUTH[] = {0xFF, 0x86, 0x00, 0x00, 
-        0x05, 0x01, 0x00, 0x00, 0x60, 0x00};
-
-    // template for Read Binary command
-    const xpcsc::Byte CMD_READ_BINARY[] = {0xFF, 0xB0, 0x00, 0x00, 0x10};
-
-    // standard keys
-    const size_t keys_number = 3;
-    xpcsc::Byte keys[keys_number][6] = {
-        {0xff, 0xff, 0xff, 0xff, 0xff, 0xff},  // NXP factory default key
-        {0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5},  // Infineon factory default key A
-        {0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5}  // Infineon factory default key B
-        // {0xd3, 0xf7, 0xd3, 0xf7, 0xd3, 0xf7},
-        // {0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff},
-        // {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
-    };
+    // candidate keys ordered by previous results for this card type
+    xpcsc::MifareKeySearch search;
+    if (keys_file.length() != 0) {
+        try {
+            size_t loaded = search.load_keys(keys_file);
+            std::cout << "Keys loaded from dictionary: " << loaded << std::endl;
+        } catch (xpcsc::MifareKeyDictionaryError &e) {
+            std::cerr << "[E] Cannot load keys dictionary: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (stats_file.length() != 0 && !search.load_stats(stats_file)) {
+        std::cerr << "[W] Broken key statistics file: " << stats_file << std::endl;
+    }
 
-    std::string str_keys[keys_number];
+    std::string family = xpcsc::format(atr);
+    family.erase(std::remove(family.begin(), family.end(), ' '), family.end());
 
-    for (size_t i=0; i<keys_number; i++) {
-        str_keys[i] = xpcsc::format(xpcsc::Bytes(keys[i], 6));
-    }
+    xpcsc::MifareClassicSession session(c, reader);
+    size_t keys_tried = 0;
 
-    xpcsc::Bytes command;
     xpcsc::Bytes response;
 
     CardContents card;
@@ -150,120 +182,78 @@ int main(int argc, char **argv)
     std::cout << "         ";
     for (size_t sector = 0; sector < 16; sector++) {
         xpcsc::Byte first_block = sector * 4;
-        size_t k;
+        xpcsc::MifareKeyType key_type;
+        xpcsc::Bytes key;
 
-        bool key_found = false;
+        // stops at first key that works
+        bool key_found = search.search(session, family, sector, key_type, key);
+        keys_tried += search.last_attempts();
 
-        for (k=0; k<keys_number; k++) {
-            // try to authenticate on first sector
-
-            // first load key into a terminal 
-            command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-            command.replace(5, 6, keys[k], 6);
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                // next key
-                continue;
+        if (!key_found) {
+            std::cout << "---- " << std::flush;        
+            for (size_t i=0; i<4; i++) {
+                size_t block = sector * 4 + i;
+                card.blocks_key_types[block] = Key_None;
             }
+            continue;
+        }
 
-            // usleep(1700000);
-
-            // authenticate as Key B
-            command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-            command[7] = first_block;
-            command[8] = 0x61;
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) == 0x9000) {
-                // success, try to read data from all blocks (for this sector only!):
-                for (size_t i=0; i<4; i++) {
-                    xpcsc::Byte block = first_block+i;
-                    command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-                    command[3] = block;
-                    c.transmit(reader, command, &response);
-                    if (c.response_status(response) != 0x9000) {
-                        // failed to read block
-                        // std::cerr << "[Failed read] Key B " << block << ", key: " << str_keys[k] << std::endl;
-                        return 1;
-                    } else {
-                        memcpy(card.blocks_keys[block], keys[k], 6);
-                        card.blocks_key_types[block] = Key_B;
-                        memcpy(card.blocks_data[block], response.data(), 16);
-                        key_found = true;
-                    }
-                }
+        for (size_t i=0; i<4; i++) {
+            xpcsc::Byte block = first_block+i;
+            card.blocks_key_types[block] = Key_None;
+            if (!session.read_block(block, response)) {
+                // failed to read block
+                continue;
             }
+            memcpy(card.blocks_keys[block], key.data(), 6);
+            card.blocks_key_types[block] = (key_type == xpcsc::MifareKeyA) ? Key_A : Key_B;
+            memcpy(card.blocks_data[block], response.data(), 16);
+        }
 
-            // usleep(1700000);
-
-            // authenticate as Key A
-            command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-            command[7] = first_block;
-            command[8] = 0x60;
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) == 0x9000) {
-                // success, try to read data from all blocks (for this sector only!):
-                for (size_t i=0; i<4; i++) {
-                    xpcsc::Byte block = first_block+i;
-                    command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-                    command[3] = block;
-                    c.transmit(reader, command, &response);
-                    if (c.response_status(response) != 0x9000) {
-                        // failed to read block
-                        // std::cerr << "[Failed read] Key A " << block << ", key: " << str_keys[k] << std::endl;
-                    } else {
-                        memcpy(card.blocks_keys[block], keys[k], 6);
-                        card.blocks_key_types[block] = Key_A;
-                        memcpy(card.blocks_data[block], response.data(), 16);
-                        key_found = true;
-                    }
-                }
-            }
+        std::cout << "++++ " << std::flush;        
 
-            if (key_found) {
-                break;
-            }
+        // access bits are known if sector trailer is read
+        if (card.blocks_key_types[first_block+3] == Key_None) {
+            continue;
         }
 
-        if (key_found) {
-            std::cout << "++++ " << std::flush;        
-            // read access bits
-            size_t block = sector * 4 + 3;
-            const xpcsc::Byte *sector_trailer = card.blocks_data[block];
-
-            xpcsc::Byte b7 = sector_trailer[7];
-            xpcsc::Byte b8 = sector_trailer[8];
+        // read access bits
+        size_t block = sector * 4 + 3;
+        const xpcsc::Byte *sector_trailer = card.blocks_data[block];
 
-            card.blocks_access_bits[block-3].is_set = true;
-            card.blocks_access_bits[block-3].C1 = CHECK_BIT(b7, 4);
-            card.blocks_access_bits[block-3].C2 = CHECK_BIT(b8, 0);
-            card.blocks_access_bits[block-3].C3 = CHECK_BIT(b8, 4);
+        xpcsc::Byte b7 = sector_trailer[7];
+        xpcsc::Byte b8 = sector_trailer[8];
 
-            card.blocks_access_bits[block-2].is_set = true;
-            card.blocks_access_bits[block-2].C1 = CHECK_BIT(b7, 5);
-            card.blocks_access_bits[block-2].C2 = CHECK_BIT(b8, 1);
-            card.blocks_access_bits[block-2].C3 = CHECK_BIT(b8, 5);
+        card.blocks_access_bits[block-3].is_set = true;
+        card.blocks_access_bits[block-3].C1 = CHECK_BIT(b7, 4);
+        card.blocks_access_bits[block-3].C2 = CHECK_BIT(b8, 0);
+        card.blocks_access_bits[block-3].C3 = CHECK_BIT(b8, 4);
 
-            card.blocks_access_bits[block-1].is_set = true;
-            card.blocks_access_bits[block-1].C1 = CHECK_BIT(b7, 6);
-            card.blocks_access_bits[block-1].C2 = CHECK_BIT(b8, 2);
-            card.blocks_access_bits[block-1].C3 = CHECK_BIT(b8, 6);
+        card.blocks_access_bits[block-2].is_set = true;
+        card.blocks_access_bits[block-2].C1 = CHECK_BIT(b7, 5);
+        card.blocks_access_bits[block-2].C2 = CHECK_BIT(b8, 1);
+        card.blocks_access_bits[block-2].C3 = CHECK_BIT(b8, 5);
 
-            card.blocks_access_bits[block].is_set = true;
-            card.blocks_access_bits[block].C1 = CHECK_BIT(b7, 7);
-            card.blocks_access_bits[block].C2 = CHECK_BIT(b8, 3);
-            card.blocks_access_bits[block].C3 = CHECK_BIT(b8, 7);
+        card.blocks_access_bits[block-1].is_set = true;
+        card.blocks_access_bits[block-1].C1 = CHECK_BIT(b7, 6);
+        card.blocks_access_bits[block-1].C2 = CHECK_BIT(b8, 2);
+        card.blocks_access_bits[block-1].C3 = CHECK_BIT(b8, 6);
 
-        } else {
-            std::cout << "---- " << std::flush;        
-            for (size_t i=0; i<4; i++) {
-                size_t block = sector * 4 + i;
-                card.blocks_key_types[block] = Key_None;
-            }
-        }
+        card.blocks_access_bits[block].is_set = true;
+        card.blocks_access_bits[block].C1 = CHECK_BIT(b7, 7);
+        card.blocks_access_bits[block].C2 = CHECK_BIT(b8, 3);
+        card.blocks_access_bits[block].C3 = CHECK_BIT(b8, 7);
     }
 
     std::cout << std::endl;
 
+    if (stats_file.length() != 0 && !search.save_stats(stats_file)) {
+        std::cerr << "[W] Failed to save key statistics: " << stats_file << std::endl;
+    }
+    std::cout << "Keys tried: " << keys_tried << " of " << search.size() << " in dictionary, "
+        << "APDUs sent: " << session.apdus_sent() << std::endl;
+    std::cout << std::endl;
+
     std::cout << "BLOCK|       DATA                                      | KEY                      | ACCESS BITS" << std::endl;
     std::cout << "     |                                                 |                          |  C1 C2 C3 " << std::endl;
 
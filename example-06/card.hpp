@@ -34,25 +34,20 @@ const uint8_t CARD_SECTOR  = 0x5;
 const uint8_t CARD_SECTOR_BLOCK = 0x2;
 const uint8_t CARD_BLOCK = ((CARD_SECTOR * 4) + CARD_SECTOR_BLOCK);
 const uint8_t CARD_SECTOR_TRAILER = ((CARD_SECTOR * 4) + 3);
+const uint8_t CARD_SECTOR_FIRST_BLOCK = (CARD_SECTOR * 4);
 const xpcsc::Byte DEFAULT_KEY_A[6] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 const xpcsc::Byte ACTIVE_KEY_A[6] = {0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
 const uint16_t INITIAL_BALANCE = 15000;
 const uint16_t TICKET_PRICE = 170;
 
-// template for Load Keys command
-const xpcsc::Byte CMD_LOAD_KEYS[] = {0xFF, 0x82, 0x00, 0x00, 
-    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-// template for General Auth command
-const xpcsc::Byte CMD_GENERAL_AUTH[] = {0xFF, 0x86, 0x00, 0x00, 
-    0x05, 0x01, 0x00, 0x00, 0x60, 0x00};
-
-// template for Read Binary command
-const xpcsc::Byte CMD_READ_BINARY[] = {0xFF, 0xB0, 0x00, 0x00, 0x10};
-
-// template for Update Binary command
-unsigned char CMD_UPDATE_BINARY[] = {0xFF, 0xD6, 0x00, 0x00, 0x10,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+// card image for mifare_write_image(): blocks up to CARD_SECTOR_TRAILER,
+// sector CARD_SECTOR holds "sector" data and all other blocks are zeroes
+inline xpcsc::Bytes card_image(const xpcsc::Bytes & sector)
+{
+    xpcsc::Bytes image((CARD_SECTOR_TRAILER + 1) * 16, 0);
+    image.replace(CARD_SECTOR * 4 * 16, 4 * 16, sector);
+    return image;
+}
 
 #define CHECK_BIT(value, b) (((value) >> (b))&1)
 
@@ -38,8 +38,15 @@ int main(int argc, char **argv)
 {
     xpcsc::Connection c;
 
+    // card image named by XPCSC_VIRTUAL_MIFARE replaces reader and card
+    xpcsc::VirtualMifareImageFile virtual_card;
     try {
-        c.init();
+        if (!virtual_card.attach(c)) {
+            c.init();
+        }
+    } catch (xpcsc::ConnectionError &e) {
+        std::cerr << "[E] " << e.what() << std::endl;
+        return 1;
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
         return 1;
@@ -80,84 +87,50 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
-
-    // load DEFAULT_KEY_A
-    command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-    command.replace(5, 6, DEFAULT_KEY_A, 6);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Failed to load key" << std::endl;
-        return 1;
-    }
+    xpcsc::MifareClassicSession session(c, reader);
+    xpcsc::Bytes sector;
 
-    // authenticate to access block CARD_BLOCK using loaded key as Key A 
-    command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-    command[7] = CARD_BLOCK;
-    command[8] = 0x60;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
+    // authenticate to access sector CARD_SECTOR using DEFAULT_KEY_A as Key A 
+    if (!session.authenticate(CARD_BLOCK, xpcsc::MifareKeyA, DEFAULT_KEY_A)) {
         std::cerr << "Cannot authenticate using DEFAULT_KEY_A!" << std::endl;
         return 1;
     }
 
-    // read block CARD_BLOCK and check it contains only zeroes
-    command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-    command[3] = CARD_BLOCK;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot read block!" << std::endl;
+    // read the whole sector, it is compared with the new contents later
+    if (!session.read_blocks(CARD_SECTOR_FIRST_BLOCK, 4, sector)) {
+        std::cerr << "Cannot read sector!" << std::endl;
         return 1;
     }
 
-    for (size_t i=0; i < 15; i++) {
-        if (response.at(i) != 0) {
+    // check block CARD_BLOCK contains only zeroes
+    for (size_t i=0; i < 16; i++) {
+        if (sector.at(CARD_SECTOR_BLOCK * 16 + i) != 0) {
             std::cerr << "Block must be filled with zeroes!" << std::endl;
             return 1;
         }
     }
 
-    // initial balance
-    uint16_t balance = INITIAL_BALANCE;
+    xpcsc::Bytes current = card_image(sector);
+    xpcsc::Bytes target = current;
 
-    // create block with balance, change first 2 bytes
-    xpcsc::Bytes balance_block(16, 0);
-    balance_block.replace(0, 2, (xpcsc::Byte*)&balance, 2);
+    // value block with initial balance
+    target.replace(CARD_BLOCK * 16, 16, xpcsc::mifare_value_block(INITIAL_BALANCE, CARD_BLOCK));
 
-    // update block
-    command.assign(CMD_UPDATE_BINARY, sizeof(CMD_UPDATE_BINARY));
-    command[3] = CARD_BLOCK;
-    command.replace(5, 16, balance_block.c_str(), 16);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot update block!" << std::endl;
-        return 1;
-    }
+    // trailer with a new Key A and Key B
+    target.replace(CARD_SECTOR_TRAILER * 16, 6, ACTIVE_KEY_A, 6);
+    target.replace(CARD_SECTOR_TRAILER * 16 + 10, 6, ACTIVE_KEY_A, 6);
 
-    // read sector trailer
-    command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-    command[3] = CARD_SECTOR_TRAILER;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot read block!" << std::endl;
-        return 1;
-    }
+    xpcsc::MifareCachedKeys keys(1);
+    keys[0].sector = CARD_SECTOR;
+    keys[0].key_type = xpcsc::MifareKeyA;
+    memcpy(keys[0].key, DEFAULT_KEY_A, 6);
 
-    // update trailer with a new Key A
-    xpcsc::Bytes trailer = response.substr(0, 16);
-    trailer.replace(0, 6, ACTIVE_KEY_A, 6);
-    trailer.replace(10, 6, ACTIVE_KEY_A, 6);
-
-    // update sector trailer
-    command.assign(CMD_UPDATE_BINARY, sizeof(CMD_UPDATE_BINARY));
-    command[3] = CARD_SECTOR_TRAILER;
-    command.replace(5, 16, trailer.c_str(), 16);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot update block!" << std::endl;
+    xpcsc::MifareWriteReport report;
+    if (!xpcsc::mifare_write_image(session, current, target, keys, report)) {
+        std::cerr << (report.verify_failed ? "Written data mismatch, block " : "Cannot update block ")
+            << int(report.failed_block) << "!" << std::endl;
         return 1;
     }
 
-    std::cout << "Card activated!" << std::endl;
+    std::cout << "Card activated! Blocks written: " << report.blocks_written << std::endl;
 }
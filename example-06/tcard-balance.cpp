@@ -38,8 +38,15 @@ int main(int argc, char **argv)
 {
     xpcsc::Connection c;
 
+    // card image named by XPCSC_VIRTUAL_MIFARE replaces reader and card
+    xpcsc::VirtualMifareImageFile virtual_card;
     try {
-        c.init();
+        if (!virtual_card.attach(c)) {
+            c.init();
+        }
+    } catch (xpcsc::ConnectionError &e) {
+        std::cerr << "[E] " << e.what() << std::endl;
+        return 1;
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
         return 1;
@@ -80,40 +87,20 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
+    xpcsc::MifareClassicSession session(c, reader);
 
-    // load ACTIVE_KEY_A
-    command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-    command.replace(5, 6, ACTIVE_KEY_A, 6);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Failed to load key" << std::endl;
-        return 1;
-    }
-
-    // authenticate to access block CARD_BLOCK using loaded key as Key A 
-    command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-    command[7] = CARD_BLOCK;
-    command[8] = 0x60;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
+    // authenticate to access block CARD_BLOCK using ACTIVE_KEY_A as Key A 
+    if (!session.authenticate(CARD_BLOCK, xpcsc::MifareKeyA, ACTIVE_KEY_A)) {
         std::cerr << "Cannot authenticate using ACTIVE_KEY_A!" << std::endl;
         return 1;
     }
 
-    // read block CARD_BLOCK
-    command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-    command[3] = CARD_BLOCK;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot read block!" << std::endl;
+    // read balance from value block CARD_BLOCK
+    int32_t balance = 0;
+    if (!session.read_value(CARD_BLOCK, balance)) {
+        std::cerr << "Cannot read balance, block is not a value block!" << std::endl;
         return 1;
     }
 
-    // and read balance
-    uint16_t balance = 0;
-    memcpy(&balance, response.c_str(), 2);
-
     std::cout << "Card balance is: " << balance << std::endl;
 }
@@ -38,8 +38,15 @@ int main(int argc, char **argv)
 {
     xpcsc::Connection c;
 
+    // card image named by XPCSC_VIRTUAL_MIFARE replaces reader and card
+    xpcsc::VirtualMifareImageFile virtual_card;
     try {
-        c.init();
+        if (!virtual_card.attach(c)) {
+            c.init();
+        }
+    } catch (xpcsc::ConnectionError &e) {
+        std::cerr << "[E] " << e.what() << std::endl;
+        return 1;
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
         return 1;
@@ -80,64 +87,42 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
+    xpcsc::MifareClassicSession session(c, reader);
+    xpcsc::Bytes sector;
 
-    // load ACTIVE_KEY_A
-    command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-    command.replace(5, 6, ACTIVE_KEY_A, 6);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Failed to load key" << std::endl;
+    // authenticate to access sector CARD_SECTOR using ACTIVE_KEY_A as Key A 
+    if (!session.authenticate(CARD_BLOCK, xpcsc::MifareKeyA, ACTIVE_KEY_A)) {
+        std::cerr << "Cannot authenticate using ACTIVE_KEY_A!" << std::endl;
         return 1;
     }
 
-    // authenticate to access block CARD_BLOCK using loaded key as Key A 
-    command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-    command[7] = CARD_BLOCK;
-    command[8] = 0x60;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot authenticate using ACTIVE_KEY_A!" << std::endl;
+    // read the whole sector, it is compared with the new contents later
+    if (!session.read_blocks(CARD_SECTOR_FIRST_BLOCK, 4, sector)) {
+        std::cerr << "Cannot read sector!" << std::endl;
         return 1;
     }
 
-    // create empty block
-    xpcsc::Bytes balance_block(16, 0);
+    xpcsc::Bytes current = card_image(sector);
+    xpcsc::Bytes target = current;
 
-    // update block
-    command.assign(CMD_UPDATE_BINARY, sizeof(CMD_UPDATE_BINARY));
-    command[3] = CARD_BLOCK;
-    command.replace(5, 16, balance_block.c_str(), 16);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot update block!" << std::endl;
-        return 1;
-    }
+    // empty block
+    target.replace(CARD_BLOCK * 16, 16, 16, 0);
 
-    // read sector trailer
-    command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-    command[3] = CARD_SECTOR_TRAILER;
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot read block!" << std::endl;
-        return 1;
-    }
+    // trailer with a factory Key A
+    target.replace(CARD_SECTOR_TRAILER * 16, 6, DEFAULT_KEY_A, 6);
+    target.replace(CARD_SECTOR_TRAILER * 16 + 10, 6, DEFAULT_KEY_A, 6);
+
+    xpcsc::MifareCachedKeys keys(1);
+    keys[0].sector = CARD_SECTOR;
+    keys[0].key_type = xpcsc::MifareKeyA;
+    memcpy(keys[0].key, ACTIVE_KEY_A, 6);
 
-    // update trailer with a factory Key A 
-    xpcsc::Bytes trailer = response.substr(0, 16);
-    trailer.replace(0, 6, DEFAULT_KEY_A, 6);
-    trailer.replace(10, 6, DEFAULT_KEY_A, 6);
-
-    // update sector trailer
-    command.assign(CMD_UPDATE_BINARY, sizeof(CMD_UPDATE_BINARY));
-    command[3] = CARD_SECTOR_TRAILER;
-    command.replace(5, 16, trailer.c_str(), 16);
-    c.transmit(reader, command, &response);
-    if (c.response_status(response) != 0x9000) {
-        std::cerr << "Cannot update block!" << std::endl;
+    xpcsc::MifareWriteReport report;
+    if (!xpcsc::mifare_write_image(session, current, target, keys, report)) {
+        std::cerr << (report.verify_failed ? "Written data mismatch, block " : "Cannot update block ")
+            << int(report.failed_block) << "!" << std::endl;
         return 1;
     }
 
-    std::cout << "Card deactivated!" << std::endl;
+    std::cout << "Card deactivated! Blocks written: " << report.blocks_written << std::endl;
 }
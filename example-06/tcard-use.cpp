@@ -28,6 +28,7 @@
 #include <xpcsc.hpp>
 #include <iostream>
 #include <sstream>
+#include <chrono>
 
 #include <string.h>
 #include <unistd.h>
@@ -38,8 +39,18 @@ int main(int argc, char **argv)
 {
     xpcsc::Connection c;
 
+    // card image named by XPCSC_VIRTUAL_MIFARE replaces reader and card
+    xpcsc::VirtualMifareImageFile virtual_card;
+    // virtual card is tapped once, so its image is saved on exit
+    bool tap_once = false;
     try {
-        c.init();
+        tap_once = virtual_card.attach(c);
+        if (!tap_once) {
+            c.init();
+        }
+    } catch (xpcsc::ConnectionError &e) {
+        std::cerr << "[E] " << e.what() << std::endl;
+        return 1;
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
         return 1;
@@ -54,11 +65,21 @@ int main(int argc, char **argv)
 
     std::string reader_name = *readers.begin();
 
+    // session lives across taps, so key is loaded into reader only once
+    xpcsc::MifareClassicSession session(c, xpcsc::Reader());
+
+    // tap latency is measured from card detection to the last card response
+    unsigned long taps = 0;
+    double total_latency = 0;
+
     try {
-        while (1) {
+        do {
             c.wait_for_card_remove(reader_name);
             std::cout << "Terminal is ready, use your card!" << std::endl;
             xpcsc::Reader reader = c.wait_for_reader_card(reader_name);
+            std::chrono::steady_clock::time_point tap_start = std::chrono::steady_clock::now();
+            session.card_changed(reader);
+            c.reset_metrics();
 
             xpcsc::Bytes atr = c.atr(reader);
 
@@ -76,62 +97,43 @@ int main(int argc, char **argv)
                 continue;
             }
 
-            xpcsc::Bytes command;
-            xpcsc::Bytes response;
-
-            // load ACTIVE_KEY_A
-            command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-            command.replace(5, 6, ACTIVE_KEY_A, 6);
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                std::cerr << "Failed to load key" << std::endl;
-                continue;
-            }
-
-            // authenticate to access block CARD_BLOCK using loaded key as Key A 
-            command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-            command[7] = CARD_BLOCK;
-            command[8] = 0x60;
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
+            // authenticate to access block CARD_BLOCK using ACTIVE_KEY_A as Key A 
+            if (!session.authenticate(CARD_BLOCK, xpcsc::MifareKeyA, ACTIVE_KEY_A)) {
                 std::cerr << "Cannot authenticate using ACTIVE_KEY_A!" << std::endl;
                 continue;
             }
 
-            // read block CARD_BLOCK
-            command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-            command[3] = CARD_BLOCK;
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                std::cerr << "Cannot read block!" << std::endl;
+            // read balance from value block CARD_BLOCK
+            int32_t balance = 0;
+            if (!session.read_value(CARD_BLOCK, balance)) {
+                std::cerr << "Cannot read balance, block is not a value block!" << std::endl;
                 continue;
             }
 
-            // and read balance
-            uint16_t balance = 0;
-            memcpy(&balance, response.c_str(), 2);
-
             if (balance < TICKET_PRICE) {
                 std::cout << "Not enough money on the card!" << std::endl;
             } else {
-                // update balance
-                balance -= TICKET_PRICE;
-                xpcsc::Bytes balance_block(16, 0);
-                balance_block.replace(0, 2, (unsigned char *)&balance, 2);
-
-                // update block
-                command.assign(CMD_UPDATE_BINARY, sizeof(CMD_UPDATE_BINARY));
-                command[3] = CARD_BLOCK;
-                command.replace(5, 16, balance_block.c_str(), 16);
-                c.transmit(reader, command, &response);
-                if (c.response_status(response) != 0x9000) {
-                    std::cerr << "Cannot update block!" << std::endl;
-                    c.wait_for_card_remove(reader_name);
+                // card decrements and transfers value itself, so removed card
+                // keeps either old or new balance
+                if (!session.decrement_value(CARD_BLOCK, TICKET_PRICE)) {
+                    std::cerr << "Cannot update balance!" << std::endl;
                     continue;
                 }
+                balance -= TICKET_PRICE;
             }
+
+            double latency = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - tap_start).count();
+            taps++;
+            total_latency += latency;
+
             std::cout << "Card balance is: " << balance << std::endl;
-        }
+            std::cout << "APDUs sent: " << session.apdus_sent() 
+                << ", avoided: " << session.apdus_avoided()
+                << ", card exchanges: " << c.metrics().total_time / 1000.0 << " ms" << std::endl;
+            std::cout << "Tap latency: " << latency << " ms, average: " << total_latency / taps
+                << " ms (up to " << int(60000.0 * taps / total_latency) << " taps per minute)" << std::endl;
+        } while (!tap_once);
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "PC/SC operation failed: " << e.what() << std::endl;
         return 1;
@@ -28,53 +28,24 @@
 #include <xpcsc.hpp>
 #include <iostream>
 #include <sstream>
-#include <unordered_map>
 
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 
 #define CHECK_BIT(value, b) (((value) >> (b))&1)
 
-const xpcsc::Bytes TAG_EMV_FCI = {0x6F};
-const xpcsc::Bytes TAG_EMV_FCI_PD = {0xA5};
-const xpcsc::Bytes TAG_EMV_FCI_SFI = {0x88};
-const xpcsc::Bytes TAG_PSD_REC = {0x70};
-const xpcsc::Bytes TAG_PSD_TAG = {0x61};
-const xpcsc::Bytes TAG_PSD_AID_TAG = {0x4F};
-const xpcsc::Bytes TAG_EMV_FCI_APP_LABEL = {0x50};
-const xpcsc::Bytes TAG_EMV_FCI_APP_PDOL = {0x9F, 0x38};
-
-const xpcsc::Bytes TAG_PRIM = {0x80};
-const xpcsc::Bytes TAG_STRUCT = {0x77};
-
-const xpcsc::Bytes TAG_EMV_AIP = {0x82};
-const xpcsc::Bytes TAG_EMV_AFL = {0x94};
-
-
 const xpcsc::Bytes AID_VISA_ELECTRON = {0xA0, 0x00, 0x00, 0x00, 0x03, 0x20, 0x10};
 const xpcsc::Bytes AID_VISA_CLASSIC = {0xA0, 0x00, 0x00, 0x00, 0x03, 0x10, 0x10};
 const xpcsc::Bytes AID_MASTERCARD = {0xA0, 0x00, 0x00, 0x00, 0x04, 0x10, 0x10};
 const xpcsc::Bytes AID_PRO100 = {0xA0, 0x00, 0x00, 0x04, 0x32, 0x00, 0x01};
 
 
-uint32_t tag_to_long(const xpcsc::Bytes tag)
-{
-    size_t length = tag.size();
-    if (length > 4) {
-        throw std::out_of_range("too large tag");
-    }
-
-    uint32_t res = 0;
-    for (auto i=tag.begin(); i!=tag.end(); i++) {
-        res = (res << 8) | *i;
-    }
-
-    return res;
-}
-
 const char * tag_to_string(uint32_t tag)
 {
     switch (tag) {
+    case 0x4F: return "Application Identifier (AID)";
+    case 0x50: return "Application Label";
     case 0x56: return "Track 1 Data";
     case 0x57: return "Track 2 Equivalent Data";
     case 0x5A: return "Application Primary Account Number (PAN)";
@@ -84,6 +55,12 @@ const char * tag_to_string(uint32_t tag)
     case 0x5F28: return "Issuer Country Code";
     case 0x5F30: return "Service Code";
     case 0x5F34: return "Application Primary Account Number (PAN) Sequence Number";
+    case 0x6F: return "File Control Information (FCI) Template";
+    case 0x70: return "READ RECORD Response Message Template";
+    case 0x77: return "Response Message Template Format 2";
+    case 0x80: return "Response Message Template Format 1";
+    case 0x82: return "Application Interchange Profile";
+    case 0x84: return "Dedicated File (DF) Name";
     case 0x8C: return "Card Risk Management Data Object List 1 (CDOL1)";
     case 0x8D: return "Card Risk Management Data Object List 2 (CDOL2)";
     case 0x8E: return "Cardholder Verification Method (CVM) List";
@@ -91,6 +68,8 @@ const char * tag_to_string(uint32_t tag)
     case 0x90: return "Issuer Public Key Certificate";
     case 0x92: return "Issuer Public Key Remainder";
     case 0x93: return "Signed Static Application Data";
+    case 0x94: return "Application File Locator (AFL)";
+    case 0xA5: return "File Control Information (FCI) Proprietary Template";
     case 0x9F07: return "Application Usage Control";
     case 0x9F08: return "Application Version Number";
     case 0x9F0D: return "Issuer Action Code - Default";
@@ -98,6 +77,7 @@ const char * tag_to_string(uint32_t tag)
     case 0x9F0F: return "Issuer Action Code - Online";
     case 0x9F1F: return "Track 1 Discretionary Data";
     case 0x9F32: return "Issuer Public Key Exponent";
+    case 0x9F38: return "Processing Options Data Object List (PDOL)";
     case 0x9F42: return "Application Currency Code";
     case 0x9F44: return "Application Currency Exponent";
     case 0x9F46: return "ICC Public Key Certificate";
@@ -119,350 +99,244 @@ const char * tag_to_string(uint32_t tag)
     }
 }
 
-std::vector<xpcsc::Bytes> read_apps_from_pse(xpcsc::Connection & c, xpcsc::Reader & reader)
-{
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
-    uint16_t response_status;
+// card type and things learned about cards of that type
+struct CardProfile {
+    std::string family;
+    xpcsc::LeCache le_cache;
+};
 
-    std::vector<xpcsc::Bytes> apps;
-
-    // SELECT Payment System Environment (PSE)
-    //                                CLA INS P1 P2   Lc  "1PAY.SYS.DDF01"
-    command.assign(xpcsc::parse_apdu("00  A4  04 00   0E  31 50 41 59 2E 53 59 53 2E 44 44 46 30 31"));
-    c.transmit(reader, command, &response);
-    response_status = c.response_status(response);
+// FCI (with PDOL) and label of the application read are stored in "app"
+bool read_app(xpcsc::Connection & c, xpcsc::Reader & reader, CardProfile & profile, xpcsc::CardApplication & app)
+{
+    // tags printed below, records after the ones containing them are not read
+    const std::vector<uint32_t> wanted = {0x50, 0x82, 0x5A, 0x5F20, 0x5F24, 0x5F25};
 
-    if (response_status == 0x6A82) {
-        // no PSE on the card
-        return apps;
-    }
+    xpcsc::EMVReadSession session(c, reader);
+    session.set_le_cache(&profile.le_cache, profile.family);
 
-    if (response_status != 0x9000) {
-        std::cerr << "Failed to fetch PSE: " << c.response_status_str(response) << std::endl;
-        return apps;
+    if (!session.read(app.aid, wanted)) {
+        uint16_t status = session.last_status();
+        if (status == 0x6A82) {
+            // no application on the card
+            return false;
+        }
+        std::cerr << "Failed to read application: " << std::hex << std::uppercase << status
+            << std::dec << std::endl;
+        return false;
     }
 
-    // parse response data
-    auto tlv = xpcsc::BerTlv::parse(response.substr(0, response.size()-2));
+    app.fci = session.fci();
 
-    const auto & items = tlv->get_children();
-    if (items.size() == 0) {
-        // no data
-        return apps;
+    xpcsc::BytesView v;
+    if (session.find(0x50, v)) {
+        // print application name in ASCII
+        app.label.assign(reinterpret_cast<const char *>(v.data), v.size);
+        std::cout << "Application label: " << app.label << std::endl;
     }
 
-    const auto & fci = items[0];
-
-    if (fci->get_tag().compare(TAG_EMV_FCI) != 0) {
-        // returned data is not a proper FCI
-        return apps;
+    if (session.find(0x82, v) && v.size > 0) {
+        // print card capabilities from AIP
+        xpcsc::Byte aip_1 = v.data[0];
+        std::cout << "Card capabilities:" << std::endl;
+        std::cout << "  SDA supported: " << (CHECK_BIT(aip_1, 1) ? "true" : "false") << std::endl;
+        std::cout << "  DDA supported: " << (CHECK_BIT(aip_1, 2) ? "true" : "false") << std::endl;
+        std::cout << "  Cardholder verification supported: " << (CHECK_BIT(aip_1, 3) ? "true" : "false") << std::endl;
+        std::cout << "  Terminal risk management is to be performed: " << (CHECK_BIT(aip_1, 4) ? "true" : "false") << std::endl;
+        std::cout << "  Issuer authentication is supported: " << (CHECK_BIT(aip_1, 5) ? "true" : "false") << std::endl;
+        std::cout << "  CDA supported: " << (CHECK_BIT(aip_1, 7) ? "true" : "false") << std::endl;
     }
 
-    // find proprietary data (PD) block
-    const auto & PD_block = fci->find_by_tag(TAG_EMV_FCI_PD);
-    if (!PD_block) {
-        // proprietary data block not found
-        return apps;
+    const auto & tags = session.found_tags();
+    for (auto t=tags.begin(); t!=tags.end(); t++) {
+        std::cout << std::hex << std::uppercase << *t << std::dec << " => " << tag_to_string(*t) << std::endl;
     }
 
-    // find SFI block
-    const auto & SFI_block = PD_block->find_by_tag(TAG_EMV_FCI_SFI);
-    if (!SFI_block) {
-        // SFI data block not found
-        return apps;
-    }
+    // print known values
+    std::cout << "Card number: " << xpcsc::format(session.value(0x5A)) << std::endl;
+    std::cout << "Card holder name: " << session.value(0x5F20).c_str() << std::endl;
+    std::cout << "Effective date: " << xpcsc::format(session.value(0x5F25)) << std::endl;
+    std::cout << "Exp date: " << xpcsc::format(session.value(0x5F24)) << std::endl;
+    std::cout << "Records read: " << session.records_read() << ", skipped: " << session.records_skipped() << std::endl;
 
-    xpcsc::Byte sfi = SFI_block->get_data()[0];
-    xpcsc::Byte P2 = (sfi << 3) | 4;
+    return true;
+}
 
-    // read Payment System Directory
-    //         CLA   INS   P1    P2  Le
-    command = {0x00, 0xB2, 0x00, P2, 0x00};
 
-    for (xpcsc::Byte i=1; i<=10; i++) {
-        command[2] = i;
-        command[4] = 0;
-        c.transmit(reader, command, &response);
-        response_status = c.response_status(response);
+int main(int argc, char **argv)
+{
+    bool repeat = false;
+    // virtual card profile and number of cards to process in repeat mode, 0 is no limit
+    std::string profile_file;
+    unsigned long max_taps = 0;
+
+    // Le values learned on previous runs
+    std::string le_cache_file;
+    const char * home = getenv("HOME");
+    if (home != 0) {
+        le_cache_file = std::string(home) + "/.xpcsc-le.cache";
+    }
 
-        if (response_status == 0x6A83) {
-            // no more records
-            break;
+    for (int i=1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "-h") {
+            std::cout << "Usage:\n"
+                "    " << argv[0] << " [-h] [-r] [-n TAPS] [-l LE_CACHE_FILE] [-V PROFILE]\n"
+                "\n"
+                "    -r  process cards until interrupted, applications of re-tapped cards are cached\n"
+                "    -n  stop after TAPS cards in repeat mode\n"
+                "    -l  READ RECORD Le cache file, default is ~/.xpcsc-le.cache, \"-\" disables it\n"
+                "    -V  card emulated from profile file (see xpcsc::VirtualEMVCard) instead of reader" << std::endl;
+            return 0;
         }
-
-        if ((response_status >> 8) == 0x6C) {
-            // repeat with proper Le
-            command[4] = static_cast<xpcsc::Byte>(response_status & 0xFF);
-            c.transmit(reader, command, &response);
-            response_status = c.response_status(response);
+        if (arg == "-r") {
+            repeat = true;
+            continue;
         }
-
-        if (response_status != 0x9000) {
-            // something wrong
-            std::cerr << "Failed to fetch Payment System Directory record: " << c.response_status_str(response) << std::endl;
-            break;
+        if (arg == "-l" && i + 1 < argc) {
+            le_cache_file = argv[++i];
+            if (le_cache_file == "-") {
+                le_cache_file.clear();
+            }
+            continue;
         }
-
-        auto atlv(xpcsc::BerTlv::parse(response.substr(0, response.size()-2)));
-
-        const auto & PSD_REC_block = atlv->find_by_tag(TAG_PSD_REC);
-        if (!PSD_REC_block) {
-            // malformed PSD record
-            return apps;
+        if (arg == "-V" && i + 1 < argc) {
+            profile_file = argv[++i];
+            continue;
         }
-
-        // find all AID records, they all have tag 61
-        const auto & psd_items =  PSD_REC_block->get_children();
-        for (auto j=psd_items.begin(); j!=psd_items.end(); j++) {
-            const xpcsc::BerTlvRef & psd_block = *j;
-            if (psd_block->get_tag().compare(TAG_PSD_TAG) != 0) {
-                continue;
-            }
-
-            const auto & aid_block = psd_block->find_by_tag(TAG_PSD_AID_TAG);
-            if (aid_block) {
-                // AID found!
-                apps.push_back(aid_block->get_data());
-            }
+        if (arg == "-n" && i + 1 < argc) {
+            max_taps = strtoul(argv[++i], 0, 10);
+            continue;
         }
-
+        std::cerr << "Unknown argument: " << arg << std::endl;
+        return 1;
     }
 
-    return apps;
-}
-
-bool read_app(xpcsc::Connection & c, xpcsc::Reader & reader, const xpcsc::Bytes & aid)
-{
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
-    uint16_t response_status;
-
-    // SELECT application
-    //                                CLA INS P1 P2 
-    command.assign(xpcsc::parse_apdu("00  A4  04 00"));
-    command.push_back(static_cast<xpcsc::Byte>(aid.size()));
-    command.append(aid);
-
-    c.transmit(reader, command, &response);
-    response_status = c.response_status(response);
+    xpcsc::Connection c;
 
-    if (response_status == 0x6A82) {
-        // no application on the card
-        return false;
+    // emulated card instead of PC/SC reader
+    xpcsc::VirtualEMVCard virtual_card;
+    if (profile_file.length() != 0) {
+        if (!virtual_card.load(profile_file)) {
+            std::cerr << "[E] Cannot load card profile: " << profile_file << std::endl;
+            return 1;
+        }
+        c.attach_virtual_card("Virtual EMV reader", &virtual_card);
+    } else {
+        try {
+            c.init();
+        } catch (xpcsc::PCSCError &e) {
+            std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
+            return 1;
+        }
     }
 
-    if (response_status != 0x9000) {
-        std::cerr << "Failed to fetch ADF: " << c.response_status_str(response) << std::endl;
-        return false;
+    // get readers list
+    auto readers = c.readers();
+    if (readers.size() == 0) {
+        std::cerr << "[E] No connected readers" << std::endl;
+        return 1;
     }
 
-    // parse response data
-    auto tlv = xpcsc::BerTlv::parse(response.substr(0, response.size()-2));
-
-    const auto & items = tlv->get_children();
-    if (items.size() == 0) {
-        // no data
-        return false;
+    CardProfile profile;
+    if (le_cache_file.length() != 0 && !profile.le_cache.load(le_cache_file)) {
+        std::cerr << "[W] Broken Le cache file: " << le_cache_file << std::endl;
     }
 
-    const auto & fci = items[0];
-
-    if (fci->get_tag().compare(TAG_EMV_FCI) != 0) {
-        // returned data is not a proper FCI
-        return false;
-    }
+    // application read from each of the last cards, used in repeat mode only
+    xpcsc::FCICache fci_cache;
 
-    // find proprietary data (PD) block
-    const auto & PD_block = fci->find_by_tag(TAG_EMV_FCI_PD);
-    if (!PD_block) {
-        // proprietary data block not found
-        return false;
-    }
+    // only its directory reading is used, known AIDs are tried below
+    xpcsc::AIDDiscovery directory;
 
-    // std::cout << "PD block: \n" << xpcsc::format(*PD_block) << std::endl;
+    auto reader_name = *readers.begin();
+    std::cout << "Found reader: " << reader_name << std::endl;
+    unsigned long taps = 0;
 
-    const auto & label_block = PD_block->find_by_tag(TAG_EMV_FCI_APP_LABEL);
-    if (label_block) {
-        // print application name in ASCII
-        std::cout << "Application label: " << label_block->get_data().c_str() << std::endl;
-    }
+    while (1) {
+        // connect to reader
+        xpcsc::Reader reader;
 
-    // setup GET PROCESSING OPTIONS command
-    //                                CLA INS P1 P2 
-    command.assign(xpcsc::parse_apdu("80  A8  00 00"));
-
-    const auto & PDOL_block = PD_block->find_by_tag(TAG_EMV_FCI_APP_PDOL);
-    if (PDOL_block) {
-        const xpcsc::Bytes pdol = PDOL_block->get_data();
-        xpcsc::Byte total_length = 0;
-
-        for (auto i=pdol.begin(); i!=pdol.end(); i++) {
-            if ((*i & 0x1F) == 0x1F) {
-                // go deeper
-                while (true) {
-                    i++;
-                    if ((*i & 0x80) == 0) {
-                        break;
-                    }
+        try {
+            reader = c.wait_for_reader_card(reader_name);
+        } catch (xpcsc::PCSCError &e) {
+            std::cerr << "Wait for card failed: " << e.what() << std::endl;
+            return 1;
+        }
+        c.reset_metrics();
+
+        // contactless cards list all applications in PPSE FCI
+        xpcsc::Bytes atr = c.atr(reader);
+        xpcsc::ATRParser p;
+        p.load(atr);
+        bool contactless = p.checkFeature(xpcsc::ATR_FEATURE_PICC);
+
+        profile.family = p.classification().family;
+
+        // re-tapped card: application read last time must give the same FCI
+        xpcsc::Bytes identity;
+        bool done = false;
+        if (repeat) {
+            identity = xpcsc::FCICache::card_identity(c, reader);
+            const xpcsc::CardApplications * cached = fci_cache.lookup(identity);
+            if (cached != 0) {
+                xpcsc::CardApplication app = cached->front();
+                done = read_app(c, reader, profile, app) && app.fci == cached->front().fci;
+                if (!done) {
+                    fci_cache.reject(identity);
                 }
             }
-            // next byte is a length
-            i++;
-            total_length += *i;
         }
 
-        xpcsc::Bytes data = {static_cast<xpcsc::Byte>(total_length+2), 0x83, total_length};
-        xpcsc::Bytes nulls(total_length, 0);
-        data.append(nulls);
-        command.append(data);
-    } else {
-        // no PDOL
-        xpcsc::Bytes data = {0x02, 0x83, 0x00};
-        command.append(data);
-    }
-
-    // Append Le
-    command.push_back(0x00);
-    c.transmit(reader, command, &response);
-    response_status = c.response_status(response);
-
-    if (response_status != 0x9000) {
-        std::cerr << "GET PROCESSING OPTIONS failed: " << c.response_status_str(response) << std::endl;
-        return false;
-    }
-
-
-    const auto & po_tlv = xpcsc::BerTlv::parse(response.substr(0, response.size()-2));
-    const auto & po_tlv_d = po_tlv->get_children().at(0);
-
-    // std::cout << "GET " << xpcsc::format(*po_tlv) << std::endl;
-    xpcsc::Bytes aip;
-    xpcsc::Bytes afl;
-
-    if (po_tlv_d->get_tag().compare(TAG_PRIM) == 0) {
-        // primitive data, first 2 bytes AIP, the rest — AFL
-        const auto & data = po_tlv_d->get_data();
-        aip = data.substr(0, 2);
-        afl = data.substr(2);
-    } else if (po_tlv_d->get_tag().compare(TAG_STRUCT) == 0) {
-        // structured/tlv data
-        aip = po_tlv_d->find_by_tag(TAG_EMV_AIP)->get_data();
-        afl = po_tlv_d->find_by_tag(TAG_EMV_AFL)->get_data();
-    } else {
-        std::cerr << "GET PROCESSING OPTIONS failed: unknown response format: " << xpcsc::format(response) << std::endl;
-        return false;
-    }
-
-    // print card capabilities from "aip"
-    xpcsc::Byte aip_1 = aip.at(0);
-    std::cout << "Card capabilities:" << std::endl;
-    std::cout << "  SDA supported: " << (CHECK_BIT(aip_1, 1) ? "true" : "false") << std::endl;
-    std::cout << "  DDA supported: " << (CHECK_BIT(aip_1, 2) ? "true" : "false") << std::endl;
-    std::cout << "  Cardholder verification supported: " << (CHECK_BIT(aip_1, 3) ? "true" : "false") << std::endl;
-    std::cout << "  Terminal risk management is to be performed: " << (CHECK_BIT(aip_1, 4) ? "true" : "false") << std::endl;
-    std::cout << "  Issuer authentication is supported: " << (CHECK_BIT(aip_1, 5) ? "true" : "false") << std::endl;
-    std::cout << "  CDA supported: " << (CHECK_BIT(aip_1, 7) ? "true" : "false") << std::endl;
-
-    std::unordered_map<uint32_t, xpcsc::Bytes> values;
-
-    // process AFL
-    for (auto i=afl.begin(); i!=afl.end(); i++) {
-        command = {0x00, 0xB2, 0x00, static_cast<xpcsc::Byte>((*i & 0xF8) | 0x4), 0x00};
-
-        i++;
-        auto first_rec_num = *i;
-
-        i++;
-        auto last_rec_num = *i;
-
-        for (size_t j=first_rec_num; j<=last_rec_num; j++) {
-            command[2] = j;
-            command[4] = 0;
-
-            c.transmit(reader, command, &response);
-            response_status = c.response_status(response);
-            if ((response_status >> 8) == 0x6C) {
-                command[4] = static_cast<xpcsc::Byte>(response_status & 0xFF);
-                c.transmit(reader, command, &response);
-            }
-
-            response_status = c.response_status(response);
-            if (response_status != 0x9000) {
-                std::cerr << "failed to read record: " << c.response_status_str(response) << std::endl;
-                return false;
+        if (!done) {
+            // payment system directory, applications in priority order
+            xpcsc::CardApplications apps;
+            if (directory.read_directory(c, reader, contactless, apps) == xpcsc::AIDDiscoveryNone) {
+                // cannot fetch apps from PSE, fill list with known/support AIDs
+                const xpcsc::Bytes known[] = {AID_MASTERCARD, AID_VISA_ELECTRON, AID_PRO100, AID_VISA_CLASSIC};
+                for (size_t i=0; i<sizeof(known)/sizeof(known[0]); i++) {
+                    xpcsc::CardApplication app;
+                    app.aid = known[i];
+                    apps.push_back(app);
+                }
             }
 
-            // parse response as BER-TLV
-            auto record_tlv_top(xpcsc::BerTlv::parse(response.substr(0, response.size()-2)));
-            const auto & record_tlv = record_tlv_top->get_children().at(0);
-            const auto & ch = record_tlv->get_children();
-
-            for (auto x=ch.begin(); x!=ch.end(); x++) {
-                auto t = tag_to_long((*x)->get_tag());
-                values[t] = (*x)->get_data();
-                std::cout << xpcsc::format((*x)->get_tag()) << " => " << tag_to_string(t) <<std::endl;
+            for (auto app=apps.begin(); app!=apps.end(); app++) {
+                if (read_app(c, reader, profile, *app)) {
+                    if (repeat) {
+                        fci_cache.store(identity, xpcsc::CardApplications(1, *app));
+                    }
+                    break;
+                }
             }
         }
 
-        i++;
-    }
-
-    // print known values
-    std::cout << "Card number: " << xpcsc::format(values[0x5A]) << std::endl;
-    std::cout << "Card holder name: " << values[0x5F20].c_str() << std::endl;
-    std::cout << "Effective date: " << xpcsc::format(values[0x5F25]) << std::endl;
-    std::cout << "Exp date: " << xpcsc::format(values[0x5F24]) << std::endl;
-
-    // std::cout << "status: " <<  c.response_status_str(response) << std::endl;
-    return true;
-}
-
-
-int main(int argc, char **argv)
-{
-    xpcsc::Connection c;
-
-    try {
-        c.init();
-    } catch (xpcsc::PCSCError &e) {
-        std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
-        return 1;
-    }
-
-    // get readers list
-    auto readers = c.readers();
-    if (readers.size() == 0) {
-        std::cerr << "[E] No connected readers" << std::endl;
-        return 1;
-    }
+        if (le_cache_file.length() != 0 && profile.le_cache.modified() && !profile.le_cache.save(le_cache_file)) {
+            std::cerr << "[W] Cannot save Le cache: " << le_cache_file << std::endl;
+        }
 
-    // connect to reader
-    xpcsc::Reader reader;
+        std::cout << "APDUs sent: " << c.metrics().apdus << std::endl;
 
-    try {
-        auto reader_name = *readers.begin();
-        std::cout << "Found reader: " << reader_name << std::endl;
-        reader = c.wait_for_reader_card(reader_name);
-    } catch (xpcsc::PCSCError &e) {
-        std::cerr << "Wait for card failed: " << e.what() << std::endl;
-        return 1;
-    }
+        if (!repeat) {
+            break;
+        }
 
-    auto apps = read_apps_from_pse(c, reader);
-    if (apps.size() == 0) {
-        // cannot fetch apps from PSE, fill list with known/support AIDs
-        apps.push_back(AID_MASTERCARD);
-        apps.push_back(AID_VISA_ELECTRON);
-        apps.push_back(AID_PRO100);
-        apps.push_back(AID_VISA_CLASSIC);
-    }
+        // contact cards are matched by ATR and FCI only
+        std::cout << "Cache hit rate: " << fci_cache.hit_rate() * 100 << "% ("
+            << fci_cache.hits() - fci_cache.stale() - fci_cache.atr_only() << " of "
+            << fci_cache.hits() + fci_cache.misses() << " taps), ATR-only matches: " << fci_cache.atr_only() << std::endl;
 
-    for (auto aid=apps.begin(); aid!=apps.end(); aid++) {
-        if (read_app(c, reader, *aid)) {
+        taps++;
+        if (max_taps != 0 && taps >= max_taps) {
             break;
         }
+
+        try {
+            c.wait_for_card_remove(reader_name);
+        } catch (xpcsc::PCSCError &e) {
+            std::cerr << "Wait for card removal failed: " << e.what() << std::endl;
+            return 1;
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
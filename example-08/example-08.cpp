@@ -27,16 +27,15 @@
 
 #include <xpcsc.hpp>
 #include <iostream>
-#include <iomanip>
 #include <sstream>
 #include <unordered_map>
+#include <chrono>
 
 #include <cstring>
+#include <cstdlib>
 #include <string>
 #include <unistd.h>
 
-#include "apps.hpp"
-
 #define CHECK_BIT(value, b) (((value) >> (b))&1)
 
 const xpcsc::Bytes TAG_EMV_FCI = {0x6F};
@@ -61,31 +60,137 @@ std::string format_fci(const xpcsc::BerTlv & tlv)
     return ss.str();
 }
 
-xpcsc::Bytes select_app_apdu(const std::string & aid)
+xpcsc::Bytes select_app_apdu(const xpcsc::AIDRegistryEntry & app)
 {
-    std::stringstream ss;
+    xpcsc::Bytes command = {0x00, 0xA4, 0x04, 0x00};
+    command.push_back(static_cast<xpcsc::Byte>(app.aid_length));
+    command.append(app.aid, app.aid_length);
+    return command;
+}
+
+void print_fci(const xpcsc::Bytes & fci)
+{
+    std::unique_ptr<xpcsc::BerTlv> tlv(xpcsc::BerTlv::parse(fci));
+    std::cout << "Parsed response:" << std::endl;
+    try {
+        std::cout << format_fci(*tlv) << std::endl;
+    } catch (std::invalid_argument & e) {
+        // print response
+        std::cout << "No FCI: " << xpcsc::format(fci) << std::endl;
+    }
+}
+
+// old way: SELECT every known AID
+void probe_all_apps(xpcsc::Connection & c, const xpcsc::Reader & reader)
+{
+    xpcsc::Bytes command;
+    xpcsc::Bytes response;
+    uint16_t response_status;
+
+    for (size_t i=0; i < xpcsc::aid_registry_size(); i++) {
+        const xpcsc::AIDRegistryEntry & app = xpcsc::aid_registry_entry(i);
+
+        command.assign(select_app_apdu(app));
+        c.transmit(reader, command, &response);
+        response_status = c.response_status(response);
+
+        if (response_status != 0x9000) {
+            continue;
+        }
+
+        std::cout << "Probe successful for AID: " << xpcsc::format(xpcsc::Bytes(app.aid, app.aid_length))
+            << " - " << app.description << std::endl;
+        print_fci(response.substr(0, response.size()-2));
+    }
+}
 
-    if ((aid.length() % 2) == 1) {
-        throw std::runtime_error("bad");
+const char * method_name(xpcsc::AIDDiscoveryMethod method)
+{
+    switch (method) {
+    case xpcsc::AIDDiscoveryPPSE: return "PPSE";
+    case xpcsc::AIDDiscoveryPSE: return "PSE";
+    case xpcsc::AIDDiscoveryFamily: return "applications of the same card family";
+    case xpcsc::AIDDiscoveryPartialSelect: return "partial AID selection";
+    case xpcsc::AIDDiscoveryProbe: return "known AIDs probing";
+    default: return "none";
     }
-    ss << "00  A4  04 00 ";
-    uint8_t size = static_cast<uint8_t>(aid.length() / 2);
-    ss << std::hex << std::setfill('0') << std::setw(2) << static_cast<int>(size) << " ";
-    ss << aid;
-    return xpcsc::parse_apdu(ss.str());
 }
 
 int main(int argc, char **argv)
 {
-    xpcsc::Connection c;
+    bool brute_force = false;
+    bool exhaustive = false;
+    bool repeat = false;
+    // virtual card profile and number of cards to process in repeat mode, 0 is no limit
+    std::string profile_file;
+    unsigned long max_taps = 0;
+    std::string stats_file;
+    const char * home = getenv("HOME");
+    if (home != 0) {
+        stats_file = std::string(home) + "/.xpcsc-aids.stats";
+    }
 
-    try {
-        c.init();
-    } catch (xpcsc::PCSCError &e) {
-        std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
+    for (int i=1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "-h") {
+            std::cout << "Usage:\n"
+                "    " << argv[0] << " [-h] [-b] [-a] [-r] [-n TAPS] [-s STATS_FILE] [-V PROFILE]\n"
+                "\n"
+                "    -b  SELECT every known AID (slow, for comparison)\n"
+                "    -a  try all RIDs and AIDs when card has no directory (slow)\n"
+                "    -r  process cards until interrupted, applications of re-tapped cards are cached\n"
+                "    -n  stop after TAPS cards in repeat mode\n"
+                "    -s  application hit statistics file, default is ~/.xpcsc-aids.stats\n"
+                "    -V  card emulated from profile file (see xpcsc::VirtualEMVCard) instead of reader" << std::endl;
+            return 0;
+        }
+        if (arg == "-b") {
+            brute_force = true;
+            continue;
+        }
+        if (arg == "-a") {
+            exhaustive = true;
+            continue;
+        }
+        if (arg == "-r") {
+            repeat = true;
+            continue;
+        }
+        if (arg == "-s" && i + 1 < argc) {
+            stats_file = argv[++i];
+            continue;
+        }
+        if (arg == "-V" && i + 1 < argc) {
+            profile_file = argv[++i];
+            continue;
+        }
+        if (arg == "-n" && i + 1 < argc) {
+            max_taps = strtoul(argv[++i], 0, 10);
+            continue;
+        }
+        std::cerr << "Unknown argument: " << arg << std::endl;
         return 1;
     }
 
+    xpcsc::Connection c;
+
+    // emulated card instead of PC/SC reader
+    xpcsc::VirtualEMVCard virtual_card;
+    if (profile_file.length() != 0) {
+        if (!virtual_card.load(profile_file)) {
+            std::cerr << "[E] Cannot load card profile: " << profile_file << std::endl;
+            return 1;
+        }
+        c.attach_virtual_card("Virtual EMV reader", &virtual_card);
+    } else {
+        try {
+            c.init();
+        } catch (xpcsc::PCSCError &e) {
+            std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // get readers list
     auto readers = c.readers();
     if (readers.size() == 0) {
@@ -93,49 +198,108 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    // connect to reader
-    xpcsc::Reader reader;
-
-    try {
-        auto reader_name = *readers.begin();
-        std::cout << "Found reader: " << reader_name << std::endl;
-        reader = c.wait_for_reader_card(reader_name);
-    } catch (xpcsc::PCSCError &e) {
-        std::cerr << "Wait for card failed: " << e.what() << std::endl;
-        return 1;
+    // known AIDs
+    xpcsc::AIDDiscovery discovery;
+    for (size_t i=0; i < xpcsc::aid_registry_size(); i++) {
+        const xpcsc::AIDRegistryEntry & app = xpcsc::aid_registry_entry(i);
+        discovery.add_aid(xpcsc::Bytes(app.aid, app.aid_length));
     }
+    if (stats_file.length() != 0 && !discovery.load_stats(stats_file)) {
+        std::cerr << "[W] Broken application statistics file: " << stats_file << std::endl;
+    }
+    discovery.set_exhaustive(exhaustive);
 
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
-    uint16_t response_status;
+    // applications of the last cards, used in repeat mode only
+    xpcsc::FCICache fci_cache;
 
-    for (auto x=KNOWN_APPLICATIONS.begin(); x!=KNOWN_APPLICATIONS.end(); x++) {
-        auto p = x->find('|');
-        if (p == std::string::npos) {
-            continue;
+    auto reader_name = *readers.begin();
+    std::cout << "Found reader: " << reader_name << std::endl;
+    unsigned long taps = 0;
+
+    while (1) {
+        // connect to reader
+        xpcsc::Reader reader;
+
+        try {
+            reader = c.wait_for_reader_card(reader_name);
+        } catch (xpcsc::PCSCError &e) {
+            std::cerr << "Wait for card failed: " << e.what() << std::endl;
+            return 1;
         }
-        auto aid = x->substr(0, p);
-        auto desc = x->substr(p+1);
 
-        command.assign(select_app_apdu(aid));
-        c.transmit(reader, command, &response);
-        response_status = c.response_status(response);
+        auto start = std::chrono::steady_clock::now();
+        c.reset_metrics();
 
-        if (response_status != 0x9000) {
-            continue;
+        if (brute_force) {
+            probe_all_apps(c, reader);
+        } else {
+            // card family for application statistics
+            xpcsc::ATRParser parser(c.atr(reader));
+            const std::string & family = parser.classification().family;
+
+            xpcsc::CardApplications apps;
+            xpcsc::Bytes identity;
+            const xpcsc::CardApplications * cached = 0;
+            if (repeat) {
+                identity = xpcsc::FCICache::card_identity(c, reader);
+                cached = fci_cache.confirm(c, reader, identity);
+            }
+
+            if (cached != 0) {
+                apps = *cached;
+                std::cout << "Discovery method: cache" << std::endl;
+            } else {
+                auto method = discovery.discover(c, reader, family, apps);
+                std::cout << "Discovery method: " << method_name(method) << std::endl;
+                if (repeat) {
+                    fci_cache.store(identity, apps);
+                }
+            }
+
+            for (auto app=apps.begin(); app!=apps.end(); app++) {
+                std::cout << "Application found, AID: " << xpcsc::format(app->aid);
+                auto known = xpcsc::aid_registry_lookup(app->aid);
+                if (known != 0) {
+                    std::cout << " - " << known->description;
+                }
+                if (app->label.length() != 0) {
+                    std::cout << " [" << app->label << "]";
+                }
+                std::cout << std::endl;
+                if (app->fci.length() != 0) {
+                    print_fci(app->fci);
+                }
+            }
+
+            if (stats_file.length() != 0 && !discovery.save_stats(stats_file)) {
+                std::cerr << "[W] Cannot save application statistics: " << stats_file << std::endl;
+            }
         }
 
-        std::cout << "Probe successful for AID: " << aid << " - " << desc << std::endl;
-        auto tlv = xpcsc::BerTlv::parse(response.substr(0, response.size()-2));
-        std::cout << "Parsed response:" << std::endl;
-        try {
-            std::cout << format_fci(*tlv) << std::endl;
-        } catch (std::invalid_argument e) {
-            // print response
-            std::cout << "No FCI: " << xpcsc::format(response) << std::endl;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "APDUs sent: " << c.metrics().apdus << ", time: " << ms << " ms" << std::endl;
+
+        if (!repeat) {
+            break;
         }
 
+        // contact cards are matched by ATR and FCI only
+        std::cout << "Cache hit rate: " << fci_cache.hit_rate() * 100 << "% ("
+            << fci_cache.hits() - fci_cache.stale() - fci_cache.atr_only() << " of "
+            << fci_cache.hits() + fci_cache.misses() << " taps), ATR-only matches: " << fci_cache.atr_only() << std::endl;
+
+        taps++;
+        if (max_taps != 0 && taps >= max_taps) {
+            break;
+        }
+
+        try {
+            c.wait_for_card_remove(reader_name);
+        } catch (xpcsc::PCSCError &e) {
+            std::cerr << "Wait for card removal failed: " << e.what() << std::endl;
+            return 1;
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file atr-stats.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Offline analysis of large ATR lists: reads ATRs (one per line, hex,
+ * optional "ATR:" prefix like in dump-atr output) from files or standard
+ * input and prints card types, TCK failures and protocols distribution.
+ *
+ * Input is split between threads, each thread counts distinct ATRs, then
+ * every distinct ATR is parsed only once.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#define error(msg) do { std::cerr << msg << std::endl; } while (0);
+
+struct BytesHash {
+    size_t operator()(const xpcsc::Bytes & b) const {
+        // FNV-1a
+        size_t h = 2166136261u;
+        for (auto i=b.begin(); i!=b.end(); i++) {
+            h = (h ^ *i) * 16777619u;
+        }
+        return h;
+    }
+};
+
+typedef std::unordered_map<xpcsc::Bytes, unsigned long, BytesHash> ATRCounts;
+
+struct ChunkResult {
+    ATRCounts counts;
+    unsigned long total;
+    unsigned long invalid;
+};
+
+void help(const std::string & program)
+{
+    std::cout << "Usage:\n"
+        "    " << program << " [-h] [-j THREADS] [-d ATR_DATABASE] [FILE ...]\n"
+        "Reads ATRs from FILEs or standard input, one ATR per line.";
+    std::cout << std::endl;
+}
+
+static inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// returns false if line is not an ATR, empty lines and comments are skipped by caller
+static bool parse_atr_line(const char * s, const char * end, xpcsc::Bytes & atr)
+{
+    xpcsc::Byte buf[33];
+    size_t size = 0;
+
+    if (end - s >= 4 && strncmp(s, "ATR:", 4) == 0) {
+        s += 4;
+    }
+
+    while (s < end) {
+        if (*s == ' ' || *s == '\t' || *s == '\r') {
+            s++;
+            continue;
+        }
+        if (s+1 >= end || size == sizeof(buf)) {
+            return false;
+        }
+        int h = hex_value(s[0]);
+        int l = hex_value(s[1]);
+        if (h < 0 || l < 0) {
+            return false;
+        }
+        buf[size++] = (h << 4) | l;
+        s += 2;
+    }
+
+    if (size == 0) {
+        return false;
+    }
+    atr.assign(buf, size);
+    return true;
+}
+
+static void process_chunk(const char * begin, const char * end, ChunkResult * result)
+{
+    xpcsc::Bytes atr;
+    result->total = 0;
+    result->invalid = 0;
+
+    while (begin < end) {
+        const char * eol = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        if (eol == 0) {
+            eol = end;
+        }
+
+        const char * s = begin;
+        while (s < eol && (*s == ' ' || *s == '\t' || *s == '\r')) {
+            s++;
+        }
+
+        if (s < eol && *s != '#') {
+            result->total++;
+            if (parse_atr_line(s, eol, atr)) {
+                result->counts[atr]++;
+            } else {
+                result->invalid++;
+            }
+        }
+        begin = eol + 1;
+    }
+}
+
+static bool read_input(std::istream & in, std::string & buffer)
+{
+    std::stringstream ss;
+    ss << in.rdbuf();
+    buffer.append(ss.str());
+    buffer.push_back('\n');
+    return !in.bad();
+}
+
+static std::string protocols_str(const xpcsc::ATRInfo & info)
+{
+    if (info.is_picc) {
+        return "contactless";
+    }
+
+    std::stringstream ss;
+    for (int i=0; i<15; i++) {
+        if (info.protocols & (1 << i)) {
+            if (ss.tellp() > 0) {
+                ss << ",";
+            }
+            ss << "T=" << i;
+        }
+    }
+    return ss.str();
+}
+
+static void print_sorted(const std::map<std::string, unsigned long> & m)
+{
+    std::vector<std::pair<unsigned long, std::string> > rows;
+    for (auto i=m.begin(); i!=m.end(); i++) {
+        rows.push_back(std::make_pair(i->second, i->first));
+    }
+    std::sort(rows.rbegin(), rows.rend());
+
+    char buf[32];
+    for (auto i=rows.begin(); i!=rows.end(); i++) {
+        snprintf(buf, 31, "%12lu", i->first);
+        std::cout << "  " << buf << "  " << i->second << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    xpcsc::Strings files;
+    std::string db_file;
+    unsigned int threads_number = std::thread::hardware_concurrency();
+
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h") {
+            help(argv[0]);
+            return 0;
+        } else if (arg == "-j" && i+1 < argc) {
+            threads_number = atoi(argv[++i]);
+        } else if (arg == "-d" && i+1 < argc) {
+            db_file = argv[++i];
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (threads_number == 0) {
+        threads_number = 1;
+    }
+
+    xpcsc::ATRDatabase db;
+    if (db_file.length() != 0) {
+        try {
+            db.open(db_file);
+        } catch (xpcsc::ATRDatabaseError &e) {
+            error("Cannot load ATR database: " << e.what());
+            return 1;
+        }
+    }
+
+    // STAGE 1
+    // read whole input
+    std::string buffer;
+
+    if (files.size() == 0) {
+        read_input(std::cin, buffer);
+    }
+    for (auto i=files.begin(); i!=files.end(); i++) {
+        std::ifstream file(*i, std::ios::binary);
+        if (file.fail() || !read_input(file, buffer)) {
+            error("Cannot read file " << *i);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // STAGE 2
+    // split buffer at line boundaries and count distinct ATRs in parallel
+    std::vector<ChunkResult> results(threads_number);
+    std::vector<std::thread> threads;
+
+    const char * data = buffer.data();
+    const char * end = data + buffer.size();
+    size_t chunk_size = buffer.size() / threads_number + 1;
+    const char * chunk = data;
+
+    for (unsigned int i=0; i<threads_number && chunk < end; i++) {
+        const char * chunk_end = chunk + chunk_size;
+        if (chunk_end >= end) {
+            chunk_end = end;
+        } else {
+            chunk_end = static_cast<const char *>(memchr(chunk_end, '\n', end - chunk_end));
+            chunk_end = chunk_end ? chunk_end + 1 : end;
+        }
+        threads.push_back(std::thread(process_chunk, chunk, chunk_end, &results[i]));
+        chunk = chunk_end;
+    }
+
+    for (auto i=threads.begin(); i!=threads.end(); i++) {
+        i->join();
+    }
+
+    ATRCounts counts;
+    unsigned long total = 0;
+    unsigned long invalid = 0;
+
+    for (size_t i=0; i<threads.size(); i++) {
+        total += results[i].total;
+        invalid += results[i].invalid;
+        const ATRCounts & rc = results[i].counts;
+        for (auto j=rc.begin(); j!=rc.end(); j++) {
+            counts[j->first] += j->second;
+        }
+    }
+
+    // STAGE 3
+    // classify every distinct ATR once
+    std::map<std::string, unsigned long> card_types;
+    std::map<std::string, unsigned long> protocols;
+    unsigned long tck_failures = 0;
+
+    xpcsc::ATRParser p;
+    for (auto i=counts.begin(); i!=counts.end(); i++) {
+        const xpcsc::Bytes & atr = i->first;
+        unsigned long n = i->second;
+
+        try {
+            p.load(atr);
+        } catch (std::exception &e) {
+            card_types["Invalid ATR"] += n;
+            continue;
+        }
+
+        const xpcsc::ATRInfo & info = p.info();
+        const xpcsc::ATRClassification & cl = p.classification();
+
+        if (info.has_tck && !info.tck_valid) {
+            tck_failures += n;
+        }
+        protocols[protocols_str(info)] += n;
+
+        const char * name = db.match(atr);
+        if (!cl.card_name.empty()) {
+            card_types[cl.card_name] += n;
+        } else if (name != 0) {
+            card_types[name] += n;
+        } else if (info.is_picc) {
+            card_types["Unknown contactless card"] += n;
+        } else {
+            card_types["Unknown contact card"] += n;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "ATRs: " << total << " (distinct: " << counts.size() 
+        << ", invalid lines: " << invalid << ")" << std::endl;
+    std::cout << "Processed in " << seconds << " s using " << threads.size() << " threads";
+    if (seconds > 0) {
+        std::cout << ", " << static_cast<unsigned long>(total / seconds) << " ATR/s";
+    }
+    std::cout << std::endl;
+    std::cout << "TCK failures: " << tck_failures << std::endl;
+    std::cout << "Protocols:" << std::endl;
+    print_sorted(protocols);
+    std::cout << "Card types:" << std::endl;
+    print_sorted(card_types);
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file compile-aid-registry.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Compile text list of well-known AIDs ("AID_HEX|description" lines) into
+ * C++ source with constant trie used by xpcsc::aid_registry_lookup(), run
+ *
+ *     compile-aid-registry ../libxpcsc/src/aids.txt ../libxpcsc/src/aidregistry_data.hpp
+ *
+ * after editing the list.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <vector>
+
+struct TrieNode {
+    std::map<xpcsc::Byte, size_t> children;
+    // entry index + 1, 0 if no AID ends here
+    size_t entry;
+    TrieNode() : entry(0) {};
+};
+
+struct Entry {
+    xpcsc::Bytes aid;
+    std::string description;
+};
+
+std::string c_string(const std::string & s)
+{
+    std::string res = "\"";
+    for (auto i=s.begin(); i!=s.end(); i++) {
+        if (*i == '"' || *i == '\\') {
+            res += '\\';
+        }
+        res += *i;
+    }
+    return res + "\"";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        std::cout << "Usage:\n"
+            "    " << argv[0] << " AIDS_TXT TARGET_HPP" << std::endl;
+        return 0;
+    }
+
+    std::ifstream source(argv[1]);
+    if (source.fail()) {
+        std::cerr << "Cannot open source file!" << std::endl;
+        return 1;
+    }
+
+    std::vector<Entry> entries;
+    std::set<xpcsc::Bytes> seen;
+    std::string line;
+    size_t line_number = 0;
+
+    while (std::getline(source, line)) {
+        line_number++;
+        if (line.empty() || line.at(0) == '#') {
+            continue;
+        }
+        auto p = line.find('|');
+        Entry e;
+        try {
+            e.aid = xpcsc::parse_apdu(line.substr(0, p));
+        } catch (xpcsc::APDUParseError &ex) {
+            std::cerr << "Bad AID at line " << line_number << std::endl;
+            return 1;
+        }
+        if (e.aid.empty() || e.aid.size() > 16) {
+            std::cerr << "Bad AID length at line " << line_number << std::endl;
+            return 1;
+        }
+        if (p != std::string::npos) {
+            e.description = line.substr(p+1);
+            e.description.erase(e.description.find_last_not_of(" \t\r") + 1);
+        }
+        // the first description wins
+        if (seen.insert(e.aid).second) {
+            entries.push_back(e);
+        }
+    }
+
+    // build trie
+    std::vector<TrieNode> nodes(1);
+    for (size_t i=0; i < entries.size(); i++) {
+        size_t node = 0;
+        const xpcsc::Bytes & aid = entries[i].aid;
+        for (auto b=aid.begin(); b!=aid.end(); b++) {
+            auto c = nodes[node].children.find(*b);
+            if (c == nodes[node].children.end()) {
+                nodes.push_back(TrieNode());
+                c = nodes[node].children.insert(std::make_pair(*b, nodes.size() - 1)).first;
+            }
+            node = c->second;
+        }
+        nodes[node].entry = i + 1;
+    }
+
+    if (nodes.size() > 0xFFFF) {
+        std::cerr << "Too many AIDs!" << std::endl;
+        return 1;
+    }
+
+    std::ofstream target(argv[2], std::ios::trunc);
+    if (target.fail()) {
+        std::cerr << "Cannot create target file!" << std::endl;
+        return 1;
+    }
+
+    target << "// generated by example-utils/compile-aid-registry from aids.txt, don't edit\n\n";
+    target << std::hex << std::uppercase << std::setfill('0');
+
+    target << "static constexpr Byte AID_BYTES[] = {";
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    for (size_t i=0; i < entries.size(); i++) {
+        target << "\n   ";
+        for (auto b=entries[i].aid.begin(); b!=entries[i].aid.end(); b++) {
+            target << " 0x" << std::setw(2) << int(*b) << ",";
+        }
+        offsets.push_back(offset);
+        offset += entries[i].aid.size();
+    }
+    target << "\n};\n\n" << std::dec;
+
+    target << "static constexpr AIDRegistryEntry AID_ENTRIES[] = {\n";
+    for (size_t i=0; i < entries.size(); i++) {
+        target << "    {AID_BYTES + " << offsets[i] << ", " << entries[i].aid.size() << ", "
+            << c_string(entries[i].description) << "},\n";
+    }
+    target << "};\n\n";
+
+    // children of every node are stored contiguously, sorted by byte
+    std::vector<size_t> first_edge(nodes.size());
+    size_t edges = 0;
+    for (size_t i=0; i < nodes.size(); i++) {
+        first_edge[i] = edges;
+        edges += nodes[i].children.size();
+    }
+
+    target << "static constexpr AIDTrieNode AID_TRIE_NODES[] = {\n";
+    for (size_t i=0; i < nodes.size(); i++) {
+        target << "    {" << first_edge[i] << ", " << nodes[i].children.size() << ", "
+            << nodes[i].entry << "},\n";
+    }
+    target << "};\n\n";
+
+    target << "static constexpr AIDTrieEdge AID_TRIE_EDGES[] = {\n" << std::hex;
+    for (size_t i=0; i < nodes.size(); i++) {
+        for (auto c=nodes[i].children.begin(); c!=nodes[i].children.end(); c++) {
+            target << "    {0x" << std::setw(2) << int(c->first) << ", " << std::dec << c->second
+                << std::hex << "},\n";
+        }
+    }
+    target << "};\n";
+
+    if (target.fail()) {
+        std::cerr << "Cannot write target file!" << std::endl;
+        return 1;
+    }
+
+    std::cout << "AIDs: " << entries.size() << ", trie nodes: " << nodes.size() << std::endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file compile-key-dict.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Compile text MIFARE Classic keys list (one key per line or keys file
+ * used by dump-mifare-card) into binary dictionary used by
+ * xpcsc::MifareKeyDictionary.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <fstream>
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        std::cout << "Usage:\n"
+            "    " << argv[0] << " KEYS_TXT DICTIONARY_FILE" << std::endl;
+        return 0;
+    }
+
+    std::ifstream source(argv[1]);
+    if (source.fail()) {
+        std::cerr << "Cannot open source file!" << std::endl;
+        return 1;
+    }
+
+    std::ofstream target(argv[2], std::ios::binary | std::ios::trunc);
+    if (target.fail()) {
+        std::cerr << "Cannot create dictionary file!" << std::endl;
+        return 1;
+    }
+
+    try {
+        size_t count = xpcsc::MifareKeyDictionary::compile(source, target);
+        std::cout << "Compiled unique keys: " << count << std::endl;
+    } catch (xpcsc::MifareKeyDictionaryError &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -30,6 +30,8 @@
  * @author Sergey Stolyarov <sergei@regolit.com>
  *
  * Scan card, print ATR and print detailed parsed ATR.
+ * Card is identified using compiled ATR database if it's specified
+ * with "-d" option, see compile-atr-db.cpp.
  */
 
 #include <xpcsc.hpp>
@@ -40,6 +42,17 @@
 
 int main(int argc, char **argv)
 {
+    xpcsc::ATRDatabase db;
+
+    if (argc == 3 && strcmp(argv[1], "-d") == 0) {
+        try {
+            db.open(argv[2]);
+        } catch (xpcsc::ATRDatabaseError &e) {
+            std::cerr << "Cannot load ATR database: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     xpcsc::Connection c;
 
     try {
@@ -75,4 +88,9 @@ int main(int argc, char **argv)
     p.load(atr);
     
     std::cout << p.str() << std::endl;
+
+    if (db.size() > 0) {
+        const char * name = db.match(atr);
+        std::cout << "Identified as: " << (name ? name : "unknown card") << std::endl;
+    }
 }
\ No newline at end of file
@@ -39,6 +39,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <cstring>
 #include <cstdlib>
 #include <algorithm>
@@ -67,6 +68,9 @@ struct SectorKeys {
 
     size_t key_B_blocks_size;
     int key_B_blocks[4];
+
+    bool has_key_A;
+    bool has_key_B;
 };
 
 /*
@@ -95,15 +99,27 @@ typedef std::vector<Block> CardContents;
 void help(const std::string & program)
 {
     std::cout << "Usage:\n"
-        "    " << program << " [-h] [-f KEYS_FILE]";
+        "    " << program << " [-h] [-m] [-b] [-f KEYS_FILE] [-d DICTIONARY] [-s STATS_FILE] [-c CACHE_FILE]\n"
+        "\n"
+        "    -b  benchmark card dump with block by block and multi-block reads\n"
+        "    -c  keys that worked for card before are tried first for sectors\n"
+        "        missing in keys file, default is ~/.xpcsc-mifare-keys.cache,\n"
+        "        \"-\" disables cache\n"
+        "    -d  search keys of sectors missing in keys file in text or compiled\n"
+        "        (see compile-key-dict) dictionary\n"
+        "    -s  key hit statistics file used by -d search, default is\n"
+        "        ~/.xpcsc-mifare-keys.stats, \"-\" disables statistics\n"
+        "    -m  read blocks with keys exactly as keys file usage column says,\n"
+        "        by default access conditions from sector trailers are used to\n"
+        "        read every sector with as few authentications as possible";
     std::cout << std::endl;
 }
 
 #define error(msg) do { std::cerr << msg << std::endl; } while (0);
 
-std::string arg_keys(const xpcsc::Strings args)
+std::string arg_value(const xpcsc::Strings args, const std::string & name)
 {
-    auto p = std::find(args.begin(), args.end(), "-f");
+    auto p = std::find(args.begin(), args.end(), name);
     std::string filename;
 
     if (p == args.end()) {
@@ -291,33 +307,208 @@ bool read_keys(std::ifstream & file, Keys & keys)
         }
 
         // everything looks fine here,
+        sks.has_key_A = !key_A_missing;
+        sks.has_key_B = !key_B_missing;
         keys[sector_num] = sks;
         // PRINT_DEBUG(tokens.size());
     }
     return true;
 }
 
-const xpcsc::Byte CMD_LOAD_KEYS[] = {0xFF, 0x82, 0x00, 0x00, 
-    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+// total number of blocks on card
+size_t card_blocks(size_t sectors)
+{
+    return xpcsc::mifare_sector_first_block(sectors - 1) + xpcsc::mifare_sector_blocks(sectors - 1);
+}
+
+// blocks (offsets from sector first block) covered by keys file usage column
+// position, in 16-block sectors it stands for access bits group
+void usage_blocks(size_t sector_blocks, int position, size_t & first, size_t & count)
+{
+    if (sector_blocks == 4) {
+        first = position;
+        count = 1;
+    } else if (position == 3) {
+        first = sector_blocks - 1;
+        count = 1;
+    } else {
+        first = position * 5;
+        count = 5;
+    }
+}
+
+// read sector blocks listed in keys file with given key, false if authentication failed
+bool read_blocks(xpcsc::MifareClassicSession & session, size_t sector, KeyType key_type,
+    const SectorKeys & sector_keys, CardContents & card)
+{
+    const size_t first_block = xpcsc::mifare_sector_first_block(sector);
+    const size_t sector_blocks = xpcsc::mifare_sector_blocks(sector);
+    xpcsc::Bytes data;
+
+    const Byte6 & key = (key_type == KeyA) ? sector_keys.key_A : sector_keys.key_B;
+    const char * key_str = (key_type == KeyA) ? sector_keys.key_A_str : sector_keys.key_B_str;
+    const int * blocks = (key_type == KeyA) ? sector_keys.key_A_blocks : sector_keys.key_B_blocks;
+    size_t blocks_size = (key_type == KeyA) ? sector_keys.key_A_blocks_size : sector_keys.key_B_blocks_size;
+
+    if (blocks_size == 0) {
+        return true;
+    }
+
+    if (!session.authenticate(first_block, (key_type == KeyA) ? xpcsc::MifareKeyA : xpcsc::MifareKeyB, key)) {
+        error("Cannot use key " << (key_type == KeyA ? "A" : "B") << " for sector " << sector << " auth.");
+        return false;
+    }
+
+    for (size_t j = 0; j < blocks_size; j++) {
+        size_t offset, count;
+        usage_blocks(sector_blocks, blocks[j], offset, count);
+
+        for (size_t block = first_block + offset; block < first_block + offset + count; block++) {
+            Block & b = card[block];
+
+            if (!session.read_block(block, data)) {
+                error("Failed to read block " << block << " using key " << (key_type == KeyA ? "A " : "B ") << key_str);
+                continue;
+            }
+            memcpy(b.data, data.data(), 16);
+            b.key_type = key_type;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Read sector using its trailer access conditions instead of keys file usage column:
+ * trailer is read first and the rest of blocks are read with the same key whenever
+ * access conditions allow, so most sectors require single authentication.
+ * Returns false if trailer cannot be read or decoded, keys file usage must be used then.
+ */
+bool read_sector_planned(xpcsc::MifareClassicSession & session, size_t sector,
+    const SectorKeys & sector_keys, CardContents & card)
+{
+    const size_t first_block = xpcsc::mifare_sector_first_block(sector);
+    const size_t sector_blocks = xpcsc::mifare_sector_blocks(sector);
+    const size_t trailer_block = first_block + sector_blocks - 1;
+    xpcsc::Bytes data;
+
+    if (!sector_keys.has_key_A && !sector_keys.has_key_B) {
+        return false;
+    }
+
+    KeyType first = sector_keys.has_key_A ? KeyA : KeyB;
+    const Byte6 * keys[2] = {&sector_keys.key_A, &sector_keys.key_B};
+    xpcsc::MifareKeyType key_types[2] = {xpcsc::MifareKeyA, xpcsc::MifareKeyB};
+
+    // key A can always read access bits
+    if (!session.authenticate(first_block, key_types[first], *keys[first])) {
+        return false;
+    }
+
+    // usually the whole sector is readable with the first key, read it in one exchange then
+    // (16-block sectors don't fit into one response)
+    if (sector_blocks == 4 && session.multi_block_read() && session.read_blocks(first_block, 4, data)
+        && xpcsc::mifare_access_bits_valid(data[48 + 6], data[48 + 7], data[48 + 8]))
+    {
+        for (size_t i = 0; i < 4; i++) {
+            memcpy(card[first_block + i].data, data.data() + i*16, 16);
+            card[first_block + i].key_type = first;
+        }
+        return true;
+    }
+
+    // failed read drops authentication
+    if (!session.authenticate(first_block, key_types[first], *keys[first])) {
+        return false;
+    }
+    if (!session.read_block(trailer_block, data)) {
+        return false;
+    }
+    if (!xpcsc::mifare_access_bits_valid(data[6], data[7], data[8])) {
+        PRINT_DEBUG("[D] Invalid access bits in sector " << sector << " trailer");
+        return false;
+    }
+
+    Block & trailer = card[trailer_block];
+    memcpy(trailer.data, data.data(), 16);
+    trailer.key_type = first;
+
+    xpcsc::BlocksAccessBits bits;
+    xpcsc::parse_access_bits(data[7], data[8], &bits);
+
+    xpcsc::Byte available = (sector_keys.has_key_A ? xpcsc::MifareAccessKeyA : 0)
+        | (sector_keys.has_key_B ? xpcsc::MifareAccessKeyB : 0);
+    xpcsc::MifareReadPlan plan;
+    xpcsc::mifare_plan_read(bits, key_types[first], available, plan);
+
+    // blocks readable by current key first, then the rest after one more authentication,
+    // adjacent blocks are read in one exchange if reader supports it
+    KeyType order[2] = {first, (first == KeyA) ? KeyB : KeyA};
+    for (size_t k = 0; k < 2; k++) {
+        KeyType key_type = order[k];
+        size_t i = 0;
+
+        // data blocks
+        while (i < sector_blocks - 1) {
+            if (plan.block_key[xpcsc::mifare_block_access_group(first_block + i)] != key_types[key_type]) {
+                i++;
+                continue;
+            }
+            size_t count = 1;
+            while (i + count < sector_blocks - 1
+                && plan.block_key[xpcsc::mifare_block_access_group(first_block + i + count)] == key_types[key_type])
+            {
+                count++;
+            }
 
-// template for General Auth command
-const xpcsc::Byte CMD_GENERAL_AUTH[] = {0xFF, 0x86, 0x00, 0x00, 
-    0x05, 0x01, 0x00, 0x00, 0x60, 0x00};
+            if (!session.authenticate(first_block, key_types[key_type], *keys[key_type])) {
+                error("Cannot use key " << (key_type == KeyA ? "A" : "B") << " for sector " << sector << " auth.");
+                break;
+            }
 
-// template for Read Binary command
-const xpcsc::Byte CMD_READ_BINARY[] = {0xFF, 0xB0, 0x00, 0x00, 0x10};
+            size_t block = first_block + i;
+            if (!session.read_blocks(block, count, data)) {
+                error("Failed to read blocks " << block << "-" << (block + count - 1));
+            } else {
+                for (size_t j = 0; j < count; j++) {
+                    memcpy(card[block + j].data, data.data() + j*16, 16);
+                    card[block + j].key_type = key_type;
+                }
+            }
+            i += count;
+        }
+    }
+
+    return true;
+}
 
-bool read_mifare_1k(xpcsc::Connection & c, xpcsc::Reader reader, const Keys & keys, CardContents & card)
+bool read_mifare(xpcsc::MifareClassicSession & session, const Keys & keys, size_t sectors,
+    bool use_planner, CardContents & card)
 {
-    // 16 sectors, 4 blocks each
-    xpcsc::Bytes command;
-    xpcsc::Bytes response;
+    // visit sectors sharing the same keys one after another,
+    // so each key is loaded into reader key slot only once
+    std::vector<size_t> order;
+    std::map<size_t, std::string> order_keys;
+    for (size_t sector = 0; sector < sectors; sector++) {
+        order.push_back(sector);
+        auto ps = keys.find(sector);
+        if (ps == keys.end()) {
+            continue;
+        }
+        const SectorKeys & sk = ps->second;
+        order_keys[sector] = std::string(sk.has_key_A ? sk.key_A_str : "-")
+            + ":" + std::string(sk.has_key_B ? sk.key_B_str : "-");
+    }
+    std::stable_sort(order.begin(), order.end(), [&order_keys](size_t a, size_t b) {
+        return order_keys[a] < order_keys[b];
+    });
 
-    for (size_t sector = 0; sector < 16; sector++) {
-        const size_t first_block = sector * 4;
+    for (size_t sector : order) {
+        const size_t first_block = xpcsc::mifare_sector_first_block(sector);
+        const size_t sector_blocks = xpcsc::mifare_sector_blocks(sector);
 
         // initialize block with default data
-        for (size_t i=0; i < 4; i++) {
+        for (size_t i=0; i < sector_blocks; i++) {
             Block & b = card[first_block+i];
             b.sector = sector;
             b.key_type = KeyNone;
@@ -326,120 +517,201 @@ bool read_mifare_1k(xpcsc::Connection & c, xpcsc::Reader reader, const Keys & ke
 
         auto ps = keys.find(sector);
         if (ps == keys.end()) {
-            // no key, all 4 blocks are not possible to read
+            // no key, sector blocks are not possible to read
             continue;  // next sector
         }
 
         const SectorKeys & sector_keys = ps->second;
 
-        // Keys A first
-        if (sector_keys.key_A_blocks_size > 0) {
-            // there are  Key A blocks so authenticate as Key A
-            command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-            command.replace(5, 6, sector_keys.key_A, 6);
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                error("Cannot load key A for sector" << sector );
+        if (!use_planner || !read_sector_planned(session, sector, sector_keys, card)) {
+            // Keys A first
+            if (!read_blocks(session, sector, KeyA, sector_keys, card)) {
                 continue;  // try next sector
             }
-
-            command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-            command[7] = first_block;
-            command[8] = 0x60;
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                error("Cannot use key A for sector " << sector << " auth.");
+            if (!read_blocks(session, sector, KeyB, sector_keys, card)) {
                 continue;  // try next sector
             }
+        }
 
-            // read "sector_keys.key_A_blocks_size" blocks
-            for (size_t j = 0; j < sector_keys.key_A_blocks_size; j++) {
-                size_t block = first_block + sector_keys.key_A_blocks[j];
-                Block & b = card[block];
-
-                command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-                command[3] = block;
-                c.transmit(reader, command, &response);
-                if (c.response_status(response) != 0x9000) {
-                    error("Failed to read block " << block << " using key A " << sector_keys.key_A_str);
-                    continue;
-                }
-                memcpy(b.data, response.data(), 16);
-                b.key_type = KeyA;
+        // fill access bits if they are available
+        Block & trailer = card[first_block + sector_blocks - 1];
+        if (trailer.key_type != KeyNone) {
+            xpcsc::BlocksAccessBits bits;
+            xpcsc::parse_access_bits(trailer.data[7], trailer.data[8], &bits);
+
+            for (size_t i = 0; i < sector_blocks; i++) {
+                Block & b = card[first_block+i];
+                xpcsc::Byte group = xpcsc::mifare_block_access_group(first_block + i);
+                b.is_access_set = true;
+                b.C1 = CHECK_BIT(bits[group], 2);
+                b.C2 = CHECK_BIT(bits[group], 1);
+                b.C3 = CHECK_BIT(bits[group], 0);
             }
         }
+    }
+    return true;
+}
 
-        if (sector_keys.key_B_blocks_size > 0) {
-            // there are  Key A blocks so authenticate as Key A
-            command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
-            command.replace(5, 6, sector_keys.key_B, 6);
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                error("Cannot load key B for sector" << sector );
-                continue;  // try next sector
-            }
+void set_sector_key(SectorKeys & sks, KeyType key_type, const xpcsc::Byte * key)
+{
+    bool is_A = (key_type == KeyA);
+    memcpy(is_A ? sks.key_A : sks.key_B, key, 6);
+    char * key_str = is_A ? sks.key_A_str : sks.key_B_str;
+    for (size_t i = 0; i < 6; i++) {
+        snprintf(key_str + i*2, 3, "%02x", key[i]);
+    }
+    if (is_A) {
+        sks.has_key_A = true;
+    } else {
+        sks.has_key_B = true;
+    }
 
-            command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
-            command[7] = first_block;
-            command[8] = 0x61;
-            c.transmit(reader, command, &response);
-            if (c.response_status(response) != 0x9000) {
-                error("Cannot use key B for sector " << sector << " auth.");
-                continue;  // try next sector
-            }
+    // without access conditions key A reads everything it can, key B the rest
+    sks.key_A_blocks_size = 0;
+    sks.key_B_blocks_size = 0;
+    for (int i = 0; i < 4; i++) {
+        if (sks.has_key_A) {
+            sks.key_A_blocks[sks.key_A_blocks_size++] = i;
+        } else {
+            sks.key_B_blocks[sks.key_B_blocks_size++] = i;
+        }
+    }
+}
 
-            // read "sector_keys.key_B_blocks_size" blocks
-            for (size_t j = 0; j < sector_keys.key_B_blocks_size; j++) {
-                size_t block = first_block + sector_keys.key_B_blocks[j];
-                Block & b = card[block];
-
-                command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
-                command[3] = block;
-                c.transmit(reader, command, &response);
-                if (c.response_status(response) != 0x9000) {
-                    error("Failed to read block " << block << " using key B " << sector_keys.key_B_str);
-                    continue;
-                }
-                memcpy(b.data, response.data(), 16);
-                b.key_type = KeyB;
+// use keys that worked last time for sectors missing in keys file,
+// key is checked by authentication first because card keys could be changed
+void use_cached_keys(xpcsc::MifareClassicSession & session, const xpcsc::MifareCachedKeys & cached, Keys & keys)
+{
+    std::map<size_t, SectorKeys> found;
+
+    // key B first, so sector ends authenticated with key A which is used first for reading
+    for (int pass = 0; pass < 2; pass++) {
+        xpcsc::MifareKeyType key_type = (pass == 0) ? xpcsc::MifareKeyB : xpcsc::MifareKeyA;
+
+        for (auto it = cached.begin(); it != cached.end(); it++) {
+            if (it->key_type != key_type || keys.find(it->sector) != keys.end()) {
+                continue;
             }
+            if (!session.authenticate(xpcsc::mifare_sector_first_block(it->sector), key_type, it->key)) {
+                continue;
+            }
+            auto fi = found.find(it->sector);
+            if (fi == found.end()) {
+                SectorKeys sks;
+                sks.has_key_A = false;
+                sks.has_key_B = false;
+                fi = found.insert(std::make_pair(it->sector, sks)).first;
+            }
+            set_sector_key(fi->second, (key_type == xpcsc::MifareKeyA) ? KeyA : KeyB, it->key);
         }
-        
-        // fill access bits if they are available
-        Block & trailer = card[first_block+3];
-        Block * pblock;
-        if (trailer.key_type != KeyNone) {
-            xpcsc::Byte b7 = trailer.data[7];
-            xpcsc::Byte b8 = trailer.data[8];
-
-            pblock = &(card[first_block+0]);
-            pblock->is_access_set = true;
-            pblock->C1 = CHECK_BIT(b7, 4);
-            pblock->C2 = CHECK_BIT(b8, 0);
-            pblock->C3 = CHECK_BIT(b7, 4);
-
-            pblock = &(card[first_block+1]);
-            pblock->is_access_set = true;
-            pblock->C1 = CHECK_BIT(b7, 5);
-            pblock->C2 = CHECK_BIT(b8, 1);
-            pblock->C3 = CHECK_BIT(b7, 5);
-
-            pblock = &(card[first_block+2]);
-            pblock->is_access_set = true;
-            pblock->C1 = CHECK_BIT(b7, 6);
-            pblock->C2 = CHECK_BIT(b8, 2);
-            pblock->C3 = CHECK_BIT(b7, 6);
-
-            pblock = &(card[first_block+3]);
-            pblock->is_access_set = true;
-            pblock->C1 = CHECK_BIT(b7, 7);
-            pblock->C2 = CHECK_BIT(b8, 3);
-            pblock->C3 = CHECK_BIT(b7, 7);
+    }
+
+    keys.insert(found.begin(), found.end());
+}
+
+// keys that were used to read blocks
+void collect_used_keys(const Keys & keys, const CardContents & card, size_t sectors, xpcsc::MifareCachedKeys & used)
+{
+    used.clear();
+    for (size_t sector = 0; sector < sectors; sector++) {
+        auto ps = keys.find(sector);
+        if (ps == keys.end()) {
+            continue;
+        }
+
+        bool used_A = false;
+        bool used_B = false;
+        const size_t first_block = xpcsc::mifare_sector_first_block(sector);
+        for (size_t i = 0; i < xpcsc::mifare_sector_blocks(sector); i++) {
+            used_A = used_A || card[first_block + i].key_type == KeyA;
+            used_B = used_B || card[first_block + i].key_type == KeyB;
+        }
+
+        xpcsc::MifareCachedKey k;
+        k.sector = sector;
+        if (used_A) {
+            k.key_type = xpcsc::MifareKeyA;
+            memcpy(k.key, ps->second.key_A, 6);
+            used.push_back(k);
+        }
+        if (used_B) {
+            k.key_type = xpcsc::MifareKeyB;
+            memcpy(k.key, ps->second.key_B, 6);
+            used.push_back(k);
+        }
+    }
+}
+
+bool same_keys(const xpcsc::MifareCachedKeys & a, const xpcsc::MifareCachedKeys & b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].sector != b[i].sector || a[i].key_type != b[i].key_type || memcmp(a[i].key, b[i].key, 6) != 0) {
+            return false;
         }
     }
     return true;
 }
 
+// find key for every sector missing in keys file, found key is used to read all sector blocks
+void search_missing_keys(xpcsc::MifareClassicSession & session, xpcsc::MifareKeySearch & search,
+    const std::string & family, size_t sectors, Keys & keys)
+{
+    for (size_t sector = 0; sector < sectors; sector++) {
+        if (keys.find(sector) != keys.end()) {
+            continue;
+        }
+
+        xpcsc::MifareKeyType key_type;
+        xpcsc::Bytes key;
+        if (!search.search(session, family, sector, key_type, key)) {
+            error("No key found for sector " << sector << " in dictionary");
+            continue;
+        }
+
+        SectorKeys sks;
+        sks.has_key_A = false;
+        sks.has_key_B = false;
+        set_sector_key(sks, (key_type == xpcsc::MifareKeyA) ? KeyA : KeyB, key.data());
+        keys[sector] = sks;
+    }
+}
+
+// APDUs reading card as keys file usage column says: LOAD KEYS per distinct key,
+// GENERAL AUTHENTICATE per used key and READ BINARY per block
+size_t keys_file_plan_apdus(const Keys & keys)
+{
+    std::set<std::string> loaded;
+    size_t apdus = 0;
+
+    for (auto it = keys.begin(); it != keys.end(); it++) {
+        const SectorKeys & sk = it->second;
+        const size_t sector_blocks = xpcsc::mifare_sector_blocks(it->first);
+        size_t offset, count;
+
+        if (sk.key_A_blocks_size > 0) {
+            loaded.insert(sk.key_A_str);
+            apdus++;
+            for (size_t i = 0; i < sk.key_A_blocks_size; i++) {
+                usage_blocks(sector_blocks, sk.key_A_blocks[i], offset, count);
+                apdus += count;
+            }
+        }
+        if (sk.key_B_blocks_size > 0) {
+            loaded.insert(sk.key_B_str);
+            apdus++;
+            for (size_t i = 0; i < sk.key_B_blocks_size; i++) {
+                usage_blocks(sector_blocks, sk.key_B_blocks[i], offset, count);
+                apdus += count;
+            }
+        }
+    }
+
+    return apdus + loaded.size();
+}
+
 int main(int argc, char **argv)
 {
     if (argc == 1) {
@@ -458,26 +730,72 @@ int main(int argc, char **argv)
         return 0;
     }
 
-    std::string keys_file = arg_keys(args);
+    std::string keys_file = arg_value(args, "-f");
+    std::string dictionary_file = arg_value(args, "-d");
+    std::string cache_file = arg_value(args, "-c");
+    std::string stats_file = arg_value(args, "-s");
+    const char * home = getenv("HOME");
+    if (cache_file.length() == 0 && home != 0) {
+        cache_file = std::string(home) + "/.xpcsc-mifare-keys.cache";
+    }
+    if (cache_file == "-") {
+        cache_file.clear();
+    }
+    if (stats_file.length() == 0 && home != 0) {
+        stats_file = std::string(home) + "/.xpcsc-mifare-keys.stats";
+    }
+    if (stats_file == "-") {
+        stats_file.clear();
+    }
+    bool manual = std::find(args.begin(), args.end(), "-m") != args.end();
+    bool benchmark = std::find(args.begin(), args.end(), "-b") != args.end();
 
-    if (keys_file.length() == 0) {
-        error("-f argument is required!");
+    if (keys_file.length() == 0 && dictionary_file.length() == 0) {
+        error("-f or -d argument is required!");
         return 1;
     }
 
     // STAGE 1
     // open file "keys_file" and read keys from there
-    std::ifstream file;
-    file.open(keys_file);
+    Keys keys;
+    if (keys_file.length() != 0) {
+        std::ifstream file;
+        file.open(keys_file);
 
-    if (file.fail()) {
-        error("Cannot open keys file!");
-        return 1;
+        if (file.fail()) {
+            error("Cannot open keys file!");
+            return 1;
+        }
+
+        if (!read_keys(file, keys)) {
+            return 1;
+        }
     }
 
-    Keys keys;
-    if (!read_keys(file, keys)) {
-        return 1;
+    // keys that worked last time, by card UID
+    xpcsc::MifareKeyCache cache;
+    bool cache_opened = false;
+    if (cache_file.length() != 0) {
+        try {
+            cache.open(cache_file);
+            cache_opened = true;
+        } catch (xpcsc::MifareKeyCacheError &e) {
+            error("Keys cache is not used: " << e.what());
+        }
+    }
+
+    // keys for sectors not listed in keys file are searched in dictionary
+    xpcsc::MifareKeySearch search;
+    if (dictionary_file.length() != 0) {
+        try {
+            search.load_keys(dictionary_file);
+        } catch (xpcsc::MifareKeyDictionaryError &e) {
+            error(e.what());
+            return 1;
+        }
+        if (stats_file.length() != 0 && !search.load_stats(stats_file)) {
+            error("[W] Broken key statistics file: " << stats_file);
+        }
     }
 
     // STAGE 2
@@ -485,8 +803,15 @@ int main(int argc, char **argv)
 
     xpcsc::Connection c;
 
+    // card image named by XPCSC_VIRTUAL_MIFARE replaces reader and card
+    xpcsc::VirtualMifareImageFile virtual_card;
     try {
-        c.init();
+        if (!virtual_card.attach(c)) {
+            c.init();
+        }
+    } catch (xpcsc::ConnectionError &e) {
+        std::cerr << "[E] " << e.what() << std::endl;
+        return 1;
     } catch (xpcsc::PCSCError &e) {
         std::cerr << "Connection to PC/SC failed: " << e.what() << std::endl;
         return 1;
@@ -514,6 +839,8 @@ int main(int argc, char **argv)
     xpcsc::ATRParser p;
     p.load(atr);
 
+    // watch for degraded contacts or slow reader
+    c.set_timing(p.info());
 
     // STAGE 3
     // check is card compatible
@@ -522,24 +849,71 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    if (!p.checkFeature(xpcsc::ATR_FEATURE_MIFARE_1K)) {
+    // Mini, 1K or 4K
+    const size_t sectors = xpcsc::mifare_sectors(p.classification());
+    if (sectors == 0) {
         error("Card type is not supported");
         return 1;
     }
 
     // STAGE 4
     // read card contents
-    size_t total_blocks = 0;
+    const size_t total_blocks = card_blocks(sectors);
 
-    CardContents card(64);
-    if (p.checkFeature(xpcsc::ATR_FEATURE_MIFARE_1K) ||
-        p.checkFeature(xpcsc::ATR_FEATURE_INFINEON_SLE_66R35)) 
-    {
-        if (!read_mifare_1k(c, reader, keys, card)) {
-            error("Failed to read card contents");
-            return 1;
+    CardContents card(total_blocks);
+    xpcsc::MifareClassicSession session(c, reader);
+    xpcsc::Bytes uid;
+    xpcsc::MifareCachedKeys cached;
+
+    // keys that worked for this card before
+    if (cache_opened && session.read_uid(uid) && cache.lookup(uid, cached)) {
+        use_cached_keys(session, cached, keys);
+    }
+
+    if (dictionary_file.length() != 0) {
+        std::string family = xpcsc::format(atr);
+        family.erase(std::remove(family.begin(), family.end(), ' '), family.end());
+        search_missing_keys(session, search, family, sectors, keys);
+        if (stats_file.length() != 0 && !search.save_stats(stats_file)) {
+            error("[W] Failed to save key statistics: " << stats_file);
+        }
+    }
+
+    if (benchmark) {
+        // the same dump with block by block reads and multi-block reads,
+        // keys are reloaded every time so runs are equal
+        for (int multi = 0; multi < 2; multi++) {
+            CardContents bench_card(total_blocks);
+            session.reset();
+            session.set_multi_block_read(multi == 1);
+            c.reset_metrics();
+            read_mifare(session, keys, sectors, !manual, bench_card);
+
+            const xpcsc::TransmitMetrics & m = c.metrics();
+            std::cerr << (multi ? "Multi-block reads:  " : "Single-block reads: ")
+                << m.apdus << " APDUs, " << m.total_time / 1000 << " ms";
+            if (multi && !session.multi_block_read()) {
+                std::cerr << " (not supported by reader)";
+            }
+            std::cerr << std::endl;
+        }
+        session.reset();
+        c.reset_metrics();
+    }
+
+    if (!read_mifare(session, keys, sectors, !manual, card)) {
+        error("Failed to read card contents");
+        return 1;
+    }
+
+    xpcsc::MifareCachedKeys used;
+    collect_used_keys(keys, card, sectors, used);
+    if (cache_opened && uid.size() != 0 && !same_keys(used, cached)) {
+        try {
+            cache.store(uid, used);
+        } catch (xpcsc::MifareKeyCacheError &e) {
+            error("Keys cache update failed: " << e.what());
         }
-        total_blocks = 64;
     }
 
     char buf[32];
@@ -576,5 +950,16 @@ int main(int argc, char **argv)
         std::cout << std::endl;
     }
 
+    const xpcsc::TransmitMetrics & m = c.metrics();
+    std::cerr << "APDUs sent: " << m.apdus << ", avoided: " << session.apdus_avoided()
+        << ", time: " << m.total_time / 1000 << " ms";
+    if (m.slow_apdus > 0) {
+        std::cerr << ", slow exchanges: " << m.slow_apdus << " (card or reader degraded?)";
+    }
+    std::cerr << std::endl;
+    if (!manual) {
+        std::cerr << "Keys file usage would need about " << keys_file_plan_apdus(keys) << " APDUs" << std::endl;
+    }
+
     return 0;
 }
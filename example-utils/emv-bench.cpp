@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file emv-bench.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * EMV flow benchmark without hardware: virtual EMV card loaded from profile
+ * is tapped repeatedly, every tap finds applications with AIDDiscovery and
+ * reads the first one with EMVReadSession, like example-08 and example-07.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+#define error(msg) do { std::cerr << msg << std::endl; } while (0);
+
+const std::string READER_NAME = "Virtual EMV reader";
+
+void help(const std::string & program)
+{
+    std::cout << "Usage:\n"
+        "    " << program << " [-h] [-n TAPS] [-l LATENCY] [-e] [-w] PROFILE\n"
+        "Simulates taps of virtual EMV card (see virtual-emv-card.txt) and prints\n"
+        "full read latency and APDUs per tap.\n"
+        "\n"
+        "    -n  number of taps, default is 1000\n"
+        "    -l  card latency per APDU, microseconds, default is 0\n"
+        "    -e  learn READ RECORD Le values, so only the first tap gets \"6Cxx\"\n"
+        "    -w  stop reading when PAN and expiration date are found";
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long taps = 1000;
+    unsigned long latency = 0;
+    bool learn_le = false;
+    bool wanted_only = false;
+    std::string profile_file;
+
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h") {
+            help(argv[0]);
+            return 0;
+        } else if (arg == "-n" && i+1 < argc) {
+            taps = strtoul(argv[++i], 0, 10);
+        } else if (arg == "-l" && i+1 < argc) {
+            latency = strtoul(argv[++i], 0, 10);
+        } else if (arg == "-e") {
+            learn_le = true;
+        } else if (arg == "-w") {
+            wanted_only = true;
+        } else if (profile_file.empty()) {
+            profile_file = arg;
+        } else {
+            error("Unknown argument: " << arg);
+            return 1;
+        }
+    }
+
+    if (profile_file.empty()) {
+        help(argv[0]);
+        return 1;
+    }
+
+    xpcsc::VirtualEMVCard card;
+    if (!card.load(profile_file)) {
+        error("Cannot load card profile " << profile_file);
+        return 1;
+    }
+    card.set_latency(latency);
+
+    xpcsc::Connection c;
+    c.attach_virtual_card(READER_NAME, &card);
+
+    xpcsc::AIDDiscovery discovery;
+    for (size_t i=0; i < xpcsc::aid_registry_size(); i++) {
+        const xpcsc::AIDRegistryEntry & app = xpcsc::aid_registry_entry(i);
+        discovery.add_aid(xpcsc::Bytes(app.aid, app.aid_length));
+    }
+
+    xpcsc::LeCache le_cache;
+    std::vector<uint32_t> tags;
+    if (wanted_only) {
+        tags.push_back(0x5A);
+        tags.push_back(0x5F24);
+    }
+
+    unsigned long failed = 0;
+    unsigned long discovery_apdus = 0;
+    unsigned long read_apdus = 0;
+    unsigned long records = 0;
+    double min_ms = 0;
+    double max_ms = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned long i=0; i<taps; i++) {
+        xpcsc::Reader reader = c.wait_for_reader_card(READER_NAME);
+        auto tap_start = std::chrono::steady_clock::now();
+
+        xpcsc::ATRParser parser(c.atr(reader));
+        const std::string & family = parser.classification().family;
+        xpcsc::CardApplications apps;
+        discovery.discover(c, reader, family, apps);
+        discovery_apdus += discovery.last_apdus();
+
+        c.reset_metrics();
+        xpcsc::EMVReadSession session(c, reader);
+        if (learn_le) {
+            session.set_le_cache(&le_cache, family);
+        }
+        if (apps.size() == 0 || !session.read(apps.front().aid, tags)) {
+            failed++;
+        }
+        read_apdus += c.metrics().apdus;
+        records += session.records_read();
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tap_start).count();
+        if (i == 0 || ms < min_ms) {
+            min_ms = ms;
+        }
+        if (ms > max_ms) {
+            max_ms = ms;
+        }
+
+        c.wait_for_card_remove(READER_NAME);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Profile: " << profile_file << ", latency: " << latency << " us" << std::endl;
+    std::cout << "Taps: " << taps << " (failed: " << failed << ") in " << seconds << " s";
+    if (seconds > 0) {
+        std::cout << ", " << static_cast<unsigned long>(taps / seconds) << " taps/s";
+    }
+    std::cout << std::endl;
+    if (taps > 0) {
+        std::cout << "Full read: average " << seconds * 1000 / taps << " ms, min " << min_ms
+            << " ms, max " << max_ms << " ms" << std::endl;
+        std::cout << "APDUs per tap: " << double(discovery_apdus + read_apdus) / taps
+            << " (discovery: " << double(discovery_apdus) / taps
+            << ", read: " << double(read_apdus) / taps
+            << "), records per tap: " << double(records) / taps << std::endl;
+    }
+
+    return failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,593 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file emv-transcript.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Offline analysis of recorded EMV sessions: reconstructs SELECT, GET
+ * PROCESSING OPTIONS and READ RECORD flow of every session from
+ * command/response pairs and prints one row per session with the tags
+ * found.
+ *
+ * Transcript format, one APDU per line, hex:
+ *
+ *     SESSION id
+ *     > 00 A4 04 00 07 A0 00 00 00 03 10 10 00
+ *     < 6F 1A ... 90 00
+ *
+ * Input is split between threads at session boundaries, rows are printed
+ * in input order.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#define error(msg) do { std::cerr << msg << std::endl; } while (0);
+
+const xpcsc::Bytes PSE_NAME = {0x31, 0x50, 0x41, 0x59, 0x2E, 0x53, 0x59, 0x53, 0x2E, 0x44, 0x44, 0x46, 0x30, 0x31};
+const xpcsc::Bytes PPSE_NAME = {0x32, 0x50, 0x41, 0x59, 0x2E, 0x53, 0x59, 0x53, 0x2E, 0x44, 0x44, 0x46, 0x30, 0x31};
+
+const uint32_t TAG_LABEL = 0x50;
+const uint32_t TAG_AIP = 0x82;
+const uint32_t TAG_AFL = 0x94;
+const uint32_t TAG_GPO_FORMAT_1 = 0x80;
+
+struct Exchange {
+    xpcsc::Bytes command;
+    xpcsc::Bytes response;
+};
+
+struct Session {
+    std::string id;
+    std::vector<Exchange> exchanges;
+    bool broken;
+};
+
+struct Analysis {
+    xpcsc::Bytes aid;
+    bool gpo;
+    xpcsc::Bytes afl;
+    // AFL records as (SFI << 8) | record
+    std::set<uint16_t> records_read;
+    // primitive data objects, first occurrence only
+    std::vector<std::pair<uint32_t, xpcsc::Bytes> > tags;
+    bool broken;
+};
+
+struct ChunkResult {
+    std::string rows;
+    unsigned long sessions;
+    unsigned long complete;
+    unsigned long broken;
+};
+
+void help(const std::string & program)
+{
+    std::cout << "Usage:\n"
+        "    " << program << " [-h] [-j THREADS] [-u] [-t SESSIONS_PER_SECOND] [FILE ...]\n"
+        "Reads recorded EMV sessions from FILEs or standard input.\n"
+        "\n"
+        "    -j  number of threads, default is number of CPU cores\n"
+        "    -u  print card numbers and track data unmasked\n"
+        "    -t  throughput target, exit code is 2 if processing was slower";
+    std::cout << std::endl;
+}
+
+static uint32_t tag_to_long(const xpcsc::Bytes & tag)
+{
+    uint32_t res = 0;
+    for (auto i=tag.begin(); i!=tag.end(); i++) {
+        res = (res << 8) | *i;
+    }
+    return res;
+}
+
+static const xpcsc::Bytes * find_tag(const Analysis & a, uint32_t tag)
+{
+    for (auto i=a.tags.begin(); i!=a.tags.end(); i++) {
+        if (i->first == tag) {
+            return &i->second;
+        }
+    }
+    return 0;
+}
+
+static void collect_tags(const xpcsc::BerTlv & tlv, Analysis & a)
+{
+    const xpcsc::BerTlvList & children = tlv.get_children();
+    for (auto i=children.begin(); i!=children.end(); i++) {
+        if (!(*i)->is_raw()) {
+            collect_tags(**i, a);
+            continue;
+        }
+        uint32_t tag = tag_to_long((*i)->get_tag());
+        if (find_tag(a, tag) == 0) {
+            a.tags.push_back(std::make_pair(tag, (*i)->get_data()));
+        }
+    }
+}
+
+// parses response data with library TLV parser, returns top object or 0
+static xpcsc::PBerTlv parse_data(const xpcsc::Bytes & data, Analysis & a)
+{
+    try {
+        return xpcsc::BerTlv::parse(data);
+    } catch (std::exception &e) {
+        a.broken = true;
+        return 0;
+    }
+}
+
+static void process_exchange(const xpcsc::Bytes & command, const xpcsc::Bytes & response, Analysis & a)
+{
+    if (command.size() < 4 || response.size() < 2) {
+        a.broken = true;
+        return;
+    }
+    uint16_t sw = (response[response.size()-2] << 8) | response[response.size()-1];
+    if (sw != 0x9000) {
+        return;
+    }
+    xpcsc::Bytes data = response.substr(0, response.size()-2);
+    xpcsc::Byte ins = command[1];
+
+    if (ins == 0xA4 && command[2] == 0x04) {
+        xpcsc::Bytes name;
+        if (command.size() > 5) {
+            name = command.substr(5, command[4]);
+        }
+        if (name == PSE_NAME || name == PPSE_NAME) {
+            // directory, applications are selected afterwards
+            return;
+        }
+        // the last selected application is the one analyzed
+        a.aid = name;
+        a.gpo = false;
+        a.afl.clear();
+        a.records_read.clear();
+        a.tags.clear();
+
+        std::unique_ptr<xpcsc::BerTlv> tlv(parse_data(data, a));
+        if (tlv) {
+            collect_tags(*tlv, a);
+        }
+        return;
+    }
+
+    if (a.aid.empty()) {
+        return;
+    }
+
+    if (ins == 0xA8 && command[0] == 0x80) {
+        a.gpo = true;
+        std::unique_ptr<xpcsc::BerTlv> tlv(parse_data(data, a));
+        if (!tlv || tlv->get_children().size() == 0) {
+            return;
+        }
+        const xpcsc::BerTlvRef & top = tlv->get_children().at(0);
+        if (tag_to_long(top->get_tag()) == TAG_GPO_FORMAT_1) {
+            // primitive data, first 2 bytes AIP, the rest is AFL
+            const xpcsc::Bytes & d = top->get_data();
+            if (d.size() >= 2 && find_tag(a, TAG_AIP) == 0) {
+                a.tags.push_back(std::make_pair(TAG_AIP, d.substr(0, 2)));
+                a.tags.push_back(std::make_pair(TAG_AFL, d.substr(2)));
+            }
+        } else {
+            collect_tags(*tlv, a);
+        }
+        const xpcsc::Bytes * afl = find_tag(a, TAG_AFL);
+        if (afl) {
+            a.afl = *afl;
+        }
+        return;
+    }
+
+    if (ins == 0xB2) {
+        a.records_read.insert(((command[3] >> 3) << 8) | command[2]);
+        std::unique_ptr<xpcsc::BerTlv> tlv(parse_data(data, a));
+        if (tlv) {
+            collect_tags(*tlv, a);
+        }
+    }
+}
+
+static void analyze(const Session & session, Analysis & a)
+{
+    a.gpo = false;
+    a.broken = session.broken;
+
+    // command waiting for GET RESPONSE (T=0 "61xx" answers) and data of its
+    // responses so far, the command is processed once the chain ends
+    const xpcsc::Bytes * pending = 0;
+    xpcsc::Bytes chained;
+
+    for (auto i=session.exchanges.begin(); i!=session.exchanges.end(); i++) {
+        const xpcsc::Bytes & command = i->command;
+        const xpcsc::Bytes & response = i->response;
+
+        if (pending == 0 || command.size() < 2 || command[1] != 0xC0) {
+            pending = &command;
+            chained.clear();
+        }
+        if (response.size() >= 2) {
+            chained.append(response, 0, response.size()-2);
+        }
+
+        if (response.size() >= 2 && response[response.size()-2] == 0x61) {
+            continue;
+        }
+        if (response.size() >= 2) {
+            chained.append(response, response.size()-2, 2);
+            process_exchange(*pending, chained, a);
+        } else {
+            process_exchange(*pending, response, a);
+        }
+        pending = 0;
+    }
+}
+
+// AFL records that were not read
+static size_t records_missing(const Analysis & a, size_t & expected)
+{
+    size_t missing = 0;
+    expected = 0;
+    for (size_t i=0; i+4 <= a.afl.size(); i+=4) {
+        xpcsc::Byte sfi = a.afl[i] >> 3;
+        for (size_t record=a.afl[i+1]; record<=a.afl[i+2] && record != 0; record++) {
+            expected++;
+            if (a.records_read.count((sfi << 8) | record) == 0) {
+                missing++;
+            }
+        }
+    }
+    return missing;
+}
+
+static bool is_sensitive(uint32_t tag)
+{
+    // PAN, track 1, track 2 equivalent and track 2 data
+    return tag == 0x5A || tag == 0x56 || tag == 0x57 || tag == 0x9F6B;
+}
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static void append_hex(std::string & s, const xpcsc::Byte * b, size_t size)
+{
+    for (size_t i=0; i<size; i++) {
+        s.push_back(HEX_DIGITS[b[i] >> 4]);
+        s.push_back(HEX_DIGITS[b[i] & 0x0F]);
+    }
+}
+
+static void append_masked(std::string & s, const xpcsc::Bytes & b)
+{
+    size_t start = s.size();
+    append_hex(s, b.data(), b.size());
+    // keep issuer identification number and the last four digits
+    for (size_t i=start+6; i+4 < s.size(); i++) {
+        s[i] = '*';
+    }
+}
+
+// rows are built with plain appends, this is the hot path for large inputs
+static void format_row(const Session & session, const Analysis & a, bool unmasked, std::string & row, bool & complete)
+{
+    size_t expected;
+    size_t missing = records_missing(a, expected);
+
+    const char * result;
+    complete = false;
+    if (a.aid.empty()) {
+        result = "no-application";
+    } else if (!a.gpo) {
+        result = "no-gpo";
+    } else if (expected == 0 || missing > 0) {
+        // AFL without records means GET PROCESSING OPTIONS response wasn't understood
+        result = "incomplete";
+    } else {
+        result = "ok";
+        complete = true;
+    }
+
+    row.append(session.id);
+    row.push_back('\t');
+    if (a.aid.empty()) {
+        row.push_back('-');
+    } else {
+        append_hex(row, a.aid.data(), a.aid.size());
+    }
+    row.push_back('\t');
+
+    const xpcsc::Bytes * label = find_tag(a, TAG_LABEL);
+    if (label && label->size() != 0) {
+        row.append(label->begin(), label->end());
+    } else {
+        row.push_back('-');
+    }
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "\t%s%s\t%zu\t%zu/%zu\t", result, a.broken ? ",broken" : "",
+        session.exchanges.size(), expected - missing, expected);
+    row.append(buf);
+
+    for (auto i=a.tags.begin(); i!=a.tags.end(); i++) {
+        if (i != a.tags.begin()) {
+            row.push_back(' ');
+        }
+        snprintf(buf, sizeof(buf), "%X=", i->first);
+        row.append(buf);
+        if (!unmasked && is_sensitive(i->first)) {
+            append_masked(row, i->second);
+        } else {
+            append_hex(row, i->second.data(), i->second.size());
+        }
+    }
+    row.push_back('\n');
+}
+
+static inline const char * skip_spaces(const char * s, const char * end)
+{
+    while (s < end && (*s == ' ' || *s == '\t')) {
+        s++;
+    }
+    return s;
+}
+
+static bool is_session_line(const char * s, const char * end)
+{
+    return end - s >= 7 && strncmp(s, "SESSION", 7) == 0;
+}
+
+static void finish_session(Session & session, Analysis & a, bool unmasked, ChunkResult * result)
+{
+    if (session.exchanges.size() == 0 && session.id.empty()) {
+        return;
+    }
+    if (session.id.empty()) {
+        session.id = "-";
+    }
+
+    a = Analysis();
+    analyze(session, a);
+
+    bool complete;
+    format_row(session, a, unmasked, result->rows, complete);
+    result->sessions++;
+    if (complete) {
+        result->complete++;
+    }
+    if (a.broken) {
+        result->broken++;
+    }
+
+    session.id.clear();
+    session.exchanges.clear();
+    session.broken = false;
+}
+
+static void process_chunk(const char * begin, const char * end, bool unmasked, ChunkResult * result)
+{
+    result->sessions = 0;
+    result->complete = 0;
+    result->broken = 0;
+
+    Session session;
+    session.broken = false;
+    Analysis a;
+
+    while (begin < end) {
+        const char * eol = static_cast<const char *>(memchr(begin, '\n', end - begin));
+        if (eol == 0) {
+            eol = end;
+        }
+        const char * line_end = eol;
+        while (line_end > begin && (line_end[-1] == '\r' || line_end[-1] == ' ' || line_end[-1] == '\t')) {
+            line_end--;
+        }
+        const char * s = skip_spaces(begin, line_end);
+        begin = eol + 1;
+
+        if (s == line_end || *s == '#') {
+            continue;
+        }
+
+        if (is_session_line(s, line_end)) {
+            finish_session(session, a, unmasked, result);
+            s = skip_spaces(s + 7, line_end);
+            session.id.assign(s, line_end);
+            continue;
+        }
+
+        if (*s != '>' && *s != '<') {
+            session.broken = true;
+            continue;
+        }
+
+        xpcsc::Bytes apdu;
+        try {
+            apdu = xpcsc::parse_apdu(std::string(s + 1, line_end));
+        } catch (xpcsc::APDUParseError &e) {
+            session.broken = true;
+            continue;
+        }
+
+        if (*s == '>') {
+            Exchange x;
+            x.command = apdu;
+            session.exchanges.push_back(x);
+        } else if (session.exchanges.size() != 0 && session.exchanges.back().response.empty()) {
+            session.exchanges.back().response = apdu;
+        } else {
+            // response without command
+            session.broken = true;
+        }
+    }
+    finish_session(session, a, unmasked, result);
+}
+
+static bool read_input(std::istream & in, std::string & buffer)
+{
+    std::stringstream ss;
+    ss << in.rdbuf();
+    buffer.append(ss.str());
+    buffer.push_back('\n');
+    return !in.bad();
+}
+
+// start of the first "SESSION" line at or after "s" (which is start of line)
+static const char * next_session(const char * s, const char * end)
+{
+    while (s < end) {
+        if (is_session_line(skip_spaces(s, end), end)) {
+            return s;
+        }
+        s = static_cast<const char *>(memchr(s, '\n', end - s));
+        if (s == 0) {
+            return end;
+        }
+        s++;
+    }
+    return end;
+}
+
+int main(int argc, char **argv)
+{
+    xpcsc::Strings files;
+    unsigned int threads_number = std::thread::hardware_concurrency();
+    bool unmasked = false;
+    double target = 0;
+
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h") {
+            help(argv[0]);
+            return 0;
+        } else if (arg == "-j" && i+1 < argc) {
+            threads_number = atoi(argv[++i]);
+        } else if (arg == "-u") {
+            unmasked = true;
+        } else if (arg == "-t" && i+1 < argc) {
+            target = atof(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (threads_number == 0) {
+        threads_number = 1;
+    }
+
+    // STAGE 1
+    // read whole input
+    std::string buffer;
+
+    if (files.size() == 0) {
+        read_input(std::cin, buffer);
+    }
+    for (auto i=files.begin(); i!=files.end(); i++) {
+        std::ifstream file(*i, std::ios::binary);
+        if (file.fail() || !read_input(file, buffer)) {
+            error("Cannot read file " << *i);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // STAGE 2
+    // split buffer at session boundaries and analyze sessions in parallel
+    std::vector<ChunkResult> results(threads_number);
+    std::vector<std::thread> threads;
+
+    const char * data = buffer.data();
+    const char * end = data + buffer.size();
+    size_t chunk_size = buffer.size() / threads_number + 1;
+    const char * chunk = data;
+
+    for (unsigned int i=0; i<threads_number && chunk < end; i++) {
+        const char * chunk_end = chunk + chunk_size;
+        if (chunk_end >= end) {
+            chunk_end = end;
+        } else {
+            chunk_end = static_cast<const char *>(memchr(chunk_end, '\n', end - chunk_end));
+            chunk_end = chunk_end ? next_session(chunk_end + 1, end) : end;
+        }
+        threads.push_back(std::thread(process_chunk, chunk, chunk_end, unmasked, &results[i]));
+        chunk = chunk_end;
+    }
+
+    for (auto i=threads.begin(); i!=threads.end(); i++) {
+        i->join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // STAGE 3
+    // rows in input order
+    unsigned long sessions = 0;
+    unsigned long complete = 0;
+    unsigned long broken = 0;
+
+    std::cout << "# session\taid\tlabel\tresult\tapdus\trecords\ttags" << std::endl;
+    for (size_t i=0; i<threads.size(); i++) {
+        std::cout << results[i].rows;
+        sessions += results[i].sessions;
+        complete += results[i].complete;
+        broken += results[i].broken;
+    }
+    std::cout.flush();
+
+    // summary goes to stderr, so rows can be piped
+    double rate = seconds > 0 ? sessions / seconds : 0;
+    std::cerr << "Sessions: " << sessions << " (complete: " << complete
+        << ", with broken data: " << broken << ")" << std::endl;
+    std::cerr << "Processed in " << seconds << " s using " << threads.size() << " threads";
+    if (seconds > 0) {
+        std::cerr << ", " << static_cast<unsigned long>(rate) << " sessions/s";
+    }
+    std::cerr << std::endl;
+
+    if (target > 0 && seconds > 0 && rate < target) {
+        error("Throughput target missed: " << static_cast<unsigned long>(rate) << " < "
+            << static_cast<unsigned long>(target) << " sessions/s");
+        return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file fs-bench.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Large EF read benchmark without hardware: virtual ISO 7816-4 card is made
+ * from directory tree, transparent EF is selected by path and read completely
+ * with READ BINARY, contents are compared to the file on disk.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/stat.h>
+#include <dirent.h>
+
+#define error(msg) do { std::cerr << msg << std::endl; } while (0);
+
+const std::string READER_NAME = "Virtual file system reader";
+
+// READ BINARY with offset in P1P2 addresses only 15 bits, larger offsets use odd INS
+const size_t MAX_EVEN_OFFSET = 0x7FFF;
+
+void help(const std::string & program)
+{
+    std::cout << "Usage:\n"
+        "    " << program << " [-h] [-n ROUNDS] [-l LATENCY] [-t PROTOCOL] [-x] [-c CHUNK] DIRECTORY PATH\n"
+        "Makes virtual card from DIRECTORY (names of files and subdirectories start\n"
+        "with FID), selects transparent EF by PATH (like \"DF01/0001\") and reads it\n"
+        "completely, prints throughput and APDUs per read.\n"
+        "\n"
+        "    -n  number of full reads, default is 10\n"
+        "    -l  card latency per APDU, microseconds, default is 0\n"
+        "    -t  card protocol, 0 or 1, default is 0\n"
+        "    -x  use extended length READ BINARY (T=1 only)\n"
+        "    -c  bytes per READ BINARY, default is 256 or 65536 with -x";
+    std::cout << std::endl;
+}
+
+// hex FIDs separated with "/", leading MF is optional
+bool parse_path(const std::string & path, std::vector<uint16_t> & fids)
+{
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        std::string part = path.substr(start, end - start);
+        char * part_end;
+        unsigned long fid = strtoul(part.c_str(), &part_end, 16);
+        if (part.size() != 4 || *part_end != 0) {
+            return false;
+        }
+        if (!(fids.empty() && fid == 0x3F00)) {
+            fids.push_back(fid);
+        }
+        start = end + 1;
+    }
+    return !fids.empty();
+}
+
+// file in card directory with given FID
+std::string find_fid(const std::string & directory, uint16_t fid)
+{
+    DIR * dir = opendir(directory.c_str());
+    if (dir == 0) {
+        return "";
+    }
+    std::string result;
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != 0) {
+        std::string name = entry->d_name;
+        char * name_end;
+        if (name.size() >= 4 && (name.size() == 4 || !isxdigit(name[4]))
+            && strtoul(name.substr(0, 4).c_str(), &name_end, 16) == fid && *name_end == 0)
+        {
+            result = directory + "/" + name;
+            break;
+        }
+    }
+    closedir(dir);
+    return result;
+}
+
+// appends length field of command or Le, short or extended
+void append_length(xpcsc::Bytes & command, size_t length, bool extended)
+{
+    if (extended) {
+        command.push_back((length >> 8) & 0xFF);
+        command.push_back(length & 0xFF);
+    } else {
+        command.push_back(length & 0xFF);
+    }
+}
+
+bool read_ef(xpcsc::Connection & c, const xpcsc::Reader & reader, size_t size, size_t chunk,
+    bool extended, xpcsc::Bytes & contents)
+{
+    contents.clear();
+    contents.reserve(size);
+    xpcsc::Bytes command;
+    xpcsc::Bytes response;
+
+    while (contents.size() < size) {
+        size_t offset = contents.size();
+        command.assign({0x00, 0xB0, static_cast<xpcsc::Byte>(offset >> 8), static_cast<xpcsc::Byte>(offset & 0xFF)});
+
+        if (offset <= MAX_EVEN_OFFSET) {
+            size_t le = std::min(chunk, size - offset);
+            if (extended) {
+                command.push_back(0x00);
+            }
+            append_length(command, le, extended);
+            c.transmit(reader, command, &response);
+            uint16_t sw = c.response_status(response);
+            if (sw != 0x9000 && sw != 0x6282) {
+                error("READ BINARY at " << offset << " failed: " << c.response_status_str(response));
+                return false;
+            }
+            contents.append(response, 0, response.size() - 2);
+        } else {
+            // offset data object, data comes back in discretionary data object
+            xpcsc::Bytes data({0x54, 0x04,
+                static_cast<xpcsc::Byte>(offset >> 24), static_cast<xpcsc::Byte>((offset >> 16) & 0xFF),
+                static_cast<xpcsc::Byte>((offset >> 8) & 0xFF), static_cast<xpcsc::Byte>(offset & 0xFF)});
+            command[1] = 0xB1;
+            command[2] = 0;
+            command[3] = 0;
+            if (extended) {
+                command.push_back(0x00);
+            }
+            append_length(command, data.size(), extended);
+            command.append(data);
+            append_length(command, std::min(chunk, size - offset + 4), extended);
+            c.transmit(reader, command, &response);
+            uint16_t sw = c.response_status(response);
+            if (sw != 0x9000 && sw != 0x6282) {
+                error("READ BINARY at " << offset << " failed: " << c.response_status_str(response));
+                return false;
+            }
+            response.erase(response.size() - 2);
+            try {
+                std::unique_ptr<xpcsc::BerTlv> tlv(xpcsc::BerTlv::parse(response));
+                const xpcsc::BerTlvRef & data_object = tlv->get_children().at(0);
+                if (data_object->get_tag() != xpcsc::Bytes({0x53}) || data_object->get_data().size() == 0) {
+                    error("Unexpected READ BINARY data at " << offset);
+                    return false;
+                }
+                contents.append(data_object->get_data());
+            } catch (std::exception & e) {
+                error("Broken READ BINARY data at " << offset);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long rounds = 10;
+    unsigned long latency = 0;
+    int protocol = 0;
+    bool extended = false;
+    size_t chunk = 0;
+    std::string directory;
+    std::string path;
+
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h") {
+            help(argv[0]);
+            return 0;
+        } else if (arg == "-n" && i+1 < argc) {
+            rounds = strtoul(argv[++i], 0, 10);
+        } else if (arg == "-l" && i+1 < argc) {
+            latency = strtoul(argv[++i], 0, 10);
+        } else if (arg == "-t" && i+1 < argc) {
+            protocol = atoi(argv[++i]);
+        } else if (arg == "-x") {
+            extended = true;
+        } else if (arg == "-c" && i+1 < argc) {
+            chunk = strtoul(argv[++i], 0, 10);
+        } else if (directory.empty()) {
+            directory = arg;
+        } else if (path.empty()) {
+            path = arg;
+        } else {
+            error("Unknown argument: " << arg);
+            return 1;
+        }
+    }
+
+    if (directory.empty() || path.empty()) {
+        help(argv[0]);
+        return 1;
+    }
+
+    std::vector<uint16_t> fids;
+    if (!parse_path(path, fids)) {
+        error("Wrong path: " << path);
+        return 1;
+    }
+    if (extended && protocol != 1) {
+        error("Extended length requires T=1");
+        return 1;
+    }
+    size_t max_chunk = extended ? 0x10000 : 0x100;
+    if (chunk == 0) {
+        chunk = max_chunk;
+    }
+    if (chunk > max_chunk) {
+        error("Chunk size is too big, max is " << max_chunk);
+        return 1;
+    }
+
+    // reference contents
+    std::string file_name = directory;
+    for (auto i = fids.begin(); i != fids.end() && !file_name.empty(); i++) {
+        file_name = find_fid(file_name, *i);
+    }
+    struct stat st;
+    if (file_name.empty() || stat(file_name.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        error("Cannot find " << path << " in " << directory);
+        return 1;
+    }
+    std::ifstream f(file_name, std::ios::binary);
+    std::string expected((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (!f && !f.eof()) {
+        error("Cannot read " << file_name);
+        return 1;
+    }
+
+    xpcsc::VirtualFileSystemCard card;
+    if (!card.load(directory)) {
+        error("Cannot load card directory " << directory);
+        return 1;
+    }
+    card.set_protocol(protocol);
+    card.set_extended_length(extended);
+    card.set_latency(latency);
+
+    xpcsc::Connection c;
+    c.attach_virtual_card(READER_NAME, &card);
+    xpcsc::Reader reader = c.wait_for_reader_card(READER_NAME);
+
+    // SELECT by path from MF, P2=00 returns FCP with file size
+    xpcsc::Bytes select({0x00, 0xA4, 0x08, 0x00, static_cast<xpcsc::Byte>(fids.size() * 2)});
+    for (auto i = fids.begin(); i != fids.end(); i++) {
+        select.push_back(*i >> 8);
+        select.push_back(*i & 0xFF);
+    }
+    select.push_back(0x00);
+
+    unsigned long failed = 0;
+    unsigned long long bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    c.reset_metrics();
+
+    for (unsigned long i=0; i<rounds; i++) {
+        xpcsc::Bytes response;
+        c.transmit(reader, select, &response);
+        if (c.response_status(response) != 0x9000) {
+            error("Cannot select " << path << ": " << c.response_status_str(response));
+            return 1;
+        }
+
+        size_t size = 0;
+        try {
+            std::unique_ptr<xpcsc::BerTlv> tlv(xpcsc::BerTlv::parse(response.substr(0, response.size() - 2)));
+            const xpcsc::BerTlvRef fcp = tlv->find_by_tag(xpcsc::Bytes({0x62}));
+            const xpcsc::BerTlvRef file_size = fcp ? fcp->find_by_tag(xpcsc::Bytes({0x80})) : fcp;
+            if (file_size) {
+                const xpcsc::Bytes & d = file_size->get_data();
+                for (size_t k = 0; k < d.size(); k++) {
+                    size = (size << 8) | d[k];
+                }
+            }
+        } catch (xpcsc::BERTLVParseError & e) {
+            error("Broken FCP: " << xpcsc::format(response));
+            return 1;
+        }
+
+        xpcsc::Bytes contents;
+        if (!read_ef(c, reader, size, chunk, extended, contents)
+            || contents.size() != expected.size()
+            || memcmp(contents.data(), expected.data(), expected.size()) != 0)
+        {
+            failed++;
+        }
+        bytes += contents.size();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const xpcsc::TransmitMetrics & m = c.metrics();
+
+    std::cout << "File: " << path << ", " << expected.size() << " bytes, T=" << protocol
+        << (extended ? ", extended length" : "") << ", chunk: " << chunk
+        << ", latency: " << latency << " us" << std::endl;
+    std::cout << "Reads: " << rounds << " (failed: " << failed << ") in " << seconds << " s";
+    if (seconds > 0) {
+        std::cout << ", " << bytes / seconds / 1048576 << " MB/s";
+    }
+    std::cout << std::endl;
+    if (rounds > 0) {
+        std::cout << "Exchanges per read: " << double(m.apdus) / rounds
+            << " (card APDUs: " << double(card.apdus()) / rounds << ")" << std::endl;
+    }
+
+    c.disconnect_card(reader);
+    return failed == 0 ? 0 : 2;
+}
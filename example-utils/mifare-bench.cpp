@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file mifare-bench.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Protocol logic benchmark without hardware: simulated taps of virtual
+ * MIFARE Classic card going through Connection and MifareClassicSession
+ * exactly like with real reader.
+ */
+
+#include <xpcsc.hpp>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+#define error(msg) do { std::cerr << msg << std::endl; } while (0);
+
+const std::string READER_NAME = "Virtual MIFARE Classic reader";
+
+const xpcsc::Byte TRANSPORT_KEY[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// value block used by "ticket" scenario, like in tcard-use
+const xpcsc::Byte TICKET_BLOCK = 4;
+const int32_t TICKET_PRICE = 1;
+
+void help(const std::string & program)
+{
+    std::cout << "Usage:\n"
+        "    " << program << " [-h] [-n TAPS] [-l LATENCY] [-c SECTORS] [-s] [dump|ticket]\n"
+        "Simulates card taps and prints taps per second.\n"
+        "\n"
+        "    dump    read every sector of card (default)\n"
+        "    ticket  authenticate, read and decrement value block\n"
+        "    -n  number of taps, default is 10000\n"
+        "    -l  card latency per APDU, microseconds, default is 0\n"
+        "    -c  card sectors: 5 (Mini), 16 (1K, default) or 40 (4K)\n"
+        "    -s  card doesn't support multi-block reads";
+    std::cout << std::endl;
+}
+
+static bool dump_tap(xpcsc::MifareClassicSession & session, xpcsc::Byte sectors)
+{
+    xpcsc::Bytes uid;
+    xpcsc::Bytes data;
+
+    if (!session.read_uid(uid)) {
+        return false;
+    }
+    for (xpcsc::Byte sector = 0; sector < sectors; sector++) {
+        xpcsc::Byte first = xpcsc::mifare_sector_first_block(sector);
+        if (!session.authenticate(first, xpcsc::MifareKeyA, TRANSPORT_KEY)) {
+            return false;
+        }
+        // 16-block sectors don't fit into one response, read them by halves
+        xpcsc::Byte blocks = xpcsc::mifare_sector_blocks(sector);
+        xpcsc::Byte count = (blocks == 16) ? 8 : blocks;
+        for (xpcsc::Byte i = 0; i < blocks; i += count) {
+            if (!session.read_blocks(first + i, count, data)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool ticket_tap(xpcsc::MifareClassicSession & session)
+{
+    int32_t balance;
+
+    return session.authenticate(TICKET_BLOCK, xpcsc::MifareKeyA, TRANSPORT_KEY)
+        && session.read_value(TICKET_BLOCK, balance)
+        && balance >= TICKET_PRICE
+        && session.decrement_value(TICKET_BLOCK, TICKET_PRICE);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long taps = 10000;
+    unsigned long latency = 0;
+    int sectors = 16;
+    bool single_block = false;
+    bool ticket = false;
+
+    for (int i=1; i<argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h") {
+            help(argv[0]);
+            return 0;
+        } else if (arg == "-n" && i+1 < argc) {
+            taps = strtoul(argv[++i], 0, 10);
+        } else if (arg == "-l" && i+1 < argc) {
+            latency = strtoul(argv[++i], 0, 10);
+        } else if (arg == "-c" && i+1 < argc) {
+            sectors = atoi(argv[++i]);
+        } else if (arg == "-s") {
+            single_block = true;
+        } else if (arg == "dump") {
+            ticket = false;
+        } else if (arg == "ticket") {
+            ticket = true;
+        } else {
+            error("Unknown argument: " << arg);
+            return 1;
+        }
+    }
+
+    if (sectors != 5 && sectors != 16 && sectors != 40) {
+        error("Card must have 5, 16 or 40 sectors");
+        return 1;
+    }
+
+    xpcsc::VirtualMifareCard card(sectors, xpcsc::parse_apdu("04 A1 B2 C3"));
+    card.set_latency(latency);
+    card.set_multi_block_read(!single_block);
+
+    xpcsc::Connection c;
+    c.attach_virtual_card(READER_NAME, &card);
+
+    // session lives across taps, so key is loaded into reader only once
+    xpcsc::MifareClassicSession session(c, xpcsc::Reader());
+
+    if (ticket) {
+        // enough money for every tap
+        xpcsc::Reader reader = c.wait_for_reader_card(READER_NAME);
+        session.card_changed(reader);
+        if (!session.authenticate(TICKET_BLOCK, xpcsc::MifareKeyA, TRANSPORT_KEY)
+            || !session.store_value(TICKET_BLOCK, taps * TICKET_PRICE))
+        {
+            error("Cannot prepare ticket value block");
+            return 1;
+        }
+        c.wait_for_card_remove(READER_NAME);
+    }
+
+    unsigned long failed = 0;
+    unsigned long apdus = 0;
+    c.reset_metrics();
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned long i=0; i<taps; i++) {
+        xpcsc::Reader reader = c.wait_for_reader_card(READER_NAME);
+        session.card_changed(reader);
+
+        bool ok = ticket ? ticket_tap(session) : dump_tap(session, sectors);
+        if (!ok) {
+            failed++;
+        }
+        apdus += session.apdus_sent();
+
+        c.wait_for_card_remove(READER_NAME);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Scenario: " << (ticket ? "ticket" : "dump") << ", card sectors: " << sectors
+        << ", latency: " << latency << " us" << (single_block ? ", single-block reads" : "") << std::endl;
+    std::cout << "Taps: " << taps << " (failed: " << failed << ") in " << seconds << " s";
+    if (seconds > 0) {
+        std::cout << ", " << static_cast<unsigned long>(taps / seconds) << " taps/s";
+    }
+    std::cout << std::endl;
+    if (taps > 0) {
+        std::cout << "APDUs per tap: " << double(apdus) / taps
+            << ", average tap: " << seconds * 1000 / taps << " ms"
+            << ", card time per tap: " << c.metrics().total_time / 1000.0 / taps << " ms" << std::endl;
+    }
+
+    return failed == 0 ? 0 : 2;
+}
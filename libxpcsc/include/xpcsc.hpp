@@ -32,6 +32,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <iosfwd>
 
 #ifdef __APPLE__
 #include <PCSC/pcsclite.h>
@@ -52,9 +53,15 @@ typedef std::basic_string<Byte> Bytes;
 typedef std::vector<std::string> Strings;
 typedef std::unique_ptr<Bytes> UPBytes;
 
+class VirtualCard;
+
 struct Reader {
     SCARDHANDLE handle;
     SCARD_IO_REQUEST *send_pci;
+    // card emulated in software, PC/SC is not used then
+    VirtualCard * card;
+
+    Reader() : handle(0), send_pci(0), card(0) {}
 };
 
 // ATR features constants
@@ -66,9 +73,29 @@ typedef enum {
     // Mifare cards
     ATR_FEATURE_MIFARE_1K,
     ATR_FEATURE_MIFARE_4K,
-    ATR_FEATURE_INFINEON_SLE_66R35 
+    ATR_FEATURE_INFINEON_SLE_66R35,
+    ATR_FEATURE_MIFARE_MINI
 } ATRFeature;
 
+// converts ATRFeature value into a bit of ATRClassification::features mask
+#define ATR_FEATURE_BIT(f) (1u << (f))
+
+/*
+ * Card classification result computed once per distinct ATR,
+ * see ATRParser::classification()
+ */
+struct ATRClassification {
+    // bit mask of ATR_FEATURE_BIT() values
+    uint32_t features;
+    // card name for known PICC cards (like "MIFARE Classic 1K"), empty otherwise
+    std::string card_name;
+    // first protocol offered by card: 0 for T=0, 1 for T=1 etc
+    int protocol;
+    // statistics key shared by cards of the same kind whatever other ATR bytes are:
+    // "icc-t1", "picc-t1" or "picc-t1-a000000306-0001" (RID and card name of PICC application)
+    std::string family;
+};
+
 /*
  * Incapsulates pcsc-lite error
  */
@@ -87,6 +114,48 @@ public:
 };
 
 
+struct ATRInfo;
+
+/*
+ * Estimated wire time (microseconds) of one APDU exchange using protocol
+ * T=0 or T=1 and parameters decoded from ATR. Sizes include APDU header
+ * and status word.
+ */
+unsigned long estimate_transfer_time(const ATRInfo & info, int protocol,
+    size_t command_size, size_t response_size);
+
+/*
+ * Statistics collected by Connection::transmit()
+ */
+struct TransmitMetrics {
+    // exchanges with card, including GET RESPONSE
+    unsigned long apdus;
+    // time spent in exchanges, microseconds
+    unsigned long long total_time;
+    // estimated wire time of the same exchanges (only when timing is set)
+    unsigned long long expected_time;
+    // exchanges that didn't fit into latency budget
+    unsigned long slow_apdus;
+    // the worst ratio of actual exchange time to its budget
+    double worst_ratio;
+};
+
+/*
+ * Card emulated in software, attached to Connection reader instead of PC/SC
+ * one (see Connection::attach_virtual_card()), so protocol logic could be
+ * tested and benchmarked without hardware.
+ */
+class VirtualCard {
+public:
+    virtual ~VirtualCard() {}
+
+    virtual Bytes atr() = 0;
+    // card is presented to reader (every wait_for_reader_card())
+    virtual void power_up() {}
+    // "response" gets response data followed by status word
+    virtual void transmit(const Byte * command, size_t command_size, Bytes & response) = 0;
+};
+
 class Connection {
     /*
      * Incapsulates pcsc-lite library
@@ -110,6 +179,25 @@ public:
 
     void transmit(const Reader & reader, const Bytes & command, Bytes * response = 0);
 
+    // reader "reader_name" (listed by readers()) holds "card" (not owned): wait_for_reader_card()
+    // returns at once, wait_for_card_remove() too, so card is tapped again; init() isn't required;
+    // card 0 removes virtual reader
+    void attach_virtual_card(const std::string & reader_name, VirtualCard * card);
+
+    // exclusive access to card for a sequence of commands, see CardTransaction
+    void begin_transaction(const Reader & reader);
+    void end_transaction(const Reader & reader, DWORD disposition = SCARD_LEAVE_CARD);
+
+    // enables latency budgets for transmit(): exchange is counted as slow when
+    // it takes longer than slow_factor * estimated wire time + overhead (microseconds)
+    void set_timing(const ATRInfo & info, double slow_factor = 4.0, unsigned long overhead = 5000);
+
+    // latency budget in microseconds or 0 if timing is not set
+    unsigned long latency_budget(const Reader & reader, size_t command_size, size_t response_size) const;
+
+    const TransmitMetrics & metrics() const;
+    void reset_metrics();
+
     static uint16_t response_status(const Bytes & response);
     static std::string response_status_str(const Bytes & response);
     static Bytes response_data(const Bytes & response);
@@ -120,14 +208,96 @@ private:
 
     void handle_pcsc_response_code(long response);
     void release_context();
+    void exchange(const Reader & reader, const Byte * command, size_t command_size,
+        Byte * response, DWORD * response_size);
     // void release_card_handle();
 };
 
+/*
+ * PC/SC transaction lasting while object exists: other applications can't
+ * interleave their commands and reader isn't locked again for every APDU.
+ */
+class CardTransaction {
+public:
+    CardTransaction(Connection & c, const Reader & reader);
+    ~CardTransaction();
+
+private:
+    CardTransaction(const CardTransaction &);
+    CardTransaction & operator=(const CardTransaction &);
+
+    Connection & c;
+    Reader reader;
+};
+
 class ATRParseError : public std::runtime_error {
 public:
     ATRParseError(const char * what);
 };
 
+/*
+ * Compact TLV data object from historical bytes, see ISO 7816-4, section 8.1.1
+ */
+struct ATRCompactTLV {
+    Byte tag;
+    // data position in ATRInfo::historical_bytes
+    Byte offset;
+    Byte length;
+};
+
+/*
+ * Decoded ATR, see ATRParser::info()
+ */
+struct ATRInfo {
+    Byte ts;
+    bool inverse_convention;
+    Byte t0;
+
+    // interface bytes TAi, TBi, TCi, TDi, i=1..7 (element 0 is not used);
+    // bit i in *_present mask is set when corresponding byte is present
+    Byte ta[8];
+    Byte tb[8];
+    Byte tc[8];
+    Byte td[8];
+    uint8_t ta_present;
+    uint8_t tb_present;
+    uint8_t tc_present;
+    uint8_t td_present;
+
+    // bit N is set when protocol T=N is offered
+    uint16_t protocols;
+
+    // clock rate conversion integer, baud rate adjustment integer and
+    // maximum clock frequency (MHz) from TA1 or their default values
+    // if TA1 is absent; RFU values are decoded as -1
+    int fi;
+    int di;
+    float f_max;
+
+    // extra guard time N from TC1
+    Byte extra_guard_time;
+
+    Byte historical_bytes[15];
+    size_t historical_bytes_size;
+
+    // historical bytes in compact TLV format (category indicator 0x80)
+    ATRCompactTLV hb_tlv[15];
+    size_t hb_tlv_count;
+
+    // proximity card, see section 3.1.3.2.3.1 of PC/SC specification part 3
+    bool is_picc;
+    bool has_picc_application;
+    Byte picc_rid[5];
+    // standard byte SS
+    Byte picc_standard;
+    // card name bytes C0 C1
+    uint16_t picc_card_name;
+
+    bool has_tck;
+    Byte tck;
+    bool tck_valid;
+};
+
 class ATRParser
 {
 public:
@@ -135,13 +305,53 @@ public:
     ATRParser(const Bytes & bytes);
     ~ATRParser();
 
+    // human-readable description of info()
     std::string str() const;
 
     void load(const Bytes & bytes);
 
-    bool checkFeature(ATRFeature);
+    const ATRInfo & info() const;
+
+    bool checkFeature(ATRFeature) const;
+
+    const ATRClassification & classification() const;
+
+private:
+    struct Private;
+    Private * p;
+};
+
+class ATRDatabaseError : public std::runtime_error {
+public:
+    ATRDatabaseError(const char * what);
+};
+
+/*
+ * Memory-mapped ATR identification database, see ATRDatabase::compile()
+ * for building one from smartcard_list.txt-like text list.
+ */
+class ATRDatabase
+{
+public:
+    ATRDatabase();
+    ~ATRDatabase();
+
+    void open(const std::string & path);
+
+    // number of ATR patterns
+    size_t size() const;
+
+    // returns description of the most specific matching pattern or 0,
+    // pointer is valid while database object exists
+    const char * match(const Bytes & atr) const;
+
+    // returns number of compiled patterns
+    static size_t compile(std::istream & source, std::ostream & target);
 
 private:
+    ATRDatabase(const ATRDatabase &);
+    ATRDatabase & operator=(const ATRDatabase &);
+
     struct Private;
     Private * p;
 };
@@ -162,9 +372,355 @@ public:
 
 Bytes parse_apdu(const std::string & apdu);
 
+// decode MIFARE Classic sector trailer bytes 7 and 8, (*bits)[i] is C1C2C3 value
+// (C1*4 + C2*2 + C3) of sector block i, block 3 is sector trailer
 bool parse_access_bits(Byte b7, Byte b8, BlocksAccessBits * bits);
 
 
+// MIFARE Classic
+typedef enum {
+    MifareKeyNone = 0,
+    MifareKeyA = 0x60,
+    MifareKeyB = 0x61
+} MifareKeyType;
+
+// sector number of the block
+Byte mifare_block_sector(Byte block);
+
+// first block of the sector
+Byte mifare_sector_first_block(Byte sector);
+
+// number of blocks in the sector: 4, or 16 for 4K card sectors 32-39
+Byte mifare_sector_blocks(Byte sector);
+
+// access bits group (index in BlocksAccessBits) of the block,
+// blocks of 16-block sector are grouped by five, 3 is sector trailer
+Byte mifare_block_access_group(Byte block);
+
+// number of sectors of MIFARE Classic card (Mini: 5, 1K: 16, 4K: 40), 0 for other cards
+Byte mifare_sectors(const ATRClassification & classification);
+
+// keys bitmask
+typedef enum {
+    MifareAccessNone = 0,
+    MifareAccessKeyA = 1,
+    MifareAccessKeyB = 2
+} MifareAccessKeys;
+
+// true if inverted copies of access bits in trailer byte 6 and 7 match bytes 7 and 8
+bool mifare_access_bits_valid(Byte b6, Byte b7, Byte b8);
+
+// keys (MifareAccessKeys bitmask) allowed to read sector block i (block 3 is trailer),
+// key B can't be used at all when trailer makes it readable
+Byte mifare_read_access(const BlocksAccessBits & bits, size_t block);
+
+/*
+ * Keys to read sector blocks with, computed from access conditions. Session is
+ * assumed to be authenticated with "current" key already (it is needed to read
+ * trailer first), so blocks that key can read use it and the other key is
+ * used only for the rest.
+ */
+struct MifareReadPlan {
+    // MifareKeyNone if block can't be read with available keys
+    MifareKeyType block_key[4];
+    // authentications needed besides current one, 0 or 1
+    size_t authentications;
+};
+
+void mifare_plan_read(const BlocksAccessBits & bits, MifareKeyType current,
+    Byte available_keys, MifareReadPlan & plan);
+
+// 16 bytes of value block: value, inverted value, value (LSB first),
+// then address, inverted address, address, inverted address
+Bytes mifare_value_block(int32_t value, Byte address);
+
+/*
+ * MIFARE Classic card access via PC/SC reader pseudo-APDUs (LOAD KEYS,
+ * GENERAL AUTHENTICATE, READ BINARY, UPDATE BINARY).
+ *
+ * Session remembers keys loaded into reader key slots and currently
+ * authenticated sector, so commands that don't change anything are
+ * not sent at all. Keys are distributed over reader volatile key slots
+ * (ACR122U has two of them) and replaced in least recently used order.
+ */
+class MifareClassicSession {
+public:
+    MifareClassicSession(Connection & c, const Reader & reader, Byte key_slots = 2);
+    ~MifareClassicSession();
+
+    // new card is presented: authentication state and counters are reset,
+    // keys already loaded into reader are kept
+    void card_changed(const Reader & reader);
+
+    // forget everything including loaded keys, call this when reader is reconnected
+    void reset();
+
+    // all methods return false if card rejected command
+    bool read_uid(Bytes & uid);
+    bool load_key(const Byte * key, Byte slot = 0);
+    bool authenticate(Byte block, MifareKeyType key_type, const Byte * key);
+    bool read_block(Byte block, Bytes & data);
+    // read "count" blocks of the same sector starting from "block"; single READ BINARY
+    // with Le = 16*count is used if reader supports it (probed on first use),
+    // block by block reading otherwise
+    bool read_blocks(Byte block, Byte count, Bytes & data);
+    bool update_block(Byte block, const Bytes & data);
+
+    // value blocks: signed 32-bit value stored three times with its address,
+    // INCREMENT/DECREMENT/RESTORE are followed by TRANSFER, so card never
+    // keeps half-written value; store_value() formats block as value block
+    bool store_value(Byte block, int32_t value);
+    bool read_value(Byte block, int32_t & value);
+    bool increment_value(Byte block, uint32_t amount);
+    bool decrement_value(Byte block, uint32_t amount);
+    // copy value block "source" to "target" of the same sector
+    bool restore_value(Byte source, Byte target);
+
+    // enable or disable multi-block reads, capability is probed again when enabled
+    void set_multi_block_read(bool enabled);
+    // false if multi-block reads are disabled or reader turned out not to support them
+    bool multi_block_read() const;
+
+    // APDUs sent to current card and APDUs that were not sent because
+    // they wouldn't change reader or card state
+    unsigned long apdus_sent() const;
+    unsigned long apdus_avoided() const;
+
+private:
+    MifareClassicSession(const MifareClassicSession &);
+    MifareClassicSession & operator=(const MifareClassicSession &);
+
+    struct Private;
+    Private * p;
+};
+
+
+class MifareKeyDictionaryError : public std::runtime_error {
+public:
+    MifareKeyDictionaryError(const char * what);
+};
+
+/*
+ * Memory-mapped deduplicated MIFARE Classic keys list, see MifareKeyDictionary::compile()
+ * for building one from text list.
+ */
+class MifareKeyDictionary
+{
+public:
+    MifareKeyDictionary();
+    ~MifareKeyDictionary();
+
+    void open(const std::string & path);
+
+    // true if file starts with compiled dictionary signature
+    static bool is_compiled(const std::string & path);
+
+    size_t size() const;
+
+    // 6 bytes of key i, pointer is valid while dictionary object exists
+    const Byte * key(size_t i) const;
+
+    // text list: one hex key per line or keys file lines "SECTOR:KEY_A:KEY_B:USAGE",
+    // "#" starts comment; keys order is kept, duplicates are dropped;
+    // returns number of compiled keys
+    static size_t compile(std::istream & source, std::ostream & target);
+
+private:
+    MifareKeyDictionary(const MifareKeyDictionary &);
+    MifareKeyDictionary & operator=(const MifareKeyDictionary &);
+
+    struct Private;
+    Private * p;
+};
+
+class MifareKeyCacheError : public std::runtime_error {
+public:
+    MifareKeyCacheError(const char * what);
+};
+
+struct MifareCachedKey {
+    Byte sector;
+    MifareKeyType key_type;
+    Byte key[6];
+};
+
+typedef std::vector<MifareCachedKey> MifareCachedKeys;
+
+/*
+ * Keys that worked for particular cards, found by card UID. Cache file is
+ * append-only log of card records and the latest record of a card wins.
+ * In-memory hash index keeps record offsets only, so memory use is small
+ * even for hundreds of thousands of cards and lookup reads one record.
+ */
+class MifareKeyCache
+{
+public:
+    MifareKeyCache();
+    ~MifareKeyCache();
+
+    // opens or creates cache file, incomplete record at the end
+    // (interrupted write) is dropped
+    void open(const std::string & path);
+
+    // number of cards
+    size_t size() const;
+
+    bool lookup(const Bytes & uid, MifareCachedKeys & keys) const;
+    // appends new card record
+    void store(const Bytes & uid, const MifareCachedKeys & keys);
+
+private:
+    MifareKeyCache(const MifareKeyCache &);
+    MifareKeyCache & operator=(const MifareKeyCache &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * Result of mifare_write_image()
+ */
+struct MifareWriteReport {
+    size_t blocks_written;
+    // blocks equal in current and target image
+    size_t blocks_unchanged;
+    size_t sectors_written;
+    // block that couldn't be written or read back, valid when writing failed
+    Byte failed_block;
+    // true if failure is a mismatch found by reading written sector back
+    bool verify_failed;
+};
+
+/*
+ * Writes only the blocks where "target" card image differs from "current"
+ * (usually the last read one). Images are blocks from block 0 on, blocks
+ * beyond the shorter image and manufacturer block 0 are never written.
+ * Sectors are handled one by one: single authentication with sector key
+ * from "keys" (key B preferred, key A is tried when write is denied),
+ * data blocks, then trailer, then one read of the sector to verify it.
+ * Trailer keys are not readable, so they are taken from "keys" for
+ * comparison and only access bits are verified. Returns false on the
+ * first failure.
+ */
+bool mifare_write_image(MifareClassicSession & session, const Bytes & current,
+    const Bytes & target, const MifareCachedKeys & keys, MifareWriteReport & report);
+
+/*
+ * MIFARE Classic Mini, 1K or 4K card in ACR122-like reader emulated in memory:
+ * LOAD KEYS, GENERAL AUTHENTICATE, READ BINARY (several blocks of a sector
+ * at once too), UPDATE BINARY, GET DATA (UID) and value block commands.
+ * Sector trailer keys and access conditions are enforced like on real card:
+ * failed command drops authentication, unreadable key bytes read as zeroes,
+ * trailer parts that current key can't write are kept.
+ */
+class VirtualMifareCard : public VirtualCard {
+public:
+    // "sectors" is 5, 16 or 40; card is blank: transport keys FF FF FF FF FF FF
+    // and access conditions in every trailer, manufacturer block made of UID (4 bytes)
+    VirtualMifareCard(Byte sectors, const Bytes & uid);
+    ~VirtualMifareCard();
+
+    // card contents from block 0 on, false if image size doesn't match card
+    bool load_image(const Bytes & image);
+    const Bytes & image() const;
+
+    // time each exchange takes, microseconds
+    void set_latency(unsigned long latency);
+    // multi-block READ BINARY support, enabled by default
+    void set_multi_block_read(bool enabled);
+
+    // exchanges since card was created and those answered with error status
+    unsigned long apdus() const;
+    unsigned long failures() const;
+
+    virtual Bytes atr();
+    virtual void power_up();
+    virtual void transmit(const Byte * command, size_t command_size, Bytes & response);
+
+private:
+    VirtualMifareCard(const VirtualMifareCard &);
+    VirtualMifareCard & operator=(const VirtualMifareCard &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * MIFARE tools run without hardware: if environment variable
+ * XPCSC_VIRTUAL_MIFARE names card image file (Mini, 1K or 4K contents from
+ * block 0 on), attach() puts VirtualMifareCard with that image into reader
+ * "Virtual MIFARE Classic reader" of the connection and PC/SC isn't needed.
+ * Missing file means blank 1K card. Image is written back when the object
+ * is destroyed, so tools run one after another see the same card.
+ */
+class VirtualMifareImageFile {
+public:
+    VirtualMifareImageFile();
+    ~VirtualMifareImageFile();
+
+    // false if variable isn't set; throws ConnectionError if file can't be
+    // read or its size doesn't match any card
+    bool attach(Connection & c);
+
+private:
+    VirtualMifareImageFile(const VirtualMifareImageFile &);
+    VirtualMifareImageFile & operator=(const VirtualMifareImageFile &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * MIFARE Classic key search: candidate keys are tried in order of observed
+ * hit rate for the same card family (e.g. ATR) and sector, falling back to
+ * hit rate in the family and over all cards, then to dictionary order.
+ * Hit rates are Laplace-smoothed, so keys that were never tried are not
+ * pushed behind keys that failed once. Statistics are kept in a text file,
+ * one "FAMILY SECTOR KEY HITS TRIES" line per entry.
+ */
+class MifareKeySearch {
+public:
+    // starts with built-in dictionary of well-known keys
+    MifareKeySearch();
+    ~MifareKeySearch();
+
+    // append key to dictionary, duplicates are ignored
+    void add_key(const Byte * key);
+    // keys are read in place, so dictionary must exist while search object is used;
+    // keys repeated in several sources are tried once
+    void add_keys(const MifareKeyDictionary & dictionary);
+    // read compiled dictionary or text one (one hex key per line, "#" comments),
+    // returns number of keys read, throws MifareKeyDictionaryError if compiled one is corrupted
+    size_t load_keys(const std::string & path);
+    // keys in all sources
+    size_t size() const;
+
+    // missing file is not an error, returns false if file is broken or can't be written
+    bool load_stats(const std::string & path);
+    bool save_stats(const std::string & path) const;
+
+    // dictionary keys for the sector, best first; search() walks them without building the list
+    void candidates(const std::string & family, Byte sector, std::vector<Bytes> & keys) const;
+    void record(const std::string & family, Byte sector, const Byte * key, bool hit);
+
+    // try candidates one by one (key B first, then key A) until authentication succeeds
+    // and the first sector block can be read, on success session stays authenticated
+    // to the sector with returned key
+    bool search(MifareClassicSession & session, const std::string & family, Byte sector,
+        MifareKeyType & key_type, Bytes & key);
+
+    // keys tried by last search()
+    size_t last_attempts() const;
+
+private:
+    MifareKeySearch(const MifareKeySearch &);
+    MifareKeySearch & operator=(const MifareKeySearch &);
+
+    struct Private;
+    Private * p;
+};
+
+
 // BER-TLV
 class BERTLVParseError : public std::runtime_error {
 public:
@@ -202,6 +758,315 @@ std::string format(const Bytes &, FormatOptions fo = FormatHex);
 std::string format(const Byte &, FormatOptions fo = FormatHex);
 std::string format(const BerTlv &, FormatOptions fo = FormatHex);
 
+
+/*
+ * Exact Le values of READ RECORD learned from "6Cxx" (wrong length) answers,
+ * so cards of the same family (e.g. ATR) are read without retries. Entries are
+ * keyed by family, AID (or DF name), SFI and record number. Cache file is
+ * text, one "FAMILY AID SFI RECORD LE" line per entry.
+ */
+class LeCache {
+public:
+    LeCache();
+    ~LeCache();
+
+    // missing file is not an error, returns false if file is broken or can't be written
+    bool load(const std::string & path);
+    bool save(const std::string & path) const;
+
+    // learned Le, 0 (any length) if unknown
+    Byte lookup(const std::string & family, const Bytes & aid, Byte sfi, Byte record) const;
+    void store(const std::string & family, const Bytes & aid, Byte sfi, Byte record, Byte le);
+
+    size_t size() const;
+    // true if entries were stored since load()
+    bool modified() const;
+
+private:
+    LeCache(const LeCache &);
+    LeCache & operator=(const LeCache &);
+
+    struct Private;
+    Private * p;
+};
+
+// bytes owned by some other object
+struct BytesView {
+    const Byte * data;
+    size_t size;
+};
+
+/*
+ * EMV application read: SELECT, GET PROCESSING OPTIONS (PDOL data filled
+ * with zeroes), then READ RECORD of AFL records until all wanted tags are
+ * found. Commands are sent within one PC/SC transaction. Responses are
+ * kept in one session buffer, tags are indexed in place, so values are
+ * views into that buffer and no per-tag copies are made.
+ */
+class EMVReadSession {
+public:
+    EMVReadSession(Connection & c, const Reader & reader);
+    ~EMVReadSession();
+
+    // READ RECORD Le values are taken from and learned into cache (not owned)
+    void set_le_cache(LeCache * cache, const std::string & family);
+
+    // "tags" are numbers like 0x5A or 0x5F20, all AFL records are read if list is empty;
+    // returns false if SELECT, GET PROCESSING OPTIONS or READ RECORD failed
+    bool read(const Bytes & aid, const std::vector<uint32_t> & tags);
+
+    // value of the first occurrence of tag in FCI, GPO response or records,
+    // view is valid until next read()
+    bool find(uint32_t tag, BytesView & value) const;
+    // copy of value, empty if tag is missing
+    Bytes value(uint32_t tag) const;
+    // all tags found by last read() in order of appearance
+    const std::vector<uint32_t> & found_tags() const;
+    // SELECT response data of last read(), empty if SELECT failed
+    Bytes fci() const;
+
+    // AFL records read and not read because wanted tags were found already
+    size_t records_read() const;
+    size_t records_skipped() const;
+
+    // status word of failed command, 0 if read() didn't fail on card answer
+    uint16_t last_status() const;
+
+private:
+    EMVReadSession(const EMVReadSession &);
+    EMVReadSession & operator=(const EMVReadSession &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * EMV card emulated from profile file, one statement per line ("#" starts comment):
+ *
+ *     atr HEX                  card ATR
+ *     protocol 0|1             T=0: "61xx" answers with GET RESPONSE, Le must be exact
+ *     file NAME                DF name, hex or quoted ASCII ("1PAY.SYS.DDF01")
+ *     fci HEX                  SELECT response data of the last file
+ *     gpo HEX                  GET PROCESSING OPTIONS response data of the last file
+ *     record SFI NUMBER HEX    READ RECORD response data of the last file
+ *
+ * SELECT by DF name (partial names with "first" and "next occurrence" too),
+ * GET PROCESSING OPTIONS (PDOL data length is checked against FCI tag 9F38)
+ * and READ RECORD are answered; wrong Le gets "6Cxx".
+ */
+class VirtualEMVCard : public VirtualCard {
+public:
+    VirtualEMVCard();
+    ~VirtualEMVCard();
+
+    // false if file can't be read or has errors, card is empty then
+    bool load(const std::string & path);
+    bool load(std::istream & profile);
+
+    // time each exchange takes, microseconds
+    void set_latency(unsigned long latency);
+
+    // exchanges since card was created
+    unsigned long apdus() const;
+
+    virtual Bytes atr();
+    virtual void power_up();
+    virtual void transmit(const Byte * command, size_t command_size, Bytes & response);
+
+private:
+    VirtualEMVCard(const VirtualEMVCard &);
+    VirtualEMVCard & operator=(const VirtualEMVCard &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * ISO 7816-4 card with file system emulated from directory: the directory
+ * is MF (3F00), subdirectories are DFs and regular files are EFs, names
+ * start with 4 hex digits FID (the rest is ignored, e.g. "7F10-app").
+ * Files with ".records" suffix are record EFs with one hex record per line,
+ * others are transparent EFs (memory-mapped, so they could be large).
+ *
+ * Commands: SELECT by FID, path from MF or current DF and parent DF (FCP
+ * template 62 is returned unless P2 is 0C), READ BINARY with offsets
+ * (INS B0, short EF identifier too, and INS B1 with offset data object
+ * 54 for files larger than 32 KB), READ RECORD, GET RESPONSE.
+ * Short EF identifier is the low 5 bits of FID. Protocol T=0 means "61xx"
+ * answers and exact Le ("6Cxx" otherwise), T=1 accepts extended Le when
+ * enabled.
+ */
+class VirtualFileSystemCard : public VirtualCard {
+public:
+    VirtualFileSystemCard();
+    ~VirtualFileSystemCard();
+
+    // false if directory can't be read or names are wrong, card is empty then
+    bool load(const std::string & path);
+
+    // 0 or 1, T=0 by default
+    void set_protocol(int protocol);
+    // extended length Le (up to 65536 bytes) for T=1, disabled by default
+    void set_extended_length(bool enabled);
+    // time each exchange takes, microseconds
+    void set_latency(unsigned long latency);
+
+    // exchanges since card was created
+    unsigned long apdus() const;
+
+    virtual Bytes atr();
+    virtual void power_up();
+    virtual void transmit(const Byte * command, size_t command_size, Bytes & response);
+
+private:
+    VirtualFileSystemCard(const VirtualFileSystemCard &);
+    VirtualFileSystemCard & operator=(const VirtualFileSystemCard &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * Registry of well-known application identifiers, built into the library
+ * as constant trie (see src/aids.txt), so there is no startup cost and
+ * lookups don't allocate.
+ */
+struct AIDRegistryEntry {
+    const Byte * aid;
+    size_t aid_length;
+    const char * description;
+};
+
+// registered AIDs in registry source order
+size_t aid_registry_size();
+const AIDRegistryEntry & aid_registry_entry(size_t index);
+
+// the longest registered AID that is a prefix of "aid" (or equal to it), 0 if none
+const AIDRegistryEntry * aid_registry_lookup(const Byte * aid, size_t length);
+const AIDRegistryEntry * aid_registry_lookup(const Bytes & aid);
+
+/*
+ * Application found on ISO 7816-4 card
+ */
+struct CardApplication {
+    Bytes aid;
+    // application label (tag 50) if card provided it
+    std::string label;
+    // directory entry priority (tag 87 low nibble), 1 is the highest, 0 if not given
+    Byte priority;
+    // SELECT response data, empty if application was listed in directory only
+    Bytes fci;
+
+    CardApplication() : priority(0) {}
+};
+
+typedef std::vector<CardApplication> CardApplications;
+
+typedef enum {
+    AIDDiscoveryNone = 0,
+    AIDDiscoveryPPSE,
+    AIDDiscoveryPSE,
+    AIDDiscoveryFamily,
+    AIDDiscoveryPartialSelect,
+    AIDDiscoveryProbe
+} AIDDiscoveryMethod;
+
+/*
+ * Finding applications on card with as few APDUs as possible:
+ *   1. payment system directory, PPSE, then PSE;
+ *   2. applications found before on cards of the same family (e.g. ATR) are
+ *      selected directly;
+ *   3. partial AID SELECT with "next occurrence" P2 for RIDs of known AIDs,
+ *      RIDs never seen before are tried only until something is found;
+ *   4. known AIDs are probed one by one, until the first one is found.
+ * Step is taken only if previous ones found nothing. RIDs and AIDs are tried
+ * in order of previous hits for the family, then for all cards, then in list
+ * order. Statistics file has one "FAMILY AID HITS" line per entry.
+ */
+class AIDDiscovery {
+public:
+    AIDDiscovery();
+    ~AIDDiscovery();
+
+    // append AID to probe list, duplicates are ignored
+    void add_aid(const Bytes & aid);
+    size_t size() const;
+
+    // try all RIDs in step 3 and all AIDs in step 4, slow
+    void set_exhaustive(bool exhaustive);
+
+    // missing file is not an error, returns false if file is broken or can't be written
+    bool load_stats(const std::string & path);
+    bool save_stats(const std::string & path) const;
+
+    // applications found are recorded as hits
+    AIDDiscoveryMethod discover(Connection & c, const Reader & reader,
+        const std::string & family, CardApplications & apps);
+
+    // step 1 only: PPSE (if "contactless"), then PSE; applications are in
+    // priority order, entries without priority go last, card order is kept
+    // otherwise; no hits are recorded
+    AIDDiscoveryMethod read_directory(Connection & c, const Reader & reader,
+        bool contactless, CardApplications & apps);
+
+    // APDUs sent by last discover() or read_directory(), including GET RESPONSE
+    unsigned long last_apdus() const;
+
+private:
+    AIDDiscovery(const AIDDiscovery &);
+    AIDDiscovery & operator=(const AIDDiscovery &);
+
+    struct Private;
+    Private * p;
+};
+
+/*
+ * Applications (with FCI) of the last cards seen, so re-tapped card doesn't
+ * need directory reads or discovery. Card identity is ATR followed by UID
+ * from GET DATA; contact cards have no UID, so cached entry must be proven by
+ * the first command sent to card: SELECT of cached application (see confirm())
+ * or application read itself, and rejected if card answers differently.
+ * Such proof doesn't tell two cards of the same issuer and product apart,
+ * so hits of identities without UID are counted separately (atr_only()) and
+ * hit_rate() doesn't include them.
+ * The least recently used card is dropped when cache is full.
+ */
+class FCICache {
+public:
+    explicit FCICache(size_t capacity = 16);
+    ~FCICache();
+
+    // ATR length, ATR and UID (PC/SC GET DATA, omitted if card doesn't support it)
+    static Bytes card_identity(Connection & c, const Reader & reader);
+
+    // cached applications or 0, counted as hit or miss; entry becomes the most recent
+    const CardApplications * lookup(const Bytes & identity);
+    // cached entry doesn't match the card: entry is dropped and its hit counted as stale
+    void reject(const Bytes & identity);
+    // lookup() that selects the first cached application and compares FCI, rejects entry if it differs;
+    // application listed in directory only (no FCI) is accepted and gets FCI of this SELECT
+    const CardApplications * confirm(Connection & c, const Reader & reader, const Bytes & identity);
+
+    // empty list isn't stored
+    void store(const Bytes & identity, const CardApplications & apps);
+    size_t size() const;
+
+    unsigned long hits() const;
+    unsigned long misses() const;
+    unsigned long stale() const;
+    // hits not rejected for identities without UID
+    unsigned long atr_only() const;
+    // share of lookups with valid cached entry found by UID
+    double hit_rate() const;
+
+private:
+    FCICache(const FCICache &);
+    FCICache & operator=(const FCICache &);
+
+    struct Private;
+    Private * p;
+};
+
 }
 
 #endif
\ No newline at end of file
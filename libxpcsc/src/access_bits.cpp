@@ -40,27 +40,68 @@ bool parse_access_bits(Byte b7, Byte b8, BlocksAccessBits * bits)
     Byte C2;
     Byte C3;
 
-    C1 = CHECK_BIT(b7, 4);
-    C2 = CHECK_BIT(b8, 0);
-    C3 = CHECK_BIT(b8, 4);
-    (*bits)[3] = CONSTRUCT_VALUE(C1, C2, C3);
-
-    C1 = CHECK_BIT(b7, 5);
-    C2 = CHECK_BIT(b8, 1);
-    C3 = CHECK_BIT(b8, 5);
-    (*bits)[2] = CONSTRUCT_VALUE(C1, C2, C3);
-
-    C1 = CHECK_BIT(b7, 6);
-    C2 = CHECK_BIT(b8, 2);
-    C3 = CHECK_BIT(b8, 6);
-    (*bits)[1] = CONSTRUCT_VALUE(C1, C2, C3);
-
-    C1 = CHECK_BIT(b7, 7);
-    C2 = CHECK_BIT(b8, 3);
-    C3 = CHECK_BIT(b8, 7);
-    (*bits)[0] = CONSTRUCT_VALUE(C1, C2, C3);
+    for (size_t i = 0; i < 4; i++) {
+        C1 = CHECK_BIT(b7, 4 + i);
+        C2 = CHECK_BIT(b8, i);
+        C3 = CHECK_BIT(b8, 4 + i);
+        (*bits)[i] = CONSTRUCT_VALUE(C1, C2, C3);
+    }
 
     return true;
 }
 
+bool mifare_access_bits_valid(Byte b6, Byte b7, Byte b8)
+{
+    // byte 6: ~C2 | ~C1, byte 7: C1 | ~C3, byte 8: C3 | C2
+    Byte C1 = b7 >> 4;
+    Byte C2 = b8 & 0x0F;
+    Byte C3 = b8 >> 4;
+
+    return ((~b6 >> 4) & 0x0F) == C2
+        && (~b6 & 0x0F) == C1
+        && (~b7 & 0x0F) == C3;
+}
+
+// indexed by C1C2C3 value
+static const Byte DATA_READ_ACCESS[8] = {
+    MifareAccessKeyA | MifareAccessKeyB,    // 000
+    MifareAccessKeyA | MifareAccessKeyB,    // 001
+    MifareAccessKeyA | MifareAccessKeyB,    // 010
+    MifareAccessKeyB,                       // 011
+    MifareAccessKeyA | MifareAccessKeyB,    // 100
+    MifareAccessKeyB,                       // 101
+    MifareAccessKeyA | MifareAccessKeyB,    // 110
+    MifareAccessNone                        // 111
+};
+
+// access bits read permission
+static const Byte TRAILER_READ_ACCESS[8] = {
+    MifareAccessKeyA,                       // 000
+    MifareAccessKeyA,                       // 001
+    MifareAccessKeyA,                       // 010
+    MifareAccessKeyA | MifareAccessKeyB,    // 011
+    MifareAccessKeyA | MifareAccessKeyB,    // 100
+    MifareAccessKeyA | MifareAccessKeyB,    // 101
+    MifareAccessKeyA | MifareAccessKeyB,    // 110
+    MifareAccessKeyA | MifareAccessKeyB     // 111
+};
+
+Byte mifare_read_access(const BlocksAccessBits & bits, size_t block)
+{
+    Byte trailer = bits[3] & 0x07;
+
+    if (block >= 3) {
+        return TRAILER_READ_ACCESS[trailer];
+    }
+
+    Byte keys = DATA_READ_ACCESS[bits[block] & 0x07];
+
+    // key B is readable so it is just data
+    if (trailer == 0 || trailer == 1 || trailer == 2) {
+        keys &= ~MifareAccessKeyB;
+    }
+
+    return keys;
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file aiddiscovery.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Finding card applications: payment system directory, partial AID selection
+ * (ISO 7816-4 SELECT with P2 "next occurrence"), known AIDs probing.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+// directory names, "2PAY.SYS.DDF01" is the contactless one
+static const Bytes PPSE_NAME = {'2', 'P', 'A', 'Y', '.', 'S', 'Y', 'S', '.', 'D', 'D', 'F', '0', '1'};
+static const Bytes PSE_NAME = {'1', 'P', 'A', 'Y', '.', 'S', 'Y', 'S', '.', 'D', 'D', 'F', '0', '1'};
+
+// SELECT by DF name, Lc, name and Le are appended
+static const Byte CMD_SELECT[] = {0x00, 0xA4, 0x04, 0x00};
+static const Byte CMD_READ_RECORD[] = {0x00, 0xB2, 0x00, 0x00, 0x00};
+
+static const Byte SELECT_FIRST = 0x00;
+static const Byte SELECT_NEXT = 0x02;
+
+static const Bytes TAG_FCI = {0x6F};
+static const Bytes TAG_FCI_DF_NAME = {0x84};
+static const Bytes TAG_FCI_PROPRIETARY = {0xA5};
+static const Bytes TAG_FCI_SFI = {0x88};
+static const Bytes TAG_FCI_ISSUER_DISCRETIONARY = {0xBF, 0x0C};
+static const Bytes TAG_RECORD = {0x70};
+static const Bytes TAG_DIRECTORY_ENTRY = {0x61};
+static const Bytes TAG_AID = {0x4F};
+static const Bytes TAG_LABEL = {0x50};
+static const Bytes TAG_PRIORITY = {0x87};
+
+static const size_t RID_SIZE = 5;
+// limits for cards that never stop returning applications or records
+static const size_t MAX_OCCURRENCES = 16;
+static const size_t MAX_RECORDS = 16;
+
+typedef std::unordered_map<std::string, unsigned long> AIDCounters;
+
+static std::string aid_key(const Bytes & aid)
+{
+    return std::string(aid.begin(), aid.end());
+}
+
+static std::string aid_hex(const Bytes & aid)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    std::string s;
+    for (auto i = aid.begin(); i != aid.end(); i++) {
+        s += digits[*i >> 4];
+        s += digits[*i & 0x0F];
+    }
+    return s;
+}
+
+// registered RIDs start with "A" (international) or "D" (national) nibble
+static bool has_rid(const Bytes & aid)
+{
+    return aid.size() >= RID_SIZE && ((aid[0] & 0xF0) == 0xA0 || (aid[0] & 0xF0) == 0xD0);
+}
+
+static bool find_app(const CardApplications & apps, const Bytes & aid)
+{
+    for (auto i = apps.begin(); i != apps.end(); i++) {
+        if (i->aid == aid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// directory entry, template 61 of PPSE FCI or PSE record
+static void add_entry(const BerTlv & entry, CardApplications & apps)
+{
+    const BerTlvRef aid = entry.find_by_tag(TAG_AID);
+    if (!aid || find_app(apps, aid->get_data())) {
+        return;
+    }
+
+    CardApplication app;
+    app.aid = aid->get_data();
+    const BerTlvRef label = entry.find_by_tag(TAG_LABEL);
+    if (label) {
+        app.label.assign(label->get_data().begin(), label->get_data().end());
+    }
+    const BerTlvRef priority = entry.find_by_tag(TAG_PRIORITY);
+    if (priority && priority->get_data().size() == 1) {
+        app.priority = priority->get_data()[0] & 0x0F;
+    }
+    apps.push_back(app);
+}
+
+// 1 is the highest priority, entries without one go last, card order is kept otherwise
+static void sort_by_priority(CardApplications & apps)
+{
+    auto rank = [](const CardApplication & app) -> unsigned int {
+        return (app.priority == 0) ? 16 : app.priority;
+    };
+    std::stable_sort(apps.begin(), apps.end(), [&](const CardApplication & a, const CardApplication & b) {
+        return rank(a) < rank(b);
+    });
+}
+
+// application from its FCI, "aid" is used if FCI has no DF name
+static bool parse_fci(const Bytes & fci, const Bytes & aid, CardApplication & app)
+{
+    app.aid = aid;
+    app.label.clear();
+    app.fci = fci;
+
+    try {
+        std::unique_ptr<BerTlv> tlv(BerTlv::parse(fci));
+        const BerTlvRef fci_tlv = tlv->find_by_tag(TAG_FCI);
+        if (!fci_tlv) {
+            return !aid.empty();
+        }
+        const BerTlvRef name = fci_tlv->find_by_tag(TAG_FCI_DF_NAME);
+        if (name) {
+            app.aid = name->get_data();
+        }
+        const BerTlvRef proprietary = fci_tlv->find_by_tag(TAG_FCI_PROPRIETARY);
+        const BerTlvRef label = proprietary ? proprietary->find_by_tag(TAG_LABEL) : BerTlvRef();
+        if (label) {
+            app.label.assign(label->get_data().begin(), label->get_data().end());
+        }
+    } catch (const std::exception & e) {
+        PRINT_DEBUG("[D] Broken FCI: " << e.what());
+    }
+    return !app.aid.empty();
+}
+
+struct AIDDiscovery::Private
+{
+    std::vector<Bytes> aids;
+    std::unordered_set<std::string> aids_index;
+
+    std::unordered_map<std::string, AIDCounters> families;
+    AIDCounters global;
+
+    bool exhaustive;
+    unsigned long apdus;
+
+    Connection * c;
+    Reader reader;
+    Bytes command;
+    Bytes response;
+
+    // response data of successful command, "6Cxx" (wrong Le) is repeated with
+    // the right one
+    bool send(Bytes & data) {
+        c->transmit(reader, command, &response);
+        uint16_t status = c->response_status(response);
+        if ((status >> 8) == 0x6C) {
+            command.back() = static_cast<Byte>(status & 0xFF);
+            c->transmit(reader, command, &response);
+        }
+        if (c->response_status(response) != 0x9000) {
+            return false;
+        }
+        data = c->response_data(response);
+        return true;
+    }
+
+    bool select(const Bytes & name, Byte p2, Bytes & data) {
+        command.assign(CMD_SELECT, sizeof(CMD_SELECT));
+        command[3] = p2;
+        command.push_back(static_cast<Byte>(name.size()));
+        command.append(name);
+        command.push_back(0x00);
+        return send(data);
+    }
+
+    bool read_ppse(CardApplications & apps);
+    bool read_pse(CardApplications & apps);
+    void select_known(const std::vector<Bytes> & known, CardApplications & apps);
+    void partial_select(const std::vector<Bytes> & ordered, size_t seen, CardApplications & apps);
+    void probe(const std::vector<Bytes> & ordered, CardApplications & apps);
+};
+
+bool AIDDiscovery::Private::read_ppse(CardApplications & apps)
+{
+    Bytes data;
+    if (!select(PPSE_NAME, SELECT_FIRST, data)) {
+        return false;
+    }
+
+    try {
+        std::unique_ptr<BerTlv> tlv(BerTlv::parse(data));
+        const BerTlvRef fci = tlv->find_by_tag(TAG_FCI);
+        const BerTlvRef proprietary = fci ? fci->find_by_tag(TAG_FCI_PROPRIETARY) : BerTlvRef();
+        const BerTlvRef directory = proprietary
+            ? proprietary->find_by_tag(TAG_FCI_ISSUER_DISCRETIONARY) : BerTlvRef();
+        if (!directory) {
+            return false;
+        }
+
+        const BerTlvList & entries = directory->get_children();
+        for (auto i = entries.begin(); i != entries.end(); i++) {
+            if ((*i)->get_tag() == TAG_DIRECTORY_ENTRY) {
+                add_entry(*(*i), apps);
+            }
+        }
+    } catch (const std::exception & e) {
+        PRINT_DEBUG("[D] Broken PPSE FCI: " << e.what());
+    }
+    sort_by_priority(apps);
+    return apps.size() != 0;
+}
+
+bool AIDDiscovery::Private::read_pse(CardApplications & apps)
+{
+    Bytes data;
+    if (!select(PSE_NAME, SELECT_FIRST, data)) {
+        return false;
+    }
+
+    Byte sfi = 0;
+    try {
+        std::unique_ptr<BerTlv> tlv(BerTlv::parse(data));
+        const BerTlvRef fci = tlv->find_by_tag(TAG_FCI);
+        const BerTlvRef proprietary = fci ? fci->find_by_tag(TAG_FCI_PROPRIETARY) : BerTlvRef();
+        const BerTlvRef sfi_tlv = proprietary ? proprietary->find_by_tag(TAG_FCI_SFI) : BerTlvRef();
+        if (!sfi_tlv || sfi_tlv->get_data().size() != 1) {
+            return false;
+        }
+        sfi = sfi_tlv->get_data()[0];
+    } catch (const std::exception & e) {
+        PRINT_DEBUG("[D] Broken PSE FCI: " << e.what());
+        return false;
+    }
+
+    // directory records are read until "record not found"
+    for (size_t record = 1; record <= MAX_RECORDS; record++) {
+        command.assign(CMD_READ_RECORD, sizeof(CMD_READ_RECORD));
+        command[2] = record;
+        command[3] = (sfi << 3) | 0x04;
+        if (!send(data)) {
+            break;
+        }
+
+        try {
+            std::unique_ptr<BerTlv> tlv(BerTlv::parse(data));
+            const BerTlvRef rec = tlv->find_by_tag(TAG_RECORD);
+            if (!rec) {
+                continue;
+            }
+            const BerTlvList & entries = rec->get_children();
+            for (auto i = entries.begin(); i != entries.end(); i++) {
+                if ((*i)->get_tag() == TAG_DIRECTORY_ENTRY) {
+                    add_entry(*(*i), apps);
+                }
+            }
+        } catch (const std::exception & e) {
+            PRINT_DEBUG("[D] Broken PSE record " << record << ": " << e.what());
+        }
+    }
+    sort_by_priority(apps);
+    return apps.size() != 0;
+}
+
+void AIDDiscovery::Private::select_known(const std::vector<Bytes> & known, CardApplications & apps)
+{
+    Bytes data;
+
+    for (auto i = known.begin(); i != known.end(); i++) {
+        CardApplication app;
+        if (select(*i, SELECT_FIRST, data) && parse_fci(data, *i, app) && !find_app(apps, app.aid)) {
+            apps.push_back(app);
+        }
+    }
+}
+
+// first "seen" AIDs of "ordered" have hits, their RIDs are always tried
+void AIDDiscovery::Private::partial_select(const std::vector<Bytes> & ordered, size_t seen,
+    CardApplications & apps)
+{
+    std::unordered_set<std::string> rids;
+    Bytes data;
+
+    for (size_t k = 0; k < ordered.size(); k++) {
+        const Bytes & aid = ordered[k];
+        if (!has_rid(aid)) {
+            continue;
+        }
+        if (k >= seen && apps.size() != 0 && !exhaustive) {
+            break;
+        }
+        Bytes rid = aid.substr(0, RID_SIZE);
+        if (!rids.insert(aid_key(rid)).second) {
+            continue;
+        }
+
+        for (size_t n = 0; n < MAX_OCCURRENCES; n++) {
+            if (!select(rid, (n == 0) ? SELECT_FIRST : SELECT_NEXT, data)) {
+                break;
+            }
+            CardApplication app;
+            // without DF name next occurrence can't be told from the same one
+            if (!parse_fci(data, Bytes(), app) || find_app(apps, app.aid)) {
+                break;
+            }
+            apps.push_back(app);
+        }
+    }
+}
+
+void AIDDiscovery::Private::probe(const std::vector<Bytes> & ordered, CardApplications & apps)
+{
+    Bytes data;
+
+    for (auto i = ordered.begin(); i != ordered.end(); i++) {
+        // directories were selected already
+        if (*i == PPSE_NAME || *i == PSE_NAME) {
+            continue;
+        }
+        if (!select(*i, SELECT_FIRST, data)) {
+            continue;
+        }
+
+        CardApplication app;
+        if (parse_fci(data, *i, app) && !find_app(apps, app.aid)) {
+            apps.push_back(app);
+        }
+        if (!exhaustive) {
+            break;
+        }
+    }
+}
+
+AIDDiscovery::AIDDiscovery()
+{
+    p = new Private;
+    p->exhaustive = false;
+    p->apdus = 0;
+    p->c = 0;
+}
+
+AIDDiscovery::~AIDDiscovery()
+{
+    delete p;
+}
+
+void AIDDiscovery::add_aid(const Bytes & aid)
+{
+    if (aid.empty() || !p->aids_index.insert(aid_key(aid)).second) {
+        return;
+    }
+    p->aids.push_back(aid);
+}
+
+size_t AIDDiscovery::size() const
+{
+    return p->aids.size();
+}
+
+void AIDDiscovery::set_exhaustive(bool exhaustive)
+{
+    p->exhaustive = exhaustive;
+}
+
+bool AIDDiscovery::load_stats(const std::string & path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.at(0) == '#') {
+            continue;
+        }
+
+        std::istringstream s(line);
+        std::string family;
+        std::string aid_str;
+        unsigned long hits;
+
+        if (!(s >> family >> aid_str >> hits)) {
+            return false;
+        }
+
+        Bytes aid;
+        try {
+            aid = parse_apdu(aid_str);
+        } catch (APDUParseError & e) {
+            return false;
+        }
+        if (aid.empty()) {
+            return false;
+        }
+
+        p->families[family][aid_key(aid)] += hits;
+        p->global[aid_key(aid)] += hits;
+
+        // applications found before are worth probing even if not in list
+        add_aid(aid);
+    }
+
+    return true;
+}
+
+bool AIDDiscovery::save_stats(const std::string & path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "# family aid hits" << std::endl;
+    for (auto fi = p->families.begin(); fi != p->families.end(); fi++) {
+        for (auto ai = fi->second.begin(); ai != fi->second.end(); ai++) {
+            Bytes aid(ai->first.begin(), ai->first.end());
+            file << fi->first << ' ' << aid_hex(aid) << ' ' << ai->second << std::endl;
+        }
+    }
+
+    return file.good();
+}
+
+AIDDiscoveryMethod AIDDiscovery::discover(Connection & c, const Reader & reader,
+    const std::string & family, CardApplications & apps)
+{
+    p->c = &c;
+    p->reader = reader;
+    unsigned long apdus_before = c.metrics().apdus;
+
+    apps.clear();
+    AIDDiscoveryMethod method = AIDDiscoveryNone;
+
+    if (p->read_ppse(apps)) {
+        method = AIDDiscoveryPPSE;
+    } else if (p->read_pse(apps)) {
+        method = AIDDiscoveryPSE;
+    } else {
+        // applications seen on cards of the same family first, then seen anywhere,
+        // then list order
+        static const AIDCounters empty;
+        auto fi = p->families.find(family);
+        const AIDCounters & fc = (fi == p->families.end()) ? empty : fi->second;
+        auto hits = [](const AIDCounters & counters, const Bytes & aid) -> unsigned long {
+            auto i = counters.find(aid_key(aid));
+            return (i == counters.end()) ? 0 : i->second;
+        };
+
+        std::vector<Bytes> ordered(p->aids);
+        std::stable_sort(ordered.begin(), ordered.end(), [&](const Bytes & a, const Bytes & b) {
+            unsigned long fa = hits(fc, a);
+            unsigned long fb = hits(fc, b);
+            if (fa != fb) {
+                return fa > fb;
+            }
+            return hits(p->global, a) > hits(p->global, b);
+        });
+
+        size_t family_seen = 0;
+        size_t seen = 0;
+        for (auto i = ordered.begin(); i != ordered.end(); i++) {
+            if (hits(fc, *i) != 0) {
+                family_seen++;
+            }
+            if (hits(fc, *i) != 0 || hits(p->global, *i) != 0) {
+                seen++;
+            }
+        }
+
+        p->select_known(std::vector<Bytes>(ordered.begin(), ordered.begin() + family_seen), apps);
+        if (apps.size() != 0) {
+            method = AIDDiscoveryFamily;
+        } else {
+            p->partial_select(ordered, seen, apps);
+            if (apps.size() != 0) {
+                method = AIDDiscoveryPartialSelect;
+            } else {
+                // applications of the family were selected already
+                p->probe(std::vector<Bytes>(ordered.begin() + family_seen, ordered.end()), apps);
+                if (apps.size() != 0) {
+                    method = AIDDiscoveryProbe;
+                }
+            }
+        }
+    }
+
+    for (auto i = apps.begin(); i != apps.end(); i++) {
+        p->families[family][aid_key(i->aid)]++;
+        p->global[aid_key(i->aid)]++;
+        add_aid(i->aid);
+    }
+
+    p->apdus = c.metrics().apdus - apdus_before;
+    return method;
+}
+
+AIDDiscoveryMethod AIDDiscovery::read_directory(Connection & c, const Reader & reader,
+    bool contactless, CardApplications & apps)
+{
+    p->c = &c;
+    p->reader = reader;
+    unsigned long apdus_before = c.metrics().apdus;
+
+    apps.clear();
+    AIDDiscoveryMethod method = AIDDiscoveryNone;
+    if (contactless && p->read_ppse(apps)) {
+        method = AIDDiscoveryPPSE;
+    } else if (p->read_pse(apps)) {
+        method = AIDDiscoveryPSE;
+    }
+
+    p->apdus = c.metrics().apdus - apdus_before;
+    return method;
+}
+
+unsigned long AIDDiscovery::last_apdus() const
+{
+    return p->apdus;
+}
+
+}
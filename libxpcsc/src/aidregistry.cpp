@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file aidregistry.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Well-known AIDs lookup, trie data is generated from aids.txt.
+ */
+
+#include <algorithm>
+
+#include "../include/xpcsc.hpp"
+
+namespace xpcsc {
+
+struct AIDTrieNode {
+    uint16_t first_edge;
+    uint16_t edges;
+    // entry index + 1, 0 if no AID ends at this node
+    uint16_t entry;
+};
+
+struct AIDTrieEdge {
+    Byte byte;
+    uint16_t node;
+};
+
+#include "aidregistry_data.hpp"
+
+static const size_t AID_ENTRIES_COUNT = sizeof(AID_ENTRIES) / sizeof(AID_ENTRIES[0]);
+
+size_t aid_registry_size()
+{
+    return AID_ENTRIES_COUNT;
+}
+
+const AIDRegistryEntry & aid_registry_entry(size_t index)
+{
+    return AID_ENTRIES[index];
+}
+
+const AIDRegistryEntry * aid_registry_lookup(const Byte * aid, size_t length)
+{
+    const AIDRegistryEntry * found = 0;
+    uint16_t node = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        const AIDTrieEdge * first = AID_TRIE_EDGES + AID_TRIE_NODES[node].first_edge;
+        const AIDTrieEdge * last = first + AID_TRIE_NODES[node].edges;
+        const AIDTrieEdge * edge = std::lower_bound(first, last, aid[i],
+            [](const AIDTrieEdge & e, Byte b) { return e.byte < b; });
+
+        if (edge == last || edge->byte != aid[i]) {
+            break;
+        }
+        node = edge->node;
+        if (AID_TRIE_NODES[node].entry != 0) {
+            found = &AID_ENTRIES[AID_TRIE_NODES[node].entry - 1];
+        }
+    }
+
+    return found;
+}
+
+const AIDRegistryEntry * aid_registry_lookup(const Bytes & aid)
+{
+    return aid_registry_lookup(aid.data(), aid.size());
+}
+
+}
@@ -0,0 +1,2092 @@
+// generated by example-utils/compile-aid-registry from aids.txt, don't edit
+
+static constexpr Byte AID_BYTES[] = {
+    0x31, 0x50, 0x41, 0x59, 0x2E, 0x53, 0x59, 0x53, 0x2E, 0x44, 0x44, 0x46, 0x30, 0x31,
+    0x32, 0x50, 0x41, 0x59, 0x2E, 0x53, 0x59, 0x53, 0x2E, 0x44, 0x44, 0x46, 0x30, 0x31,
+    0x44, 0x46, 0x4D, 0x46, 0x41, 0x2E, 0x44, 0x46, 0x61, 0x72, 0x65, 0x32, 0x34, 0x31, 0x30, 0x31,
+    0xA0, 0x00, 0x00, 0x00, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x75, 0x61,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x05, 0x07, 0x60, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x10, 0x10, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x10, 0x10, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x20, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x20, 0x20,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x30, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x40, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x50, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x53, 0x44, 0x41,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x53, 0x50,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x53, 0x50, 0x41,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x60, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x60, 0x20,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x80, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x80, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x90, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x03, 0x99, 0x99, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x10, 0x10, 0x12, 0x13,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x10, 0x10, 0x12, 0x15,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x10, 0x10, 0xBB, 0x54, 0x49, 0x43, 0x53, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x20, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x22, 0x03,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x30, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x30, 0x60,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x30, 0x60, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x40, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x50, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x55, 0x55,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x60, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x80, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x04, 0x99, 0x99,
+    0xA0, 0x00, 0x00, 0x00, 0x05, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x05, 0x00, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x09, 0x00, 0x01, 0xFF, 0x44, 0xFF, 0x12, 0x89,
+    0xA0, 0x00, 0x00, 0x00, 0x10, 0x10, 0x30,
+    0xA0, 0x00, 0x00, 0x00, 0x18, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x18, 0x10, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x18, 0x43, 0x4D,
+    0xA0, 0x00, 0x00, 0x00, 0x18, 0x43, 0x4D, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x24, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x25,
+    0xA0, 0x00, 0x00, 0x00, 0x25, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x25, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x25, 0x01, 0x01, 0x04,
+    0xA0, 0x00, 0x00, 0x00, 0x25, 0x01, 0x04, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x25, 0x01, 0x07, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x25, 0x01, 0x08, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x29, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x29, 0x45, 0x08, 0x75, 0x10, 0x10, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x29, 0x49, 0x03, 0x40, 0x10, 0x10, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x29, 0x49, 0x28, 0x20, 0x10, 0x10, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x29, 0x56, 0x41, 0x82,
+    0xA0, 0x00, 0x00, 0x00, 0x30, 0x29, 0x05, 0x70, 0x00, 0xAD, 0x13, 0x10, 0x01, 0x01, 0xFF,
+    0xA0, 0x00, 0x00, 0x00, 0x30, 0x80, 0x00, 0x00, 0x00, 0x00, 0x28, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x42, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x42, 0x20, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x42, 0x30, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x42, 0x40, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x42, 0x50, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x59, 0x45, 0x43, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x63, 0x50, 0x4B, 0x43, 0x53, 0x2D, 0x31, 0x35,
+    0xA0, 0x00, 0x00, 0x00, 0x63, 0x57, 0x41, 0x50, 0x2D, 0x57, 0x49, 0x4D,
+    0xA0, 0x00, 0x00, 0x00, 0x65, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x65, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x00, 0x69, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x77, 0x01, 0x00, 0x00, 0x02, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3B,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x01, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x01, 0xF0,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x01, 0xF1,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x01, 0xF2,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x02, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x02, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x02, 0xFB,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x02, 0xFD,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x02, 0xFE,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x03, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x12, 0x01,
+    0xA0, 0x00, 0x00, 0x00, 0x79, 0x12, 0x02,
+    0xA0, 0x00, 0x00, 0x00, 0x87, 0x10, 0x02, 0xFF, 0x49, 0xFF, 0x05, 0x89,
+    0xA0, 0x00, 0x00, 0x00, 0x88, 0x10, 0x20, 0x01, 0x05, 0xC1, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x88, 0x10, 0x22, 0x01, 0x03, 0x42, 0x21,
+    0xA0, 0x00, 0x00, 0x00, 0x88, 0x10, 0x22, 0x01, 0x03, 0x43, 0x21,
+    0xA0, 0x00, 0x00, 0x00, 0x96, 0x02, 0x00,
+    0xA0, 0x00, 0x00, 0x00, 0x98,
+    0xA0, 0x00, 0x00, 0x00, 0x98, 0x08, 0x40,
+    0xA0, 0x00, 0x00, 0x00, 0x98, 0x08, 0x48,
+    0xA0, 0x00, 0x00, 0x01, 0x11, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x16, 0x03, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x16, 0x60, 0x10,
+    0xA0, 0x00, 0x00, 0x01, 0x16, 0x60, 0x30,
+    0xA0, 0x00, 0x00, 0x01, 0x16, 0x90, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x16, 0xA0, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x16, 0xDB, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x18, 0x01, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x18, 0x02, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x18, 0x03, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x18, 0x04, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x18, 0x45, 0x43,
+    0xA0, 0x00, 0x00, 0x01, 0x18, 0x45, 0x4E,
+    0xA0, 0x00, 0x00, 0x01, 0x21, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x01, 0x32, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x40, 0x80, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x41, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x51, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x51, 0x53, 0x50, 0x43, 0x41, 0x53, 0x44, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x52, 0x30, 0x10,
+    0xA0, 0x00, 0x00, 0x01, 0x52, 0x40, 0x10,
+    0xA0, 0x00, 0x00, 0x01, 0x54, 0x44, 0x42,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x10,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x20,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x21,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x22,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x23,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x30,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x31,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x40,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x50,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x00, 0x51,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x04,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x09,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x0A,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x0B,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x0C,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x01, 0x0D,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x44, 0x43,
+    0xA0, 0x00, 0x00, 0x01, 0x57, 0x44, 0x44,
+    0xA0, 0x00, 0x00, 0x01, 0x67, 0x41, 0x30, 0x00, 0xFF,
+    0xA0, 0x00, 0x00, 0x01, 0x67, 0x41, 0x30, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x72, 0x95, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x77, 0x50, 0x4B, 0x43, 0x53, 0x2D, 0x31, 0x35,
+    0xA0, 0x00, 0x00, 0x01, 0x85, 0x00, 0x02,
+    0xA0, 0x00, 0x00, 0x01, 0x88, 0x44, 0x43,
+    0xA0, 0x00, 0x00, 0x02, 0x04, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x02, 0x28, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x02, 0x28, 0x20, 0x10,
+    0xA0, 0x00, 0x00, 0x02, 0x28, 0x20, 0x10, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x02, 0x47, 0x10, 0x01,
+    0xA0, 0x00, 0x00, 0x02, 0x47, 0x20, 0x01,
+    0xA0, 0x00, 0x00, 0x02, 0x77, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x03, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x03, 0x08, 0x00, 0x00, 0x10, 0x00, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x03, 0x15, 0x10, 0x10, 0x05, 0x28,
+    0xA0, 0x00, 0x00, 0x03, 0x15, 0x60, 0x20,
+    0xA0, 0x00, 0x00, 0x03, 0x23, 0x01,
+    0xA0, 0x00, 0x00, 0x03, 0x23, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x03, 0x24, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x03, 0x33, 0x01, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x03, 0x33, 0x01, 0x01, 0x02,
+    0xA0, 0x00, 0x00, 0x03, 0x33, 0x01, 0x01, 0x03,
+    0xA0, 0x00, 0x00, 0x03, 0x33, 0x01, 0x01, 0x06,
+    0xA0, 0x00, 0x00, 0x03, 0x59, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x03, 0x59, 0x10, 0x10, 0x02, 0x80, 0x01,
+    0xA0, 0x00, 0x00, 0x03, 0x59, 0x10, 0x10, 0x03, 0x80,
+    0xA0, 0x00, 0x00, 0x03, 0x66, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x03, 0x66, 0x00, 0x02,
+    0xA0, 0x00, 0x00, 0x03, 0x71, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x03, 0x96, 0x4D, 0x66, 0x34, 0x4D, 0x00, 0x02,
+    0xA0, 0x00, 0x00, 0x03, 0x97, 0x42, 0x54, 0x46, 0x59,
+    0xA0, 0x00, 0x00, 0x03, 0x97, 0x43, 0x49, 0x44, 0x5F, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x04, 0x27, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x04, 0x32, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x04, 0x36, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x04, 0x39, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x04, 0x54, 0x00, 0x10,
+    0xA0, 0x00, 0x00, 0x04, 0x54, 0x00, 0x11,
+    0xA0, 0x00, 0x00, 0x04, 0x76, 0x20, 0x10,
+    0xA0, 0x00, 0x00, 0x04, 0x76, 0x30, 0x30,
+    0xA0, 0x00, 0x00, 0x04, 0x76, 0x6C,
+    0xA0, 0x00, 0x00, 0x04, 0x76, 0xA0, 0x10,
+    0xA0, 0x00, 0x00, 0x04, 0x76, 0xA1, 0x10,
+    0xA0, 0x00, 0x00, 0x04, 0x85,
+    0xA0, 0x00, 0x00, 0x05, 0x24, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x05, 0x27, 0x10, 0x02,
+    0xA0, 0x00, 0x00, 0x05, 0x27, 0x20, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x05, 0x27, 0x21, 0x01, 0x01,
+    0xA0, 0x00, 0x00, 0x05, 0x59, 0x10, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0x00, 0x00, 0x01, 0x00,
+    0xA0, 0x00, 0x00, 0x05, 0x59, 0x10, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0x00, 0x00, 0x02, 0x00,
+    0xA0, 0x00, 0x00, 0x05, 0x59, 0x10, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0x00, 0x00, 0x0D, 0x00,
+    0xA0, 0x00, 0x00, 0x05, 0x59, 0x10, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0x00, 0x00, 0x0E, 0x00,
+    0xA0, 0x00, 0x00, 0x05, 0x59, 0x10, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0x00, 0x00, 0x0F, 0x00,
+    0xA0, 0x00, 0x00, 0x05, 0x59, 0x10, 0x10, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0x00, 0x00, 0x10, 0x00,
+    0xA0, 0x00, 0x00, 0x06, 0x17, 0x00,
+    0xA0, 0x00, 0x00, 0x06, 0x20, 0x06, 0x20,
+    0xA0, 0x00, 0x00, 0x06, 0x58, 0x10, 0x10,
+    0xA0, 0x00, 0x00, 0x06, 0x58, 0x20, 0x10,
+    0xA0, 0x00, 0x00, 0x06, 0x72, 0x30, 0x10,
+    0xA0, 0x00, 0x00, 0x06, 0x72, 0x30, 0x20,
+    0xB0, 0x12, 0x34, 0x56, 0x78,
+    0xD0, 0x40, 0x00, 0x00, 0x01, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x02, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x03, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x04, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x0B, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x0D, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x13, 0x00, 0x00, 0x01,
+    0xD0, 0x40, 0x00, 0x00, 0x13, 0x00, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x14, 0x00, 0x00, 0x01,
+    0xD0, 0x40, 0x00, 0x00, 0x15, 0x00, 0x00, 0x01,
+    0xD0, 0x40, 0x00, 0x00, 0x19, 0x00, 0x01,
+    0xD0, 0x40, 0x00, 0x00, 0x19, 0x00, 0x02,
+    0xD0, 0x40, 0x00, 0x00, 0x19, 0x00, 0x03,
+    0xD0, 0x40, 0x00, 0x00, 0x19, 0x00, 0x04,
+    0xD0, 0x40, 0x00, 0x00, 0x19, 0x00, 0x10,
+    0xD2, 0x76, 0x00, 0x00, 0x05,
+    0xD2, 0x76, 0x00, 0x00, 0x05, 0xAA, 0x04, 0x03, 0x60, 0x01, 0x04, 0x10,
+    0xD2, 0x76, 0x00, 0x00, 0x05, 0xAA, 0x05, 0x03, 0xE0, 0x04, 0x01,
+    0xD2, 0x76, 0x00, 0x00, 0x05, 0xAA, 0x05, 0x03, 0xE0, 0x05, 0x01,
+    0xD2, 0x76, 0x00, 0x00, 0x05, 0xAA, 0x05, 0x03, 0xE0, 0x05, 0x01, 0x01,
+    0xD2, 0x76, 0x00, 0x00, 0x05, 0xAB, 0x05, 0x03, 0xE0, 0x04, 0x01, 0x01,
+    0xD2, 0x76, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x01,
+    0xD2, 0x76, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x02,
+    0xD2, 0x76, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x60,
+    0xD2, 0x76, 0x00, 0x00, 0x25,
+    0xD2, 0x76, 0x00, 0x00, 0x25, 0x45, 0x41, 0x01, 0x00,
+    0xD2, 0x76, 0x00, 0x00, 0x25, 0x45, 0x50, 0x01, 0x00,
+    0xD2, 0x76, 0x00, 0x00, 0x25, 0x47, 0x41, 0x01, 0x00,
+    0xD2, 0x76, 0x00, 0x00, 0x60,
+    0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x00,
+    0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01,
+    0xD2, 0x76, 0x00, 0x01, 0x18,
+    0xD2, 0x76, 0x00, 0x01, 0x18, 0x01, 0x01,
+    0xD2, 0x76, 0x00, 0x01, 0x24, 0x01,
+    0xD2, 0x76, 0x00, 0x01, 0x24, 0x01, 0x01, 0x01, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0xD2, 0x76, 0x00, 0x01, 0x24, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0xD2, 0x76, 0x00, 0x01, 0x24, 0x02,
+    0xD2, 0x76, 0x00, 0x01, 0x24, 0x02, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xD4, 0x10, 0x00, 0x00, 0x01, 0x10, 0x10,
+    0xD5, 0x28, 0x00, 0x50, 0x21, 0x80, 0x02,
+    0xD5, 0x78, 0x00, 0x00, 0x02, 0x10, 0x10,
+    0xD7, 0x56, 0x00, 0x00, 0x01, 0x01, 0x01,
+    0xD7, 0x56, 0x00, 0x00, 0x30, 0x01, 0x01,
+    0xE8, 0x07, 0x04, 0x00, 0x7F, 0x00, 0x07, 0x03, 0x02,
+    0xE8, 0x28, 0x81, 0xC1, 0x17, 0x02,
+    0xE8, 0x28, 0xBD, 0x08, 0x0F,
+    0xF0, 0x00, 0x00, 0x00, 0x03, 0x00, 0x01,
+    0xA0, 0x00, 0x00, 0x01, 0x51, 0x00, 0x00, 0x00,
+    0xA0, 0x00, 0x00, 0x04, 0x32, 0x55, 0x45, 0x43, 0x49, 0x53, 0x44,
+    0xA0, 0x00, 0x00, 0x04, 0x32, 0x55, 0x45, 0x43, 0x53, 0x53, 0x44, 0x31,
+};
+
+static constexpr AIDRegistryEntry AID_ENTRIES[] = {
+    {AID_BYTES + 0, 14, "Visa Payment System Environment - PSE (1PAY.SYS.DDF01)"},
+    {AID_BYTES + 14, 14, "Visa Proximity Payment System Environment - PPSE (2PAY.SYS.DDF01)"},
+    {AID_BYTES + 28, 16, "DeviceFidelity In2Pay DFare applet"},
+    {AID_BYTES + 44, 6, "MUSCLE Card Applet"},
+    {AID_BYTES + 50, 8, "(VISA) Card Manager GP"},
+    {AID_BYTES + 58, 9, "Bonuscard"},
+    {AID_BYTES + 67, 9, "VISA ELO Credit EMV"},
+    {AID_BYTES + 76, 7, "VISA Debit/Credit (Classic) EMV"},
+    {AID_BYTES + 83, 8, "VISA Credit EMV"},
+    {AID_BYTES + 91, 8, "VISA Debit EMV"},
+    {AID_BYTES + 99, 7, "VISA Electron EMV"},
+    {AID_BYTES + 106, 7, "VISA EMV"},
+    {AID_BYTES + 113, 7, "VISA Interlink EMV"},
+    {AID_BYTES + 120, 7, "VISA Specific EMV"},
+    {AID_BYTES + 127, 7, "VISA Specific EMV"},
+    {AID_BYTES + 134, 8, "Schlumberger Security Domain GP"},
+    {AID_BYTES + 142, 7, "Security Domain GP"},
+    {AID_BYTES + 149, 8, "Security Domain GP"},
+    {AID_BYTES + 157, 7, "Domestic Visa Cash Stored Value EMV"},
+    {AID_BYTES + 164, 7, "International Visa Cash Stored Value EMV"},
+    {AID_BYTES + 171, 7, "VISA Auth, VisaRemAuthen EMV-CAP (DPA) EMV"},
+    {AID_BYTES + 178, 7, "VISA Plus EMV"},
+    {AID_BYTES + 185, 7, "VISA Loyalty EMV"},
+    {AID_BYTES + 192, 8, "VISA Proprietary ATM EMV"},
+    {AID_BYTES + 200, 7, "MasterCard Card Manager GP"},
+    {AID_BYTES + 207, 6, "MasterCard PayPass EMV"},
+    {AID_BYTES + 213, 7, "MasterCard Credit EMV"},
+    {AID_BYTES + 220, 9, "MasterCard Credit EMV"},
+    {AID_BYTES + 229, 9, "MasterCard Credit EMV"},
+    {AID_BYTES + 238, 13, "[UNKNOWN]"},
+    {AID_BYTES + 251, 7, "MasterCard Specific EMV"},
+    {AID_BYTES + 258, 7, "MasterCard Specific"},
+    {AID_BYTES + 265, 7, "MasterCard Specific EMV"},
+    {AID_BYTES + 272, 7, "Maestro (Debit) EMV"},
+    {AID_BYTES + 279, 8, "Maestro (Debit) EMV"},
+    {AID_BYTES + 287, 7, "MasterCard Specific EMV"},
+    {AID_BYTES + 294, 7, "MasterCard Specific EMV"},
+    {AID_BYTES + 301, 7, "APDULogger"},
+    {AID_BYTES + 308, 7, "Cirrus EMV"},
+    {AID_BYTES + 315, 7, "SecureCode Auth EMV-CAP EMV"},
+    {AID_BYTES + 322, 7, "MasterCard PayPass?? EMV"},
+    {AID_BYTES + 329, 7, "Maestro UK EMV"},
+    {AID_BYTES + 336, 7, "Solo EMV"},
+    {AID_BYTES + 343, 12, "Orange"},
+    {AID_BYTES + 355, 7, "Maestro-CH"},
+    {AID_BYTES + 362, 6, "Gemplus ?"},
+    {AID_BYTES + 368, 7, "com.gemplus.javacard.util packages"},
+    {AID_BYTES + 375, 7, "Gemplus card manager GP"},
+    {AID_BYTES + 382, 8, "Gemplus Security Domain GP"},
+    {AID_BYTES + 390, 6, "Self Service EMV"},
+    {AID_BYTES + 396, 5, "American Express EMV"},
+    {AID_BYTES + 401, 7, "American Express EMV"},
+    {AID_BYTES + 408, 6, "American Express EMV"},
+    {AID_BYTES + 414, 8, "American Express"},
+    {AID_BYTES + 422, 8, "American Express EMV"},
+    {AID_BYTES + 430, 8, "ExpressPay EMV"},
+    {AID_BYTES + 438, 8, "American Express EMV"},
+    {AID_BYTES + 446, 7, "Link / American Express EMV"},
+    {AID_BYTES + 453, 12, "CO-OP"},
+    {AID_BYTES + 465, 12, "HSBC"},
+    {AID_BYTES + 477, 12, "Barclay"},
+    {AID_BYTES + 489, 8, "HAFX"},
+    {AID_BYTES + 497, 15, "BelPIC (Belgian Personal Identity Card) JavaCard Applet"},
+    {AID_BYTES + 512, 13, "Gemalto .NET Card AID"},
+    {AID_BYTES + 525, 7, "Cartes Bancaire EMV Card EMV"},
+    {AID_BYTES + 532, 7, "  EMV"},
+    {AID_BYTES + 539, 7, "  EMV"},
+    {AID_BYTES + 546, 7, "  EMV"},
+    {AID_BYTES + 553, 7, "  EMV"},
+    {AID_BYTES + 560, 9, "Girocard Electronic Cash"},
+    {AID_BYTES + 569, 12, "PKCS-15"},
+    {AID_BYTES + 581, 12, "WAP-WIM"},
+    {AID_BYTES + 593, 6, "JCB EMV"},
+    {AID_BYTES + 599, 7, "JCB J Smart Credit EMV"},
+    {AID_BYTES + 606, 6, "Moneo EMV"},
+    {AID_BYTES + 612, 16, "Visa AEPN EMV"},
+    {AID_BYTES + 628, 7, "CACv2 PKI ID"},
+    {AID_BYTES + 635, 7, "CACv2 PKI Sign"},
+    {AID_BYTES + 642, 7, "CACv2 PKI Enc"},
+    {AID_BYTES + 649, 7, "CACv1 PKI Identity Key"},
+    {AID_BYTES + 656, 7, "CACv1 PKI Digital Signature Key"},
+    {AID_BYTES + 663, 7, "CACv1 PKI Key Management Key"},
+    {AID_BYTES + 670, 7, "CACv2 DoD Person"},
+    {AID_BYTES + 677, 7, "CACv2 DoD Personnel"},
+    {AID_BYTES + 684, 7, "CACv1 BC"},
+    {AID_BYTES + 691, 7, "CACv1 BC"},
+    {AID_BYTES + 698, 7, "CACv1 BC"},
+    {AID_BYTES + 705, 7, "CACv2 Access Control Applet"},
+    {AID_BYTES + 712, 7, "CAC JDM"},
+    {AID_BYTES + 719, 7, "CAC JDM"},
+    {AID_BYTES + 726, 12, "Telenor USIM USIM"},
+    {AID_BYTES + 738, 11, "BuyPass BIDA BuyPass"},
+    {AID_BYTES + 749, 11, "BuyPass BEID (BuyPass Electronic ID?) BuyPass"},
+    {AID_BYTES + 760, 11, "BuyPass BEID (BuyPass Electronic ID?) BuyPass"},
+    {AID_BYTES + 771, 7, "Proton World International Security Domain GP"},
+    {AID_BYTES + 778, 5, "Debit Card EMV"},
+    {AID_BYTES + 783, 7, "Visa Common Debit"},
+    {AID_BYTES + 790, 7, "Debit Card EMV"},
+    {AID_BYTES + 797, 7, "Postcard"},
+    {AID_BYTES + 804, 7, "PIV CHUID"},
+    {AID_BYTES + 811, 7, "PIV Fingerprints"},
+    {AID_BYTES + 818, 7, "PIV Facial Image"},
+    {AID_BYTES + 825, 7, "PIV Security Object"},
+    {AID_BYTES + 832, 7, "PIV Authentication Key"},
+    {AID_BYTES + 839, 7, "CCC"},
+    {AID_BYTES + 846, 8, "DF_Verkehr"},
+    {AID_BYTES + 854, 8, "DF_Partner"},
+    {AID_BYTES + 862, 8, "DF_Schülerdaten"},
+    {AID_BYTES + 870, 8, "DF_KEP_SIG"},
+    {AID_BYTES + 878, 7, "Digital Signature (SSCA)"},
+    {AID_BYTES + 885, 7, "Encryption Application"},
+    {AID_BYTES + 892, 7, "Dankort (VISA GEM Vision) EMV"},
+    {AID_BYTES + 899, 7, "org.javacardforum.javacard.biometry"},
+    {AID_BYTES + 906, 7, "eCode"},
+    {AID_BYTES + 913, 7, "PagoBANCOMAT EMV"},
+    {AID_BYTES + 920, 7, "Global Platform Security Domain AID GP"},
+    {AID_BYTES + 927, 12, "CASD_AID GP"},
+    {AID_BYTES + 939, 7, "Discover EMV"},
+    {AID_BYTES + 946, 7, "Discover EMV"},
+    {AID_BYTES + 953, 7, "Banricompras Debito EMV"},
+    {AID_BYTES + 960, 7, "AMEX"},
+    {AID_BYTES + 967, 7, "MasterCard"},
+    {AID_BYTES + 974, 7, "Maestro"},
+    {AID_BYTES + 981, 7, "Maestro"},
+    {AID_BYTES + 988, 7, "CASH"},
+    {AID_BYTES + 995, 7, "VISA"},
+    {AID_BYTES + 1002, 7, "VISA"},
+    {AID_BYTES + 1009, 7, "JCB"},
+    {AID_BYTES + 1016, 7, "Postcard"},
+    {AID_BYTES + 1023, 7, "Postcard"},
+    {AID_BYTES + 1030, 7, "MCard"},
+    {AID_BYTES + 1037, 7, "MyOne"},
+    {AID_BYTES + 1044, 7, "Mediamarkt Card"},
+    {AID_BYTES + 1051, 7, "Gift Card"},
+    {AID_BYTES + 1058, 7, "Bonuscard"},
+    {AID_BYTES + 1065, 7, "WIRCard"},
+    {AID_BYTES + 1072, 7, "Power Card"},
+    {AID_BYTES + 1079, 7, "DINERS CLUB"},
+    {AID_BYTES + 1086, 7, "Supercard Plus"},
+    {AID_BYTES + 1093, 9, "JCOP Identify Applet JCOP"},
+    {AID_BYTES + 1102, 8, "FIPS 140-2"},
+    {AID_BYTES + 1110, 8, "BAROC Financial Application Taiwan EMV"},
+    {AID_BYTES + 1118, 12, "BelPIC (Belgian Personal Identity Card)"},
+    {AID_BYTES + 1130, 7, "UK Post Office Account card EMV"},
+    {AID_BYTES + 1137, 7, "DINERS CLUB"},
+    {AID_BYTES + 1144, 7, "?"},
+    {AID_BYTES + 1151, 7, "SPAN (M/Chip) EMV"},
+    {AID_BYTES + 1158, 7, "SPAN (VIS) EMV"},
+    {AID_BYTES + 1165, 9, "SPAN"},
+    {AID_BYTES + 1174, 7, "Machine Readable Travel Documents (MRTD) MRTD"},
+    {AID_BYTES + 1181, 7, "Machine Readable Travel Documents (MRTD) MRTD"},
+    {AID_BYTES + 1188, 7, "INTERAC EMV"},
+    {AID_BYTES + 1195, 12, "PC/SC Initial access data AID"},
+    {AID_BYTES + 1207, 11, "Personal Identity Verification (PIV) / ID-ONE PIV BIO"},
+    {AID_BYTES + 1218, 9, "Currence PuC EMV"},
+    {AID_BYTES + 1227, 7, "Chipknip EMV"},
+    {AID_BYTES + 1234, 6, "MUSCLE Applet Package"},
+    {AID_BYTES + 1240, 7, "MUSCLE Applet Instance"},
+    {AID_BYTES + 1247, 7, "Discover Expresspay (ZIP)"},
+    {AID_BYTES + 1254, 8, "UnionPay Debit"},
+    {AID_BYTES + 1262, 8, "UnionPay Credit"},
+    {AID_BYTES + 1270, 8, "UnionPay Quasi Credit"},
+    {AID_BYTES + 1278, 8, "UnionPay Electronic Cash"},
+    {AID_BYTES + 1286, 7, ""},
+    {AID_BYTES + 1293, 10, "Girocard EAPS EMV"},
+    {AID_BYTES + 1303, 9, ""},
+    {AID_BYTES + 1312, 7, "Postamat"},
+    {AID_BYTES + 1319, 7, "Postamat VISA"},
+    {AID_BYTES + 1326, 7, "InterSwitch Verve Card EMV"},
+    {AID_BYTES + 1333, 11, "MIFARE4MOBILE"},
+    {AID_BYTES + 1344, 9, "Microsoft IDMP AID"},
+    {AID_BYTES + 1353, 11, "Microsoft PNP AID"},
+    {AID_BYTES + 1364, 7, "Hiperchip"},
+    {AID_BYTES + 1371, 7, "Universal Electronic Card"},
+    {AID_BYTES + 1378, 7, "Ticket Restaurant"},
+    {AID_BYTES + 1385, 7, "Exchange ATM card"},
+    {AID_BYTES + 1392, 7, "Etranzact Genesis Card EMV"},
+    {AID_BYTES + 1399, 7, "Etranzact Genesis Card 2 EMV"},
+    {AID_BYTES + 1406, 7, "GOOGLE_CONTROLLER_AID"},
+    {AID_BYTES + 1413, 7, "GOOGLE_MIFARE_MANAGER_AID"},
+    {AID_BYTES + 1420, 6, "GOOGLE_PAYMENT_AID EMV"},
+    {AID_BYTES + 1426, 7, "GSD_MANAGER_AID GP"},
+    {AID_BYTES + 1433, 7, "GSD_MANAGER_AID GP"},
+    {AID_BYTES + 1440, 5, "Softcard SmartTap"},
+    {AID_BYTES + 1445, 7, "RuPay EMV"},
+    {AID_BYTES + 1452, 7, "Yubikey NEO U2F Demo applet YKNEO"},
+    {AID_BYTES + 1459, 8, "Yubikey NEO Yubikey2 applet interface YKNEO"},
+    {AID_BYTES + 1467, 8, "Yubikey NEO OATH Applet YKNEO"},
+    {AID_BYTES + 1475, 16, "ISD-R Application. Used as TAR."},
+    {AID_BYTES + 1491, 16, "ECASD Application. Used as TAR."},
+    {AID_BYTES + 1507, 16, "ISD-P Executable Load File."},
+    {AID_BYTES + 1523, 16, "ISD-P Executable Module."},
+    {AID_BYTES + 1539, 16, "Reserved value for the Profile's ISD-P"},
+    {AID_BYTES + 1555, 16, "ISD-P Application ('1010FFFFFFFF89000010' to '1010FFFFFFFF8900FFFF'. Used as TAR. The value is allocated during the 'Profile Download and Installation procedure'"},
+    {AID_BYTES + 1571, 6, "Fidesmo javacard"},
+    {AID_BYTES + 1577, 7, "Debit Network Alliance (DNA)"},
+    {AID_BYTES + 1584, 7, "MIR Credit"},
+    {AID_BYTES + 1591, 7, "MIR Debit"},
+    {AID_BYTES + 1598, 7, "TROY chip credit card EMV"},
+    {AID_BYTES + 1605, 7, "TROY chip debit card EMV"},
+    {AID_BYTES + 1612, 5, "Maestro TEST EMV"},
+    {AID_BYTES + 1617, 8, "Paylife Quick (IEP). Preloaded Electronic Purse"},
+    {AID_BYTES + 1625, 8, "RFU"},
+    {AID_BYTES + 1633, 8, "POS"},
+    {AID_BYTES + 1641, 8, "ATM"},
+    {AID_BYTES + 1649, 8, "Retail"},
+    {AID_BYTES + 1657, 8, "Bank_Data"},
+    {AID_BYTES + 1665, 8, "Shopping"},
+    {AID_BYTES + 1673, 8, "DF_UNI_Kepler1"},
+    {AID_BYTES + 1681, 8, "DF_UNI_Kepler2"},
+    {AID_BYTES + 1689, 8, "DF_Mensa"},
+    {AID_BYTES + 1697, 8, "DF_UNI_Ausweis"},
+    {AID_BYTES + 1705, 7, "EMV ATM Maestro"},
+    {AID_BYTES + 1712, 7, "EMV POS Maestro"},
+    {AID_BYTES + 1719, 7, "EMV ATM MasterCard"},
+    {AID_BYTES + 1726, 7, "EMV POS MasterCard"},
+    {AID_BYTES + 1733, 7, "Digital ID"},
+    {AID_BYTES + 1740, 5, ""},
+    {AID_BYTES + 1745, 12, "G D App Nokia 6212"},
+    {AID_BYTES + 1757, 11, "G D App Nokia 6212"},
+    {AID_BYTES + 1768, 11, "G D App Nokia 6212"},
+    {AID_BYTES + 1779, 12, "G D App Nokia 6212"},
+    {AID_BYTES + 1791, 12, "G D App Nokia 6212"},
+    {AID_BYTES + 1803, 9, "SCT LOYALTY"},
+    {AID_BYTES + 1812, 9, "BUSINESS CARD"},
+    {AID_BYTES + 1821, 9, "PKCS#11 Token"},
+    {AID_BYTES + 1830, 5, "Girocard"},
+    {AID_BYTES + 1835, 9, ""},
+    {AID_BYTES + 1844, 9, "Girocard EMV"},
+    {AID_BYTES + 1853, 9, "Girocard ATM"},
+    {AID_BYTES + 1862, 5, ""},
+    {AID_BYTES + 1867, 7, "NDEF Tag Application / Mifare DESFire Tag Application"},
+    {AID_BYTES + 1874, 7, "NDEF Tag Application"},
+    {AID_BYTES + 1881, 5, ""},
+    {AID_BYTES + 1886, 7, "Giesecke &amp"},
+    {AID_BYTES + 1893, 6, "OpenPGP Card OpenPGP"},
+    {AID_BYTES + 1899, 16, "OpenPGP Card OpenPGP"},
+    {AID_BYTES + 1915, 16, "OpenPGP Card OpenPGP"},
+    {AID_BYTES + 1931, 6, "SmartChess SmartChess"},
+    {AID_BYTES + 1937, 16, "SmartChess SmartChess"},
+    {AID_BYTES + 1953, 7, ""},
+    {AID_BYTES + 1960, 7, "? EMV"},
+    {AID_BYTES + 1967, 7, "Bankaxept EMV"},
+    {AID_BYTES + 1974, 7, "Reka Card"},
+    {AID_BYTES + 1981, 7, "M Budget"},
+    {AID_BYTES + 1988, 9, "nPA"},
+    {AID_BYTES + 1997, 6, "AlphaCard application"},
+    {AID_BYTES + 2003, 5, "ISO-7816-15 EF.DIR"},
+    {AID_BYTES + 2008, 7, "BRADESCO EMV"},
+    {AID_BYTES + 2015, 8, "Default Card Manager (GP)"},
+    {AID_BYTES + 2023, 11, "UEK Main Security Domain"},
+    {AID_BYTES + 2034, 12, "UEK Secondary Security Domain"},
+};
+
+static constexpr AIDTrieNode AID_TRIE_NODES[] = {
+    {0, 12, 0},
+    {12, 1, 0},
+    {13, 1, 0},
+    {14, 1, 0},
+    {15, 1, 0},
+    {16, 1, 0},
+    {17, 1, 0},
+    {18, 1, 0},
+    {19, 1, 0},
+    {20, 1, 0},
+    {21, 1, 0},
+    {22, 1, 0},
+    {23, 1, 0},
+    {24, 1, 0},
+    {25, 0, 1},
+    {25, 1, 0},
+    {26, 1, 0},
+    {27, 1, 0},
+    {28, 1, 0},
+    {29, 1, 0},
+    {30, 1, 0},
+    {31, 1, 0},
+    {32, 1, 0},
+    {33, 1, 0},
+    {34, 1, 0},
+    {35, 1, 0},
+    {36, 1, 0},
+    {37, 1, 0},
+    {38, 0, 2},
+    {38, 1, 0},
+    {39, 1, 0},
+    {40, 1, 0},
+    {41, 1, 0},
+    {42, 1, 0},
+    {43, 1, 0},
+    {44, 1, 0},
+    {45, 1, 0},
+    {46, 1, 0},
+    {47, 1, 0},
+    {48, 1, 0},
+    {49, 1, 0},
+    {50, 1, 0},
+    {51, 1, 0},
+    {52, 1, 0},
+    {53, 0, 3},
+    {53, 1, 0},
+    {54, 1, 0},
+    {55, 7, 0},
+    {62, 22, 0},
+    {84, 1, 0},
+    {85, 0, 4},
+    {85, 12, 0},
+    {97, 2, 0},
+    {99, 1, 0},
+    {100, 0, 5},
+    {100, 1, 0},
+    {101, 1, 0},
+    {102, 0, 6},
+    {102, 1, 0},
+    {103, 1, 0},
+    {104, 1, 0},
+    {105, 0, 7},
+    {105, 1, 0},
+    {106, 2, 8},
+    {108, 0, 9},
+    {108, 0, 10},
+    {108, 2, 0},
+    {110, 0, 11},
+    {110, 0, 12},
+    {110, 1, 0},
+    {111, 0, 13},
+    {111, 1, 0},
+    {112, 0, 14},
+    {112, 1, 0},
+    {113, 0, 15},
+    {113, 2, 0},
+    {115, 1, 0},
+    {116, 0, 16},
+    {116, 1, 17},
+    {117, 0, 18},
+    {117, 2, 0},
+    {119, 0, 19},
+    {119, 0, 20},
+    {119, 2, 0},
+    {121, 0, 21},
+    {121, 0, 22},
+    {121, 1, 0},
+    {122, 0, 23},
+    {122, 1, 0},
+    {123, 1, 0},
+    {124, 0, 24},
+    {124, 12, 0},
+    {136, 1, 0},
+    {137, 0, 25},
+    {137, 0, 26},
+    {137, 1, 0},
+    {138, 2, 27},
+    {140, 2, 0},
+    {142, 0, 28},
+    {142, 0, 29},
+    {142, 1, 0},
+    {143, 1, 0},
+    {144, 1, 0},
+    {145, 1, 0},
+    {146, 1, 0},
+    {147, 0, 30},
+    {147, 1, 0},
+    {148, 0, 31},
+    {148, 1, 0},
+    {149, 0, 32},
+    {149, 2, 0},
+    {151, 0, 33},
+    {151, 1, 34},
+    {152, 0, 35},
+    {152, 1, 0},
+    {153, 0, 36},
+    {153, 1, 0},
+    {154, 0, 37},
+    {154, 1, 0},
+    {155, 0, 38},
+    {155, 1, 0},
+    {156, 0, 39},
+    {156, 1, 0},
+    {157, 0, 40},
+    {157, 1, 0},
+    {158, 0, 41},
+    {158, 1, 0},
+    {159, 2, 0},
+    {161, 0, 42},
+    {161, 0, 43},
+    {161, 1, 0},
+    {162, 1, 0},
+    {163, 1, 0},
+    {164, 1, 0},
+    {165, 1, 0},
+    {166, 1, 0},
+    {167, 1, 0},
+    {168, 0, 44},
+    {168, 1, 0},
+    {169, 1, 0},
+    {170, 0, 45},
+    {170, 3, 0},
+    {173, 0, 46},
+    {173, 1, 0},
+    {174, 0, 47},
+    {174, 1, 0},
+    {175, 1, 48},
+    {176, 0, 49},
+    {176, 1, 0},
+    {177, 0, 50},
+    {177, 2, 51},
+    {179, 1, 0},
+    {180, 0, 52},
+    {180, 4, 53},
+    {184, 1, 0},
+    {185, 0, 54},
+    {185, 1, 0},
+    {186, 0, 55},
+    {186, 1, 0},
+    {187, 0, 56},
+    {187, 1, 0},
+    {188, 0, 57},
+    {188, 4, 0},
+    {192, 1, 0},
+    {193, 0, 58},
+    {193, 1, 0},
+    {194, 1, 0},
+    {195, 1, 0},
+    {196, 1, 0},
+    {197, 1, 0},
+    {198, 1, 0},
+    {199, 0, 59},
+    {199, 2, 0},
+    {201, 1, 0},
+    {202, 1, 0},
+    {203, 1, 0},
+    {204, 1, 0},
+    {205, 1, 0},
+    {206, 0, 60},
+    {206, 1, 0},
+    {207, 1, 0},
+    {208, 1, 0},
+    {209, 1, 0},
+    {210, 1, 0},
+    {211, 0, 61},
+    {211, 1, 0},
+    {212, 1, 0},
+    {213, 0, 62},
+    {213, 2, 0},
+    {215, 1, 0},
+    {216, 1, 0},
+    {217, 1, 0},
+    {218, 1, 0},
+    {219, 1, 0},
+    {220, 1, 0},
+    {221, 1, 0},
+    {222, 1, 0},
+    {223, 1, 0},
+    {224, 0, 63},
+    {224, 1, 0},
+    {225, 1, 0},
+    {226, 1, 0},
+    {227, 1, 0},
+    {228, 1, 0},
+    {229, 1, 0},
+    {230, 1, 0},
+    {231, 0, 64},
+    {231, 5, 0},
+    {236, 1, 0},
+    {237, 0, 65},
+    {237, 1, 0},
+    {238, 0, 66},
+    {238, 1, 0},
+    {239, 0, 67},
+    {239, 1, 0},
+    {240, 0, 68},
+    {240, 1, 0},
+    {241, 0, 69},
+    {241, 1, 0},
+    {242, 1, 0},
+    {243, 1, 0},
+    {244, 1, 0},
+    {245, 0, 70},
+    {245, 2, 0},
+    {247, 1, 0},
+    {248, 1, 0},
+    {249, 1, 0},
+    {250, 1, 0},
+    {251, 1, 0},
+    {252, 1, 0},
+    {253, 0, 71},
+    {253, 1, 0},
+    {254, 1, 0},
+    {255, 1, 0},
+    {256, 1, 0},
+    {257, 1, 0},
+    {258, 1, 0},
+    {259, 0, 72},
+    {259, 1, 0},
+    {260, 1, 73},
+    {261, 0, 74},
+    {261, 1, 0},
+    {262, 0, 75},
+    {262, 1, 0},
+    {263, 1, 0},
+    {264, 1, 0},
+    {265, 1, 0},
+    {266, 1, 0},
+    {267, 1, 0},
+    {268, 1, 0},
+    {269, 1, 0},
+    {270, 1, 0},
+    {271, 1, 0},
+    {272, 1, 0},
+    {273, 0, 76},
+    {273, 4, 0},
+    {277, 6, 0},
+    {283, 0, 77},
+    {283, 0, 78},
+    {283, 0, 79},
+    {283, 0, 80},
+    {283, 0, 81},
+    {283, 0, 82},
+    {283, 5, 0},
+    {288, 0, 83},
+    {288, 0, 84},
+    {288, 0, 85},
+    {288, 0, 86},
+    {288, 0, 87},
+    {288, 1, 0},
+    {289, 0, 88},
+    {289, 2, 0},
+    {291, 0, 89},
+    {291, 0, 90},
+    {291, 1, 0},
+    {292, 1, 0},
+    {293, 1, 0},
+    {294, 1, 0},
+    {295, 1, 0},
+    {296, 1, 0},
+    {297, 1, 0},
+    {298, 0, 91},
+    {298, 1, 0},
+    {299, 2, 0},
+    {301, 1, 0},
+    {302, 1, 0},
+    {303, 1, 0},
+    {304, 1, 0},
+    {305, 0, 92},
+    {305, 1, 0},
+    {306, 1, 0},
+    {307, 2, 0},
+    {309, 1, 0},
+    {310, 0, 93},
+    {310, 1, 0},
+    {311, 0, 94},
+    {311, 1, 0},
+    {312, 1, 0},
+    {313, 0, 95},
+    {313, 1, 96},
+    {314, 2, 0},
+    {316, 0, 97},
+    {316, 0, 98},
+    {316, 16, 0},
+    {332, 1, 0},
+    {333, 1, 0},
+    {334, 0, 99},
+    {334, 5, 0},
+    {339, 1, 0},
+    {340, 0, 100},
+    {340, 2, 0},
+    {342, 0, 101},
+    {342, 0, 102},
+    {342, 1, 0},
+    {343, 0, 103},
+    {343, 1, 0},
+    {344, 0, 104},
+    {344, 1, 0},
+    {345, 0, 105},
+    {345, 5, 0},
+    {350, 1, 0},
+    {351, 1, 0},
+    {352, 0, 106},
+    {352, 1, 0},
+    {353, 1, 0},
+    {354, 0, 107},
+    {354, 1, 0},
+    {355, 1, 0},
+    {356, 0, 108},
+    {356, 1, 0},
+    {357, 1, 0},
+    {358, 0, 109},
+    {358, 2, 0},
+    {360, 0, 110},
+    {360, 0, 111},
+    {360, 1, 0},
+    {361, 1, 0},
+    {362, 0, 112},
+    {362, 1, 0},
+    {363, 1, 0},
+    {364, 0, 113},
+    {364, 1, 0},
+    {365, 1, 0},
+    {366, 0, 114},
+    {366, 1, 0},
+    {367, 1, 0},
+    {368, 0, 115},
+    {368, 2, 0},
+    {370, 1, 0},
+    {371, 1, 116},
+    {372, 1, 0},
+    {373, 1, 0},
+    {374, 1, 0},
+    {375, 1, 0},
+    {376, 1, 0},
+    {377, 1, 0},
+    {378, 0, 117},
+    {378, 2, 0},
+    {380, 1, 0},
+    {381, 0, 118},
+    {381, 1, 0},
+    {382, 0, 119},
+    {382, 1, 0},
+    {383, 1, 0},
+    {384, 0, 120},
+    {384, 3, 0},
+    {387, 10, 0},
+    {397, 0, 121},
+    {397, 0, 122},
+    {397, 0, 123},
+    {397, 0, 124},
+    {397, 0, 125},
+    {397, 0, 126},
+    {397, 0, 127},
+    {397, 0, 128},
+    {397, 0, 129},
+    {397, 0, 130},
+    {397, 7, 0},
+    {404, 0, 131},
+    {404, 0, 132},
+    {404, 0, 133},
+    {404, 0, 134},
+    {404, 0, 135},
+    {404, 0, 136},
+    {404, 0, 137},
+    {404, 2, 0},
+    {406, 0, 138},
+    {406, 0, 139},
+    {406, 1, 0},
+    {407, 1, 0},
+    {408, 2, 0},
+    {410, 1, 0},
+    {411, 0, 140},
+    {411, 0, 141},
+    {411, 1, 0},
+    {412, 1, 0},
+    {413, 1, 0},
+    {414, 0, 142},
+    {414, 1, 0},
+    {415, 1, 0},
+    {416, 1, 0},
+    {417, 1, 0},
+    {418, 1, 0},
+    {419, 1, 0},
+    {420, 1, 0},
+    {421, 0, 143},
+    {421, 1, 0},
+    {422, 1, 0},
+    {423, 0, 144},
+    {423, 1, 0},
+    {424, 1, 0},
+    {425, 0, 145},
+    {425, 4, 0},
+    {429, 1, 0},
+    {430, 1, 0},
+    {431, 0, 146},
+    {431, 2, 0},
+    {433, 1, 0},
+    {434, 0, 147},
+    {434, 1, 0},
+    {435, 1, 148},
+    {436, 1, 0},
+    {437, 0, 149},
+    {437, 2, 0},
+    {439, 1, 0},
+    {440, 0, 150},
+    {440, 1, 0},
+    {441, 0, 151},
+    {441, 1, 0},
+    {442, 1, 0},
+    {443, 0, 152},
+    {443, 11, 0},
+    {454, 1, 0},
+    {455, 1, 0},
+    {456, 1, 0},
+    {457, 1, 0},
+    {458, 1, 0},
+    {459, 1, 0},
+    {460, 1, 0},
+    {461, 0, 153},
+    {461, 1, 0},
+    {462, 1, 0},
+    {463, 1, 0},
+    {464, 1, 0},
+    {465, 1, 0},
+    {466, 1, 0},
+    {467, 0, 154},
+    {467, 2, 0},
+    {469, 1, 0},
+    {470, 1, 0},
+    {471, 1, 0},
+    {472, 0, 155},
+    {472, 1, 0},
+    {473, 0, 156},
+    {473, 1, 0},
+    {474, 1, 157},
+    {475, 0, 158},
+    {475, 1, 0},
+    {476, 1, 0},
+    {477, 0, 159},
+    {477, 1, 0},
+    {478, 1, 0},
+    {479, 4, 0},
+    {483, 0, 160},
+    {483, 0, 161},
+    {483, 0, 162},
+    {483, 0, 163},
+    {483, 1, 0},
+    {484, 1, 0},
+    {485, 2, 164},
+    {487, 1, 0},
+    {488, 1, 0},
+    {489, 0, 165},
+    {489, 1, 0},
+    {490, 0, 166},
+    {490, 1, 0},
+    {491, 2, 0},
+    {493, 0, 167},
+    {493, 0, 168},
+    {493, 1, 0},
+    {494, 1, 0},
+    {495, 0, 169},
+    {495, 1, 0},
+    {496, 1, 0},
+    {497, 1, 0},
+    {498, 1, 0},
+    {499, 1, 0},
+    {500, 1, 0},
+    {501, 0, 170},
+    {501, 2, 0},
+    {503, 1, 0},
+    {504, 1, 0},
+    {505, 1, 0},
+    {506, 0, 171},
+    {506, 1, 0},
+    {507, 1, 0},
+    {508, 1, 0},
+    {509, 1, 0},
+    {510, 1, 0},
+    {511, 0, 172},
+    {511, 7, 0},
+    {518, 1, 0},
+    {519, 1, 0},
+    {520, 0, 173},
+    {520, 2, 0},
+    {522, 1, 0},
+    {523, 0, 174},
+    {523, 1, 0},
+    {524, 1, 0},
+    {525, 0, 175},
+    {525, 1, 0},
+    {526, 1, 0},
+    {527, 0, 176},
+    {527, 1, 0},
+    {528, 2, 0},
+    {530, 0, 177},
+    {530, 0, 178},
+    {530, 5, 0},
+    {535, 1, 0},
+    {536, 0, 179},
+    {536, 1, 0},
+    {537, 0, 180},
+    {537, 0, 181},
+    {537, 1, 0},
+    {538, 0, 182},
+    {538, 1, 0},
+    {539, 0, 183},
+    {539, 0, 184},
+    {539, 3, 0},
+    {542, 1, 0},
+    {543, 1, 0},
+    {544, 0, 185},
+    {544, 3, 0},
+    {547, 1, 0},
+    {548, 0, 186},
+    {548, 1, 0},
+    {549, 1, 0},
+    {550, 0, 187},
+    {550, 1, 0},
+    {551, 1, 0},
+    {552, 0, 188},
+    {552, 1, 0},
+    {553, 1, 0},
+    {554, 1, 0},
+    {555, 1, 0},
+    {556, 1, 0},
+    {557, 1, 0},
+    {558, 1, 0},
+    {559, 1, 0},
+    {560, 1, 0},
+    {561, 6, 0},
+    {567, 1, 0},
+    {568, 0, 189},
+    {568, 1, 0},
+    {569, 0, 190},
+    {569, 1, 0},
+    {570, 0, 191},
+    {570, 1, 0},
+    {571, 0, 192},
+    {571, 1, 0},
+    {572, 0, 193},
+    {572, 1, 0},
+    {573, 0, 194},
+    {573, 4, 0},
+    {577, 1, 0},
+    {578, 0, 195},
+    {578, 1, 0},
+    {579, 1, 0},
+    {580, 0, 196},
+    {580, 2, 0},
+    {582, 1, 0},
+    {583, 0, 197},
+    {583, 1, 0},
+    {584, 0, 198},
+    {584, 1, 0},
+    {585, 2, 0},
+    {587, 0, 199},
+    {587, 0, 200},
+    {587, 1, 0},
+    {588, 1, 0},
+    {589, 1, 0},
+    {590, 1, 0},
+    {591, 0, 201},
+    {591, 1, 0},
+    {592, 1, 0},
+    {593, 1, 0},
+    {594, 11, 0},
+    {605, 1, 0},
+    {606, 1, 0},
+    {607, 1, 0},
+    {608, 0, 202},
+    {608, 1, 0},
+    {609, 1, 0},
+    {610, 1, 0},
+    {611, 0, 203},
+    {611, 1, 0},
+    {612, 1, 0},
+    {613, 1, 0},
+    {614, 0, 204},
+    {614, 1, 0},
+    {615, 1, 0},
+    {616, 1, 0},
+    {617, 0, 205},
+    {617, 1, 0},
+    {618, 1, 0},
+    {619, 1, 0},
+    {620, 0, 206},
+    {620, 1, 0},
+    {621, 1, 0},
+    {622, 1, 0},
+    {623, 0, 207},
+    {623, 1, 0},
+    {624, 1, 0},
+    {625, 1, 0},
+    {626, 0, 208},
+    {626, 1, 0},
+    {627, 1, 0},
+    {628, 2, 0},
+    {630, 0, 209},
+    {630, 0, 210},
+    {630, 1, 0},
+    {631, 1, 0},
+    {632, 1, 0},
+    {633, 0, 211},
+    {633, 1, 0},
+    {634, 1, 0},
+    {635, 1, 0},
+    {636, 0, 212},
+    {636, 1, 0},
+    {637, 5, 0},
+    {642, 0, 213},
+    {642, 0, 214},
+    {642, 0, 215},
+    {642, 0, 216},
+    {642, 0, 217},
+    {642, 1, 0},
+    {643, 1, 0},
+    {644, 2, 0},
+    {646, 5, 0},
+    {651, 2, 218},
+    {653, 2, 0},
+    {655, 1, 0},
+    {656, 1, 0},
+    {657, 1, 0},
+    {658, 1, 0},
+    {659, 1, 0},
+    {660, 0, 219},
+    {660, 1, 0},
+    {661, 1, 0},
+    {662, 2, 0},
+    {664, 1, 0},
+    {665, 0, 220},
+    {665, 1, 0},
+    {666, 1, 221},
+    {667, 0, 222},
+    {667, 1, 0},
+    {668, 1, 0},
+    {669, 1, 0},
+    {670, 1, 0},
+    {671, 1, 0},
+    {672, 1, 0},
+    {673, 0, 223},
+    {673, 1, 0},
+    {674, 1, 0},
+    {675, 1, 0},
+    {676, 3, 0},
+    {679, 0, 224},
+    {679, 0, 225},
+    {679, 0, 226},
+    {679, 2, 227},
+    {681, 2, 0},
+    {683, 1, 0},
+    {684, 1, 0},
+    {685, 0, 228},
+    {685, 1, 0},
+    {686, 1, 0},
+    {687, 0, 229},
+    {687, 1, 0},
+    {688, 1, 0},
+    {689, 1, 0},
+    {690, 0, 230},
+    {690, 0, 231},
+    {690, 1, 0},
+    {691, 2, 0},
+    {693, 0, 232},
+    {693, 0, 233},
+    {693, 2, 0},
+    {695, 1, 234},
+    {696, 1, 0},
+    {697, 0, 235},
+    {697, 2, 0},
+    {699, 2, 236},
+    {701, 1, 0},
+    {702, 1, 0},
+    {703, 1, 0},
+    {704, 1, 0},
+    {705, 1, 0},
+    {706, 1, 0},
+    {707, 1, 0},
+    {708, 1, 0},
+    {709, 1, 0},
+    {710, 0, 237},
+    {710, 1, 0},
+    {711, 1, 0},
+    {712, 1, 0},
+    {713, 1, 0},
+    {714, 1, 0},
+    {715, 1, 0},
+    {716, 1, 0},
+    {717, 1, 0},
+    {718, 1, 0},
+    {719, 0, 238},
+    {719, 1, 239},
+    {720, 1, 0},
+    {721, 1, 0},
+    {722, 1, 0},
+    {723, 1, 0},
+    {724, 1, 0},
+    {725, 1, 0},
+    {726, 1, 0},
+    {727, 1, 0},
+    {728, 1, 0},
+    {729, 0, 240},
+    {729, 1, 0},
+    {730, 1, 0},
+    {731, 1, 0},
+    {732, 1, 0},
+    {733, 1, 0},
+    {734, 1, 0},
+    {735, 0, 241},
+    {735, 2, 0},
+    {737, 1, 0},
+    {738, 1, 0},
+    {739, 1, 0},
+    {740, 1, 0},
+    {741, 1, 0},
+    {742, 0, 242},
+    {742, 1, 0},
+    {743, 1, 0},
+    {744, 1, 0},
+    {745, 1, 0},
+    {746, 1, 0},
+    {747, 0, 243},
+    {747, 1, 0},
+    {748, 1, 0},
+    {749, 1, 0},
+    {750, 2, 0},
+    {752, 1, 0},
+    {753, 1, 0},
+    {754, 0, 244},
+    {754, 1, 0},
+    {755, 1, 0},
+    {756, 0, 245},
+    {756, 2, 0},
+    {758, 1, 0},
+    {759, 1, 0},
+    {760, 1, 0},
+    {761, 1, 0},
+    {762, 1, 0},
+    {763, 1, 0},
+    {764, 1, 0},
+    {765, 0, 246},
+    {765, 2, 0},
+    {767, 1, 0},
+    {768, 1, 0},
+    {769, 1, 0},
+    {770, 0, 247},
+    {770, 1, 0},
+    {771, 1, 0},
+    {772, 0, 248},
+    {772, 1, 0},
+    {773, 1, 0},
+    {774, 1, 0},
+    {775, 1, 0},
+    {776, 1, 0},
+    {777, 1, 0},
+    {778, 0, 249},
+    {778, 0, 250},
+    {778, 1, 0},
+    {779, 1, 0},
+    {780, 2, 0},
+    {782, 1, 0},
+    {783, 1, 0},
+    {784, 0, 251},
+    {784, 1, 0},
+    {785, 1, 0},
+    {786, 1, 0},
+    {787, 0, 252},
+};
+
+static constexpr AIDTrieEdge AID_TRIE_EDGES[] = {
+    {0x31, 1},
+    {0x32, 15},
+    {0x44, 29},
+    {0xA0, 45},
+    {0xB0, 578},
+    {0xD0, 583},
+    {0xD2, 635},
+    {0xD4, 723},
+    {0xD5, 730},
+    {0xD7, 743},
+    {0xE8, 753},
+    {0xF0, 770},
+    {0x50, 2},
+    {0x41, 3},
+    {0x59, 4},
+    {0x2E, 5},
+    {0x53, 6},
+    {0x59, 7},
+    {0x53, 8},
+    {0x2E, 9},
+    {0x44, 10},
+    {0x44, 11},
+    {0x46, 12},
+    {0x30, 13},
+    {0x31, 14},
+    {0x50, 16},
+    {0x41, 17},
+    {0x59, 18},
+    {0x2E, 19},
+    {0x53, 20},
+    {0x59, 21},
+    {0x53, 22},
+    {0x2E, 23},
+    {0x44, 24},
+    {0x44, 25},
+    {0x46, 26},
+    {0x30, 27},
+    {0x31, 28},
+    {0x46, 30},
+    {0x4D, 31},
+    {0x46, 32},
+    {0x41, 33},
+    {0x2E, 34},
+    {0x44, 35},
+    {0x46, 36},
+    {0x61, 37},
+    {0x72, 38},
+    {0x65, 39},
+    {0x32, 40},
+    {0x34, 41},
+    {0x31, 42},
+    {0x30, 43},
+    {0x31, 44},
+    {0x00, 46},
+    {0x00, 47},
+    {0x00, 48},
+    {0x01, 303},
+    {0x02, 412},
+    {0x03, 431},
+    {0x04, 500},
+    {0x05, 528},
+    {0x06, 563},
+    {0x01, 49},
+    {0x03, 51},
+    {0x04, 91},
+    {0x05, 126},
+    {0x09, 130},
+    {0x10, 138},
+    {0x18, 141},
+    {0x24, 148},
+    {0x25, 150},
+    {0x29, 162},
+    {0x30, 188},
+    {0x42, 207},
+    {0x59, 218},
+    {0x63, 223},
+    {0x65, 238},
+    {0x69, 241},
+    {0x77, 243},
+    {0x79, 255},
+    {0x87, 274},
+    {0x88, 282},
+    {0x96, 296},
+    {0x98, 299},
+    {0x01, 50},
+    {0x00, 52},
+    {0x05, 58},
+    {0x10, 62},
+    {0x20, 66},
+    {0x30, 69},
+    {0x40, 71},
+    {0x50, 73},
+    {0x53, 75},
+    {0x60, 80},
+    {0x80, 83},
+    {0x90, 86},
+    {0x99, 88},
+    {0x00, 53},
+    {0x03, 55},
+    {0x00, 54},
+    {0x75, 56},
+    {0x61, 57},
+    {0x07, 59},
+    {0x60, 60},
+    {0x10, 61},
+    {0x10, 63},
+    {0x01, 64},
+    {0x02, 65},
+    {0x10, 67},
+    {0x20, 68},
+    {0x10, 70},
+    {0x10, 72},
+    {0x10, 74},
+    {0x44, 76},
+    {0x50, 78},
+    {0x41, 77},
+    {0x41, 79},
+    {0x10, 81},
+    {0x20, 82},
+    {0x02, 84},
+    {0x10, 85},
+    {0x10, 87},
+    {0x99, 89},
+    {0x10, 90},
+    {0x00, 92},
+    {0x01, 94},
+    {0x10, 95},
+    {0x20, 106},
+    {0x22, 108},
+    {0x30, 110},
+    {0x40, 114},
+    {0x50, 116},
+    {0x55, 118},
+    {0x60, 120},
+    {0x80, 122},
+    {0x99, 124},
+    {0x00, 93},
+    {0x10, 96},
+    {0x12, 97},
+    {0xBB, 100},
+    {0x13, 98},
+    {0x15, 99},
+    {0x54, 101},
+    {0x49, 102},
+    {0x43, 103},
+    {0x53, 104},
+    {0x01, 105},
+    {0x10, 107},
+    {0x03, 109},
+    {0x10, 111},
+    {0x60, 112},
+    {0x01, 113},
+    {0x10, 115},
+    {0x10, 117},
+    {0x55, 119},
+    {0x00, 121},
+    {0x02, 123},
+    {0x99, 125},
+    {0x00, 127},
+    {0x01, 128},
+    {0x02, 129},
+    {0x00, 131},
+    {0x01, 132},
+    {0xFF, 133},
+    {0x44, 134},
+    {0xFF, 135},
+    {0x12, 136},
+    {0x89, 137},
+    {0x10, 139},
+    {0x30, 140},
+    {0x00, 142},
+    {0x10, 143},
+    {0x43, 145},
+    {0x01, 144},
+    {0x4D, 146},
+    {0x00, 147},
+    {0x01, 149},
+    {0x00, 151},
+    {0x01, 153},
+    {0x00, 152},
+    {0x01, 154},
+    {0x04, 156},
+    {0x07, 158},
+    {0x08, 160},
+    {0x04, 155},
+    {0x02, 157},
+    {0x01, 159},
+    {0x01, 161},
+    {0x10, 163},
+    {0x45, 165},
+    {0x49, 172},
+    {0x56, 185},
+    {0x10, 164},
+    {0x08, 166},
+    {0x75, 167},
+    {0x10, 168},
+    {0x10, 169},
+    {0x00, 170},
+    {0x00, 171},
+    {0x03, 173},
+    {0x28, 179},
+    {0x40, 174},
+    {0x10, 175},
+    {0x10, 176},
+    {0x00, 177},
+    {0x01, 178},
+    {0x20, 180},
+    {0x10, 181},
+    {0x10, 182},
+    {0x00, 183},
+    {0x00, 184},
+    {0x41, 186},
+    {0x82, 187},
+    {0x29, 189},
+    {0x80, 199},
+    {0x05, 190},
+    {0x70, 191},
+    {0x00, 192},
+    {0xAD, 193},
+    {0x13, 194},
+    {0x10, 195},
+    {0x01, 196},
+    {0x01, 197},
+    {0xFF, 198},
+    {0x00, 200},
+    {0x00, 201},
+    {0x00, 202},
+    {0x00, 203},
+    {0x28, 204},
+    {0x01, 205},
+    {0x01, 206},
+    {0x10, 208},
+    {0x20, 210},
+    {0x30, 212},
+    {0x40, 214},
+    {0x50, 216},
+    {0x10, 209},
+    {0x10, 211},
+    {0x10, 213},
+    {0x10, 215},
+    {0x10, 217},
+    {0x45, 219},
+    {0x43, 220},
+    {0x01, 221},
+    {0x00, 222},
+    {0x50, 224},
+    {0x57, 231},
+    {0x4B, 225},
+    {0x43, 226},
+    {0x53, 227},
+    {0x2D, 228},
+    {0x31, 229},
+    {0x35, 230},
+    {0x41, 232},
+    {0x50, 233},
+    {0x2D, 234},
+    {0x57, 235},
+    {0x49, 236},
+    {0x4D, 237},
+    {0x10, 239},
+    {0x10, 240},
+    {0x00, 242},
+    {0x01, 244},
+    {0x00, 245},
+    {0x00, 246},
+    {0x02, 247},
+    {0x10, 248},
+    {0x00, 249},
+    {0x00, 250},
+    {0x00, 251},
+    {0x00, 252},
+    {0x00, 253},
+    {0x3B, 254},
+    {0x01, 256},
+    {0x02, 263},
+    {0x03, 269},
+    {0x12, 271},
+    {0x00, 257},
+    {0x01, 258},
+    {0x02, 259},
+    {0xF0, 260},
+    {0xF1, 261},
+    {0xF2, 262},
+    {0x00, 264},
+    {0x01, 265},
+    {0xFB, 266},
+    {0xFD, 267},
+    {0xFE, 268},
+    {0x00, 270},
+    {0x01, 272},
+    {0x02, 273},
+    {0x10, 275},
+    {0x02, 276},
+    {0xFF, 277},
+    {0x49, 278},
+    {0xFF, 279},
+    {0x05, 280},
+    {0x89, 281},
+    {0x10, 283},
+    {0x20, 284},
+    {0x22, 289},
+    {0x01, 285},
+    {0x05, 286},
+    {0xC1, 287},
+    {0x00, 288},
+    {0x01, 290},
+    {0x03, 291},
+    {0x42, 292},
+    {0x43, 294},
+    {0x21, 293},
+    {0x21, 295},
+    {0x02, 297},
+    {0x00, 298},
+    {0x08, 300},
+    {0x40, 301},
+    {0x48, 302},
+    {0x11, 304},
+    {0x16, 307},
+    {0x18, 319},
+    {0x21, 335},
+    {0x32, 338},
+    {0x40, 341},
+    {0x41, 344},
+    {0x51, 347},
+    {0x52, 357},
+    {0x54, 362},
+    {0x57, 365},
+    {0x67, 388},
+    {0x72, 394},
+    {0x77, 398},
+    {0x85, 406},
+    {0x88, 409},
+    {0x01, 305},
+    {0x01, 306},
+    {0x03, 308},
+    {0x60, 310},
+    {0x90, 313},
+    {0xA0, 315},
+    {0xDB, 317},
+    {0x00, 309},
+    {0x10, 311},
+    {0x30, 312},
+    {0x00, 314},
+    {0x01, 316},
+    {0x00, 318},
+    {0x01, 320},
+    {0x02, 323},
+    {0x03, 326},
+    {0x04, 329},
+    {0x45, 332},
+    {0x00, 321},
+    {0x00, 322},
+    {0x00, 324},
+    {0x00, 325},
+    {0x00, 327},
+    {0x00, 328},
+    {0x00, 330},
+    {0x00, 331},
+    {0x43, 333},
+    {0x4E, 334},
+    {0x10, 336},
+    {0x10, 337},
+    {0x00, 339},
+    {0x01, 340},
+    {0x80, 342},
+    {0x01, 343},
+    {0x00, 345},
+    {0x01, 346},
+    {0x00, 348},
+    {0x53, 350},
+    {0x00, 349},
+    {0x00, 777},
+    {0x50, 351},
+    {0x43, 352},
+    {0x41, 353},
+    {0x53, 354},
+    {0x44, 355},
+    {0x00, 356},
+    {0x30, 358},
+    {0x40, 360},
+    {0x10, 359},
+    {0x10, 361},
+    {0x44, 363},
+    {0x42, 364},
+    {0x00, 366},
+    {0x01, 377},
+    {0x44, 385},
+    {0x10, 367},
+    {0x20, 368},
+    {0x21, 369},
+    {0x22, 370},
+    {0x23, 371},
+    {0x30, 372},
+    {0x31, 373},
+    {0x40, 374},
+    {0x50, 375},
+    {0x51, 376},
+    {0x00, 378},
+    {0x04, 379},
+    {0x09, 380},
+    {0x0A, 381},
+    {0x0B, 382},
+    {0x0C, 383},
+    {0x0D, 384},
+    {0x43, 386},
+    {0x44, 387},
+    {0x41, 389},
+    {0x30, 390},
+    {0x00, 391},
+    {0x01, 393},
+    {0xFF, 392},
+    {0x95, 395},
+    {0x00, 396},
+    {0x01, 397},
+    {0x50, 399},
+    {0x4B, 400},
+    {0x43, 401},
+    {0x53, 402},
+    {0x2D, 403},
+    {0x31, 404},
+    {0x35, 405},
+    {0x00, 407},
+    {0x02, 408},
+    {0x44, 410},
+    {0x43, 411},
+    {0x04, 413},
+    {0x28, 416},
+    {0x47, 423},
+    {0x77, 428},
+    {0x00, 414},
+    {0x00, 415},
+    {0x10, 417},
+    {0x20, 419},
+    {0x10, 418},
+    {0x10, 420},
+    {0x10, 421},
+    {0x10, 422},
+    {0x10, 424},
+    {0x20, 426},
+    {0x01, 425},
+    {0x01, 427},
+    {0x10, 429},
+    {0x10, 430},
+    {0x06, 432},
+    {0x08, 440},
+    {0x15, 447},
+    {0x23, 454},
+    {0x24, 457},
+    {0x33, 460},
+    {0x59, 467},
+    {0x66, 475},
+    {0x71, 479},
+    {0x96, 482},
+    {0x97, 489},
+    {0x00, 433},
+    {0x00, 434},
+    {0x00, 435},
+    {0x00, 436},
+    {0x00, 437},
+    {0x00, 438},
+    {0x00, 439},
+    {0x00, 441},
+    {0x00, 442},
+    {0x10, 443},
+    {0x00, 444},
+    {0x01, 445},
+    {0x00, 446},
+    {0x10, 448},
+    {0x60, 452},
+    {0x10, 449},
+    {0x05, 450},
+    {0x28, 451},
+    {0x20, 453},
+    {0x01, 455},
+    {0x01, 456},
+    {0x10, 458},
+    {0x10, 459},
+    {0x01, 461},
+    {0x01, 462},
+    {0x01, 463},
+    {0x02, 464},
+    {0x03, 465},
+    {0x06, 466},
+    {0x10, 468},
+    {0x10, 469},
+    {0x02, 470},
+    {0x03, 473},
+    {0x80, 471},
+    {0x01, 472},
+    {0x80, 474},
+    {0x00, 476},
+    {0x01, 477},
+    {0x02, 478},
+    {0x00, 480},
+    {0x01, 481},
+    {0x4D, 483},
+    {0x66, 484},
+    {0x34, 485},
+    {0x4D, 486},
+    {0x00, 487},
+    {0x02, 488},
+    {0x42, 490},
+    {0x43, 494},
+    {0x54, 491},
+    {0x46, 492},
+    {0x59, 493},
+    {0x49, 495},
+    {0x44, 496},
+    {0x5F, 497},
+    {0x01, 498},
+    {0x00, 499},
+    {0x27, 501},
+    {0x32, 504},
+    {0x36, 507},
+    {0x39, 510},
+    {0x54, 513},
+    {0x76, 517},
+    {0x85, 527},
+    {0x10, 502},
+    {0x10, 503},
+    {0x00, 505},
+    {0x55, 778},
+    {0x01, 506},
+    {0x01, 508},
+    {0x00, 509},
+    {0x10, 511},
+    {0x10, 512},
+    {0x00, 514},
+    {0x10, 515},
+    {0x11, 516},
+    {0x20, 518},
+    {0x30, 520},
+    {0x6C, 522},
+    {0xA0, 523},
+    {0xA1, 525},
+    {0x10, 519},
+    {0x30, 521},
+    {0x10, 524},
+    {0x10, 526},
+    {0x24, 529},
+    {0x27, 532},
+    {0x59, 541},
+    {0x10, 530},
+    {0x10, 531},
+    {0x10, 533},
+    {0x20, 535},
+    {0x21, 538},
+    {0x02, 534},
+    {0x01, 536},
+    {0x01, 537},
+    {0x01, 539},
+    {0x01, 540},
+    {0x10, 542},
+    {0x10, 543},
+    {0xFF, 544},
+    {0xFF, 545},
+    {0xFF, 546},
+    {0xFF, 547},
+    {0x89, 548},
+    {0x00, 549},
+    {0x00, 550},
+    {0x01, 551},
+    {0x02, 553},
+    {0x0D, 555},
+    {0x0E, 557},
+    {0x0F, 559},
+    {0x10, 561},
+    {0x00, 552},
+    {0x00, 554},
+    {0x00, 556},
+    {0x00, 558},
+    {0x00, 560},
+    {0x00, 562},
+    {0x17, 564},
+    {0x20, 566},
+    {0x58, 569},
+    {0x72, 574},
+    {0x00, 565},
+    {0x06, 567},
+    {0x20, 568},
+    {0x10, 570},
+    {0x20, 572},
+    {0x10, 571},
+    {0x10, 573},
+    {0x30, 575},
+    {0x10, 576},
+    {0x20, 577},
+    {0x12, 579},
+    {0x34, 580},
+    {0x56, 581},
+    {0x78, 582},
+    {0x40, 584},
+    {0x00, 585},
+    {0x00, 586},
+    {0x01, 587},
+    {0x02, 591},
+    {0x03, 595},
+    {0x04, 599},
+    {0x0B, 603},
+    {0x0C, 607},
+    {0x0D, 611},
+    {0x13, 615},
+    {0x14, 620},
+    {0x15, 624},
+    {0x19, 628},
+    {0x00, 588},
+    {0x00, 589},
+    {0x02, 590},
+    {0x00, 592},
+    {0x00, 593},
+    {0x02, 594},
+    {0x00, 596},
+    {0x00, 597},
+    {0x02, 598},
+    {0x00, 600},
+    {0x00, 601},
+    {0x02, 602},
+    {0x00, 604},
+    {0x00, 605},
+    {0x02, 606},
+    {0x00, 608},
+    {0x00, 609},
+    {0x02, 610},
+    {0x00, 612},
+    {0x00, 613},
+    {0x02, 614},
+    {0x00, 616},
+    {0x00, 617},
+    {0x01, 618},
+    {0x02, 619},
+    {0x00, 621},
+    {0x00, 622},
+    {0x01, 623},
+    {0x00, 625},
+    {0x00, 626},
+    {0x01, 627},
+    {0x00, 629},
+    {0x01, 630},
+    {0x02, 631},
+    {0x03, 632},
+    {0x04, 633},
+    {0x10, 634},
+    {0x76, 636},
+    {0x00, 637},
+    {0x00, 638},
+    {0x01, 686},
+    {0x05, 639},
+    {0x22, 662},
+    {0x25, 669},
+    {0x60, 681},
+    {0x85, 682},
+    {0xAA, 640},
+    {0xAB, 655},
+    {0x04, 641},
+    {0x05, 647},
+    {0x03, 642},
+    {0x60, 643},
+    {0x01, 644},
+    {0x04, 645},
+    {0x10, 646},
+    {0x03, 648},
+    {0xE0, 649},
+    {0x04, 650},
+    {0x05, 652},
+    {0x01, 651},
+    {0x01, 653},
+    {0x01, 654},
+    {0x05, 656},
+    {0x03, 657},
+    {0xE0, 658},
+    {0x04, 659},
+    {0x01, 660},
+    {0x01, 661},
+    {0x00, 663},
+    {0x00, 664},
+    {0x00, 665},
+    {0x01, 666},
+    {0x02, 667},
+    {0x60, 668},
+    {0x45, 670},
+    {0x47, 677},
+    {0x41, 671},
+    {0x50, 674},
+    {0x01, 672},
+    {0x00, 673},
+    {0x01, 675},
+    {0x00, 676},
+    {0x41, 678},
+    {0x01, 679},
+    {0x00, 680},
+    {0x01, 683},
+    {0x00, 684},
+    {0x01, 685},
+    {0x18, 687},
+    {0x24, 690},
+    {0x01, 688},
+    {0x01, 689},
+    {0x01, 691},
+    {0x02, 712},
+    {0x01, 692},
+    {0x02, 702},
+    {0x01, 693},
+    {0xFF, 694},
+    {0xFF, 695},
+    {0x00, 696},
+    {0x00, 697},
+    {0x00, 698},
+    {0x01, 699},
+    {0x00, 700},
+    {0x00, 701},
+    {0x00, 703},
+    {0x00, 704},
+    {0x00, 705},
+    {0x00, 706},
+    {0x00, 707},
+    {0x00, 708},
+    {0x01, 709},
+    {0x00, 710},
+    {0x00, 711},
+    {0x00, 713},
+    {0x01, 714},
+    {0x00, 715},
+    {0x00, 716},
+    {0x00, 717},
+    {0x00, 718},
+    {0x00, 719},
+    {0x00, 720},
+    {0x00, 721},
+    {0x00, 722},
+    {0x10, 724},
+    {0x00, 725},
+    {0x00, 726},
+    {0x01, 727},
+    {0x10, 728},
+    {0x10, 729},
+    {0x28, 731},
+    {0x78, 737},
+    {0x00, 732},
+    {0x50, 733},
+    {0x21, 734},
+    {0x80, 735},
+    {0x02, 736},
+    {0x00, 738},
+    {0x00, 739},
+    {0x02, 740},
+    {0x10, 741},
+    {0x10, 742},
+    {0x56, 744},
+    {0x00, 745},
+    {0x00, 746},
+    {0x01, 747},
+    {0x30, 750},
+    {0x01, 748},
+    {0x01, 749},
+    {0x01, 751},
+    {0x01, 752},
+    {0x07, 754},
+    {0x28, 762},
+    {0x04, 755},
+    {0x00, 756},
+    {0x7F, 757},
+    {0x00, 758},
+    {0x07, 759},
+    {0x03, 760},
+    {0x02, 761},
+    {0x81, 763},
+    {0xBD, 767},
+    {0xC1, 764},
+    {0x17, 765},
+    {0x02, 766},
+    {0x08, 768},
+    {0x0F, 769},
+    {0x00, 771},
+    {0x00, 772},
+    {0x00, 773},
+    {0x03, 774},
+    {0x00, 775},
+    {0x01, 776},
+    {0x45, 779},
+    {0x43, 780},
+    {0x49, 781},
+    {0x53, 784},
+    {0x53, 782},
+    {0x44, 783},
+    {0x53, 785},
+    {0x44, 786},
+    {0x31, 787},
+};
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file atrdatabase.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Compiled ATR identification database.
+ *
+ * Source is a text list in "smartcard_list.txt" format: ATR pattern line
+ * (hex bytes, "." matches any nibble) followed by one or more description
+ * lines starting with a TAB.
+ *
+ * Binary format (all integers are little-endian uint32):
+ *
+ *   magic "XATRDB\0\1"
+ *   entries count
+ *   strings section offset
+ *   35 bucket indexes: entries with ATR length L are [bucket[L], bucket[L+1])
+ *   entries, ENTRY_SIZE bytes each: pattern[33], mask[33], length, reserved, name offset
+ *   strings section: NUL-terminated descriptions
+ *
+ * Entries in every bucket are sorted by number of fixed bits, most specific
+ * first, so the first matched entry is the best match.
+ */
+
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include "../include/xpcsc.hpp"
+#include "mapped_file.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte ATRDB_MAGIC[8] = {'X', 'A', 'T', 'R', 'D', 'B', 0, 1};
+static const size_t ATRDB_MAX_ATR = 33;
+static const size_t ATRDB_BUCKETS = ATRDB_MAX_ATR + 2;
+static const size_t HEADER_SIZE = 8 + 4 + 4 + ATRDB_BUCKETS*4;
+static const size_t ENTRY_SIZE = ATRDB_MAX_ATR*2 + 2 + 4;
+
+struct ATRDatabase::Private
+{
+    MappedFile file;
+
+    const Byte * buckets;
+    const Byte * entries;
+    const char * strings;
+    size_t count;
+};
+
+ATRDatabase::ATRDatabase()
+{
+    p = new Private;
+    p->count = 0;
+}
+
+ATRDatabase::~ATRDatabase()
+{
+    delete p;
+}
+
+void ATRDatabase::open(const std::string & path)
+{
+    p->count = 0;
+
+    if (!p->file.open(path)) {
+        throw ATRDatabaseError("Cannot open ATR database file");
+    }
+
+    const Byte * data = p->file.data();
+    size_t size = p->file.size();
+
+    if (size < HEADER_SIZE || memcmp(data, ATRDB_MAGIC, sizeof(ATRDB_MAGIC)) != 0) {
+        p->file.close();
+        throw ATRDatabaseError("Not an ATR database file");
+    }
+
+    size_t count = read_le32(data + 8);
+    size_t strings_offset = read_le32(data + 12);
+
+    if (strings_offset != HEADER_SIZE + count*ENTRY_SIZE || strings_offset > size
+        || read_le32(data + 16 + (ATRDB_BUCKETS-1)*4) != count)
+    {
+        p->file.close();
+        throw ATRDatabaseError("Corrupted ATR database file");
+    }
+
+    // the last string must be terminated, so lookups never run out of mapping
+    if (count > 0 && data[size-1] != 0) {
+        p->file.close();
+        throw ATRDatabaseError("Corrupted ATR database file");
+    }
+
+    // bucket ranges and name offsets are used by match() without checks
+    size_t previous = 0;
+    for (size_t i = 0; i < ATRDB_BUCKETS; i++) {
+        size_t bucket = read_le32(data + 16 + i*4);
+        if (bucket < previous || bucket > count) {
+            p->file.close();
+            throw ATRDatabaseError("Corrupted ATR database file");
+        }
+        previous = bucket;
+    }
+    size_t strings_size = size - strings_offset;
+    for (size_t i = 0; i < count; i++) {
+        if (read_le32(data + HEADER_SIZE + i*ENTRY_SIZE + ATRDB_MAX_ATR*2 + 2) >= strings_size) {
+            p->file.close();
+            throw ATRDatabaseError("Corrupted ATR database file");
+        }
+    }
+
+    p->buckets = data + 16;
+    p->entries = data + HEADER_SIZE;
+    p->strings = reinterpret_cast<const char *>(data + strings_offset);
+    p->count = count;
+
+    PRINT_DEBUG("[D] ATR database loaded, entries: " << count);
+}
+
+size_t ATRDatabase::size() const
+{
+    return p->count;
+}
+
+const char * ATRDatabase::match(const Bytes & atr) const
+{
+    size_t length = atr.size();
+    if (p->count == 0 || length > ATRDB_MAX_ATR) {
+        return 0;
+    }
+
+    size_t first = read_le32(p->buckets + length*4);
+    size_t last = read_le32(p->buckets + (length+1)*4);
+    const Byte * a = atr.data();
+
+    for (size_t i = first; i < last; i++) {
+        const Byte * e = p->entries + i*ENTRY_SIZE;
+        const Byte * pattern = e;
+        const Byte * mask = e + ATRDB_MAX_ATR;
+        size_t j = 0;
+
+        while (j < length && (a[j] & mask[j]) == pattern[j]) {
+            j++;
+        }
+        if (j == length) {
+            return p->strings + read_le32(e + ATRDB_MAX_ATR*2 + 2);
+        }
+    }
+
+    return 0;
+}
+
+
+struct ATRPattern
+{
+    Byte pattern[ATRDB_MAX_ATR];
+    Byte mask[ATRDB_MAX_ATR];
+    size_t length;
+    size_t fixed_bits;
+    size_t order;
+    std::string name;
+};
+
+static bool comparePatterns(const ATRPattern & a, const ATRPattern & b)
+{
+    if (a.length != b.length) {
+        return a.length < b.length;
+    }
+    if (a.fixed_bits != b.fixed_bits) {
+        return a.fixed_bits > b.fixed_bits;
+    }
+    return a.order < b.order;
+}
+
+static bool nibble(char c, Byte & value, Byte & mask)
+{
+    if (c == '.') {
+        value = 0;
+        mask = 0;
+        return true;
+    }
+    mask = 0xf;
+    if (c >= '0' && c <= '9') {
+        value = c - '0';
+        return true;
+    }
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') {
+        value = c - 'a' + 10;
+        return true;
+    }
+    return false;
+}
+
+// parses pattern line like "3B 8F 80 01 .. 4F"
+static bool parsePattern(const std::string & line, ATRPattern & pt)
+{
+    pt.length = 0;
+    pt.fixed_bits = 0;
+
+    size_t i = 0;
+    size_t size = line.size();
+
+    while (i < size) {
+        if (line[i] == ' ' || line[i] == '\r') {
+            i++;
+            continue;
+        }
+        if (i+1 >= size || pt.length == ATRDB_MAX_ATR) {
+            return false;
+        }
+
+        Byte hv, hm, lv, lm;
+        if (!nibble(line[i], hv, hm) || !nibble(line[i+1], lv, lm)) {
+            // regular expressions other than "." are not supported
+            return false;
+        }
+        pt.pattern[pt.length] = (hv << 4) | lv;
+        pt.mask[pt.length] = (hm << 4) | lm;
+        pt.fixed_bits += (hm ? 4 : 0) + (lm ? 4 : 0);
+        pt.length++;
+        i += 2;
+    }
+
+    return pt.length >= 2;
+}
+
+size_t ATRDatabase::compile(std::istream & source, std::ostream & target)
+{
+    std::vector<ATRPattern> patterns;
+    // patterns waiting for description
+    size_t pending = 0;
+    bool pending_described = false;
+    std::string line;
+
+    while (std::getline(source, line)) {
+        if (line.length() == 0 || line.at(0) == '#') {
+            continue;
+        }
+
+        if (line.at(0) == '\t' || line.at(0) == ' ') {
+            // description line
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos) {
+                continue;
+            }
+            std::string text = line.substr(start);
+            for (size_t i = patterns.size() - pending; i < patterns.size(); i++) {
+                if (!patterns[i].name.empty()) {
+                    patterns[i].name.append("; ");
+                }
+                patterns[i].name.append(text);
+            }
+            pending_described = true;
+            continue;
+        }
+
+        if (pending_described) {
+            pending = 0;
+            pending_described = false;
+        }
+
+        ATRPattern pt;
+        if (!parsePattern(line, pt)) {
+            PRINT_DEBUG("[D] Unsupported ATR pattern skipped: " << line);
+            continue;
+        }
+        pt.order = patterns.size();
+        patterns.push_back(pt);
+        pending++;
+    }
+
+    std::stable_sort(patterns.begin(), patterns.end(), comparePatterns);
+
+    size_t count = patterns.size();
+    Bytes header(HEADER_SIZE, 0);
+    Bytes entries(count*ENTRY_SIZE, 0);
+    std::string strings;
+
+    memcpy(&header[0], ATRDB_MAGIC, sizeof(ATRDB_MAGIC));
+    write_le32(&header[8], count);
+    write_le32(&header[12], HEADER_SIZE + count*ENTRY_SIZE);
+
+    size_t bucket = 0;
+    for (size_t i = 0; i < count; i++) {
+        const ATRPattern & pt = patterns[i];
+        while (bucket <= pt.length) {
+            write_le32(&header[16 + bucket*4], i);
+            bucket++;
+        }
+
+        Byte * e = &entries[i*ENTRY_SIZE];
+        memcpy(e, pt.pattern, pt.length);
+        memcpy(e + ATRDB_MAX_ATR, pt.mask, pt.length);
+        e[ATRDB_MAX_ATR*2] = pt.length;
+        write_le32(e + ATRDB_MAX_ATR*2 + 2, strings.size());
+        strings.append(pt.name);
+        strings.push_back('\0');
+    }
+    while (bucket < ATRDB_BUCKETS) {
+        write_le32(&header[16 + bucket*4], count);
+        bucket++;
+    }
+
+    target.write(reinterpret_cast<const char *>(header.data()), header.size());
+    target.write(reinterpret_cast<const char *>(entries.data()), entries.size());
+    target.write(strings.data(), strings.size());
+
+    if (!target) {
+        throw ATRDatabaseError("Failed to write ATR database");
+    }
+
+    return count;
+}
+
+}
@@ -34,7 +34,10 @@
 #include <stdexcept>
 #include <sstream>
 #include <map>
-#include <set>
+#include <list>
+#include <mutex>
+#include <cstring>
+#include <cstdio>
 
 
 #include "../include/xpcsc.hpp"
@@ -51,32 +54,54 @@ namespace xpcsc {
 // check bit: 1,2,...
 #define CHECK_BIT(value, b) (((value) >> (b))&1)
 
-typedef enum {ATRNONE, TS, T0, TA1, TB1, TC1, TD1, 
-    TA2, TB2, TC2, TD2, 
-    TA3, TB3, TC3, TD3,
-    TA4, TB4, TC4, TD4,
-    TA5, TB5, TC5, TD5,
-    TA6, TB6, TC6, TD6,
-    TA7, TB7, TC7, TD7,
-    TCK } ATRField;
+// interface byte presence, i=1..7
+#define HAS_BYTE(present, i) CHECK_BIT(present, i)
 
-struct ATRParser::Private
+/*
+ * Everything load() extracts from ATR bytes
+ */
+struct ATRParsed
 {
-    Bytes atr;
+    ATRInfo info;
+    ATRClassification classification;
+};
 
-    // common fields (like interface bytes)
-    std::map<ATRField, Byte> fields;
+struct ATRParser::Private : public ATRParsed
+{
+    Bytes atr;
+};
 
-    // historical bytes
-    Byte hb[15];
-    size_t hb_size;
-    std::set<ATRFeature> features;
+/*
+ * Process-wide LRU cache of parsed ATRs. Usually only a few card types
+ * are used with one terminal so repeated ATRs are not parsed at all.
+ */
+struct ATRCacheEntry
+{
+    ATRParsed parsed;
+    std::list<Bytes>::iterator lru_pos;
 };
 
+static const size_t ATR_CACHE_SIZE = 64;
+
+static std::mutex atr_cache_mutex;
+// most recently used ATR goes first
+static std::list<Bytes> atr_cache_lru;
+static std::map<Bytes, ATRCacheEntry> atr_cache;
+
+static bool lookupATRCache(const Bytes &, ATRParsed *);
+static void storeATRCache(const Bytes &, const ATRParsed *);
+static void decodeInfo(ATRInfo &, const Bytes &);
+static void classify(ATRParsed *);
+
 static void initRIDMap();
 static std::string decodeRID(const Bytes &);
 static std::string decodeCardName(const Bytes &, const Bytes &);
 
+// TA1/TA2 decoding tables, see ISO 7816-3, section "8.3 Global interface bytes"
+static const float f_max_table[] = {4, 5, 6, 8, 12, 16, 20, -1, -1, 5, 7.5, 10, 15, 20, 0, 0};
+static const int Fi_table[] = {372, 372, 558, 744, 1116, 1488, 1860, -1, -1, 512, 768, 1024,   1536,   2048, -1, -1};
+static const int Di_table[] = {-1, 1, 2, 4, 8, 16, 32, 64, 12, 20, -1, -1, -1, -1, -1, -1};
+
 ATRParser::ATRParser()
 {
     p = new Private;
@@ -108,7 +133,13 @@ void ATRParser::load(const Bytes & bytes)
     }
 
     p->atr.assign(bytes);
-    p->fields.clear();
+
+    if (lookupATRCache(bytes, p)) {
+        return;
+    }
+
+    ATRInfo & info = p->info;
+    memset(&info, 0, sizeof(info));
 
     Byte pos = 0;
     Byte b;
@@ -118,25 +149,19 @@ void ATRParser::load(const Bytes & bytes)
     if (b != 0x3b && b != 0x3f) {
         throw ATRParseError("Invalid TS");
     }
-    p->fields[TS] = b;
+    info.ts = b;
     pos++;
 
     // byte: T0
     b = bytes.at(pos);
-    p->fields[T0] = b;
+    info.t0 = b;
 
     // historical bytes, up to 15
-    p->hb_size = LN(b); 
+    info.historical_bytes_size = LN(b); 
 
     // read next sections
     Byte TD_p = b;
 
-    // all section keys
-    ATRField sections_TA[] = {ATRNONE, TA1, TA2, TA3, TA4, TA5, TA6, TA7};
-    ATRField sections_TB[] = {ATRNONE, TB1, TB2, TB3, TB4, TB5, TB6, TB7};
-    ATRField sections_TC[] = {ATRNONE, TC1, TC2, TC3, TC4, TC5, TC6, TC7};
-    ATRField sections_TD[] = {ATRNONE, TD1, TD2, TD3, TD4, TD5, TD6, TD7};
-
     // index of current section
     size_t i = 1;
 
@@ -148,29 +173,30 @@ void ATRParser::load(const Bytes & bytes)
         if (CHECK_BIT(TD_p, 4)) {
             // next byte is TAi, remember it
             pos++;
-            b = bytes.at(pos);
-            p->fields[sections_TA[i]] = b;
+            info.ta[i] = bytes.at(pos);
+            info.ta_present |= 1 << i;
         }
         // check presense of TBi
         if (CHECK_BIT(TD_p, 5)) {
             // next byte is TBi, remember it
             pos++;
-            b = bytes.at(pos);
-            p->fields[sections_TB[i]] = b;
+            info.tb[i] = bytes.at(pos);
+            info.tb_present |= 1 << i;
         }
         // check presense of TCi
         if (CHECK_BIT(TD_p, 6)) {
             // next byte is TCi, remember it
             pos++;
-            b = bytes.at(pos);
-            p->fields[sections_TC[i]] = b;
+            info.tc[i] = bytes.at(pos);
+            info.tc_present |= 1 << i;
         }
         // check presense of TDi
         if (CHECK_BIT(TD_p, 7)) {
             // next byte is TCi, remember it
             pos++;
             b = bytes.at(pos);
-            p->fields[sections_TD[i]] = b;
+            info.td[i] = b;
+            info.td_present |= 1 << i;
             PRINT_DEBUG("[D] TD" << i << " is set");
             TD_p = b;
         } else {
@@ -181,31 +207,57 @@ void ATRParser::load(const Bytes & bytes)
         i++;
     }
 
-    if (pos > size - p->hb_size - 1) {
-        // PRINT_DEBUG("[E] position " << int(pos));
-        // PRINT_DEBUG("[E] HB size " << int(p->hb_size));
-        // PRINT_DEBUG("[E] size " << int(size));
+    if (pos > size - info.historical_bytes_size - 1) {
         throw ATRParseError("too short, no place for historical bytes");
     }
 
     // store historical bytes
-    for (i=0; i<p->hb_size; i++) {
+    for (i=0; i<info.historical_bytes_size; i++) {
         pos++;
-        b = bytes.at(pos);
-        (p->hb)[i] = b;
+        info.historical_bytes[i] = bytes.at(pos);
     }
 
     // check final checksum byte
     if (pos == size-2) {
         // read TCK byte
         pos++;
-        b = bytes.at(pos);
-        p->fields[TCK] = b;
+        info.has_tck = true;
+        info.tck = bytes.at(pos);
     } else if (pos >= size) {
         throw ATRParseError("Incorrect ATR structure: actual size don't match calculated");
     }
-    // PRINT_DEBUG("[E] position " << int(pos));
-    // PRINT_DEBUG("[E] size " << int(size));
+
+    decodeInfo(info, bytes);
+    classify(p);
+    storeATRCache(bytes, p);
+}
+
+const ATRInfo & ATRParser::info() const
+{
+    if (p->atr.size() == 0) {
+        throw ATRParseError("No ATR");
+    }
+
+    return p->info;
+}
+
+static void formatProtocol(std::stringstream & ss, Byte td)
+{
+    switch (LN(td)) {
+    case 1:
+        ss << ", protocol T=1";
+        break;
+    case 0:
+        ss << ", protocol T=0";
+        break;
+    }
+}
+
+static void formatClock(std::stringstream & ss, const char * name, Byte ta)
+{
+    ss << "  " << name << "=" << format(ta) << ": ";
+    ss << "f_max=" << f_max_table[HN(ta)] << ", Fi=" << Fi_table[HN(ta)] << ", Di=" << Di_table[LN(ta)];
+    ss << '\n';
 }
 
 std::string ATRParser::str() const
@@ -214,205 +266,134 @@ std::string ATRParser::str() const
         throw ATRParseError("No ATR");
     }
 
+    const ATRInfo & info = p->info;
     std::stringstream ss;
-    std::stringstream sd;
-    std::map<ATRField, Byte>::const_iterator end = p->fields.end();
-    Byte b;
-
-    PRINT_DEBUG("[D] Parsed fields: " << p->fields.size());
 
-    // try to detect PICC, see section 3.1.3.2.3.1 of PC/SC specification
-    bool is_picc = false;
-    if (p->fields[TS] == 0x3b && HN(p->fields[T0]) == 0x8 
-        && p->fields[TD1] == 0x80 && p->fields[TD2] == 0x01)
-    {
+    if (info.is_picc) {
         ss << "  Proximity card detected.";
         ss << '\n';
-        is_picc = true;
     }
 
-    b = p->fields[TS];
     ss << "  Format byte TS=";
-    switch (b) {
-    case 0x3b:
-        ss << "3B: direct convention";
-        break;
-    case 0x3f:
+    if (info.inverse_convention) {
         ss << "3F: inverse convention";
-        break;
+    } else {
+        ss << "3B: direct convention";
     }
     ss << '\n';
 
-    if (p->fields.find(TD1) != end) {
-        b = p->fields[TD1];
-        ss << "  TD1=" << format(b);
-        switch (LN(b)) {
-        case 1:
-            ss << ", protocol T=1";
-            break;
-        case 0:
-            ss << ", protocol T=0";
-            break;
-        }
+    if (HAS_BYTE(info.td_present, 1)) {
+        ss << "  TD1=" << format(info.td[1]);
+        formatProtocol(ss, info.td[1]);
     } else {
         // see ISO 7816-3, section "8.2.3 Interface bytes TA TB TC TD"
         ss << "  TD1 is absent, protocol T=0 assumed";
     }
     ss << '\n';
 
-    float f_max[] = {4, 5, 6, 8, 12, 16, 20, -1, -1, 5, 7.5, 10, 15, 20, 0, 0};
-    int fi[] = {372, 372, 558, 744, 1116, 1488, 1860, -1, -1, 512, 768, 1024,   1536,   2048, -1, -1};
-    int Di[] = {-1, 1, 2, 4, 8, 16, 32, 64, 12, 20, -1, -1, -1, -1, -1, -1};
-
-    if (p->fields.find(TA1) != end) {
-        b = p->fields[TA1];
-        ss << "  TA1=" << format(b) << ": ";
-
-        ss << "f_max=" << f_max[HN(b)] << ", Fi=" << fi[HN(b)] << ", Di=" << Di[LN(b)];
-        ss << '\n';
+    if (HAS_BYTE(info.ta_present, 1)) {
+        formatClock(ss, "TA1", info.ta[1]);
     }
 
-    if (p->fields.find(TB1) != end) {
-        b = p->fields[TB1];
-        ss << "  TB1=" << format(b);
+    if (HAS_BYTE(info.tb_present, 1)) {
+        ss << "  TB1=" << format(info.tb[1]);
         ss << '\n';
     }
 
-    if (p->fields.find(TC1) != end) {
-        b = p->fields[TC1];
-        ss << "  TC1=" << format(b);
-        ss << ", EGTi=" << format(b);
+    if (HAS_BYTE(info.tc_present, 1)) {
+        ss << "  TC1=" << format(info.tc[1]);
+        ss << ", EGTi=" << format(info.tc[1]);
         ss << '\n';
     }
 
-    if (p->fields.find(TD2) != end) {
-        b = p->fields[TD2];
-        ss << "  TD2=" << format(b);
-        switch (LN(b)) {
-        case 1:
-            ss << ", protocol T=1";
-            break;
-        case 0:
-            ss << ", protocol T=0";
-            break;
-        }
+    if (HAS_BYTE(info.td_present, 2)) {
+        ss << "  TD2=" << format(info.td[2]);
+        formatProtocol(ss, info.td[2]);
         ss << '\n';
     }
 
-    if (p->fields.find(TA2) != end) {
-        b = p->fields[TA2];
-        ss << "  TA2=" << format(b) << ": ";
-
-        ss << "f_max=" << f_max[HN(b)] << ", Fi=" << fi[HN(b)] << ", Di=" << Di[LN(b)];
-        ss << '\n';
+    if (HAS_BYTE(info.ta_present, 2)) {
+        formatClock(ss, "TA2", info.ta[2]);
     }
 
-    if (p->fields.find(TC2) != end) {
-        b = p->fields[TC2];
-        ss << "  TC2=" << format(b);
-        ss << ", EGTi=" << format(b);
+    if (HAS_BYTE(info.tc_present, 2)) {
+        ss << "  TC2=" << format(info.tc[2]);
+        ss << ", EGTi=" << format(info.tc[2]);
         ss << '\n';
     }
 
     // we don't care about TA2, TA3 etc
 
     // historical bytes
-    ss << "  Historical bytes size: " << p->hb_size;
-    // try to parse historical bytes
-    if (!is_picc) {
+    ss << "  Historical bytes size: " << info.historical_bytes_size;
+    if (!info.is_picc) {
         ss << ", proprietary format.";
-    } else {
-        ss << "";
     }
     ss << '\n';
 
-    if (p->hb_size > 0) {
-        Bytes hb(p->hb, p->hb_size);
+    if (info.historical_bytes_size > 0) {
+        Bytes hb(info.historical_bytes, info.historical_bytes_size);
         ss << "  Historical bytes: " << format(hb) << '\n';
 
         // we can parse PICC historical data
-        if (is_picc) {
-            if (hb.at(0) == 0x80) {
-                if (p->hb_size >= 2 && hb.at(1) == 0x4f) {
-                    ss << "  PICC application detected" << '\n';
-                    // next 5 bytes defines  RID
-                    Bytes RID = hb.substr(3, 5);
-                    ss << "    RID=" << decodeRID(RID) << '\n';
-
-                    Byte SS = hb.at(8);
-                    switch (SS) {
-                    case 03:
-                        ss << "    SS=ISO/IEC 14443A, Part 3" << '\n';
-                        break;
-                    case 04:
-                        ss << "    SS=ISO/IEC 14443A, Part 4" << '\n';
-                        break;
-                    default:
-                        ss << "    SS=" << format(SS) << '\n';
-                    }
-
-                    Bytes CardName = hb.substr(9, 2);
-                        ss << "    CardName=" << decodeCardName(RID, CardName) << '\n';
-                } else {
-                    ss << "  TLV data" << '\n';
-                    size_t i = 1;
-                    size_t max_i = hb.size();
-                    while (1) {
-                        if (i >= max_i) {
-                            break;
-                        }
-                        Byte tag = HN(hb.at(i));
-                        Byte length = LN(hb.at(i));
-
-                        switch (tag) {
-                        case 0x3:
-                            ss << "    Card service data byte (tag 0x3)";
-                            break;
-                        case 0x4:
-                            ss << "    Initial access data (tag 0x4)";
-                            break;
-                        case 0x5:
-                            ss << "    Card issuer data (tag 0x5)";
-                            break;
-                        case 0x6:
-                            ss << "    Pre-issuing data (tag 0x6)";
-                            break;
-                        case 0x7:
-                            ss << "    Card capabilities (tag 0x7)";
-                            break;
-                        case 0x8:
-                            ss << "    Status indicator (tag 0x8)";
-                            break;
-                        default:
-                            ss << "    tag: " << format(tag);
-                        }
-                        
-                        // read next "length" bytes
-                        size_t next_pos = i+length+1;
-                        ss << "; bytes:";
-                        i++;
-                        for (;i<next_pos;i++) {
-                            ss << " " << format(hb.at(i));
-                        }
-                        ss << '\n';
-                    }
+        if (info.is_picc && info.has_picc_application) {
+            ss << "  PICC application detected" << '\n';
+            Bytes RID(info.picc_rid, sizeof(info.picc_rid));
+            ss << "    RID=" << decodeRID(RID) << '\n';
+
+            switch (info.picc_standard) {
+            case 03:
+                ss << "    SS=ISO/IEC 14443A, Part 3" << '\n';
+                break;
+            case 04:
+                ss << "    SS=ISO/IEC 14443A, Part 4" << '\n';
+                break;
+            default:
+                ss << "    SS=" << format(info.picc_standard) << '\n';
+            }
+
+            Bytes CardName = hb.substr(9, 2);
+            ss << "    CardName=" << decodeCardName(RID, CardName) << '\n';
+        } else if (info.is_picc && hb.at(0) == 0x80 && info.hb_tlv_count > 0) {
+            ss << "  TLV data" << '\n';
+            for (size_t i=0; i<info.hb_tlv_count; i++) {
+                const ATRCompactTLV & tlv = info.hb_tlv[i];
+                switch (tlv.tag) {
+                case 0x3:
+                    ss << "    Card service data byte (tag 0x3)";
+                    break;
+                case 0x4:
+                    ss << "    Initial access data (tag 0x4)";
+                    break;
+                case 0x5:
+                    ss << "    Card issuer data (tag 0x5)";
+                    break;
+                case 0x6:
+                    ss << "    Pre-issuing data (tag 0x6)";
+                    break;
+                case 0x7:
+                    ss << "    Card capabilities (tag 0x7)";
+                    break;
+                case 0x8:
+                    ss << "    Status indicator (tag 0x8)";
+                    break;
+                default:
+                    ss << "    tag: " << format(tlv.tag);
+                }
+
+                ss << "; bytes:";
+                for (size_t j=0; j<tlv.length; j++) {
+                    ss << " " << format(info.historical_bytes[tlv.offset + j]);
                 }
+                ss << '\n';
             }
         }
     }
 
     // TCK
-    if (p->fields.find(TCK) != end) {
-        // found TCK, check 
-        ss << "  TCK found: " << format(p->fields[TCK]);
-        Byte checksum = p->fields[TCK];
-
-        size_t max = p->atr.size() - 1;
-        for (size_t i=1; i<max; i++) {
-            checksum ^= p->atr.at(i);
-        }
-
-        if (checksum == 0) {
+    if (info.has_tck) {
+        ss << "  TCK found: " << format(info.tck);
+        if (info.tck_valid) {
             ss << ", matches";
         } else {
             ss << ", doesn't match!";
@@ -423,50 +404,24 @@ std::string ATRParser::str() const
     }
 
     return ss.str();
-    // return sd.str() + ss.str();
 }
 
-bool ATRParser::checkFeature(ATRFeature feature)
+bool ATRParser::checkFeature(ATRFeature feature) const
 {
     if (p->atr.size() == 0) {
         throw ATRParseError("No ATR");
     }
 
-    if (p->features.size() == 0) {
-        // fill array with features
-        if (p->fields[TS] == 0x3b && HN(p->fields[T0]) == 0x8 
-            && p->fields[TD1] == 0x80 && p->fields[TD2] == 0x01)
-        {
-            p->features.insert(ATR_FEATURE_PICC);
-
-            Bytes hb(p->hb, p->hb_size);
-            if (p->hb_size >= 2 && hb.at(0) == 0x80 && hb.at(1) == 0x4f) {
-                Bytes RID = hb.substr(3, 5);
-                if (format(RID).compare("A0 00 00 03 06") == 0) {
-                    unsigned int card_name = hb.at(9)*256 + hb.at(10);
-                    switch (card_name) {
-                    case 0x0001:
-                        p->features.insert(ATR_FEATURE_MIFARE_1K);
-                        break;
-                    case 0x0002:
-                        p->features.insert(ATR_FEATURE_MIFARE_4K);
-                        break;
-                    case 0x0003:
-                    case 0x0026:
-                        break;
-                    case 0xff88:
-                        p->features.insert(ATR_FEATURE_INFINEON_SLE_66R35);
-                        p->features.insert(ATR_FEATURE_MIFARE_1K);
-                        break;
-                    }
-                }
-            }
-        } else {
-            p->features.insert(ATR_FEATURE_ICC);
-        }
+    return (p->classification.features & ATR_FEATURE_BIT(feature)) != 0;
+}
+
+const ATRClassification & ATRParser::classification() const
+{
+    if (p->atr.size() == 0) {
+        throw ATRParseError("No ATR");
     }
 
-    return p->features.find(feature) != p->features.end();
+    return p->classification;
 }
 
 
@@ -488,21 +443,25 @@ static const char * PCSC_cardnames_map_values[PCSC_cardnames_map_size] = {
     "FeliCa 242K", "Infineon SLE 66R35"};
 
 
-static void initRIDMap()
+static std::once_flag RID_map_once;
+
+static void fillRIDMap()
 {
-    if (RID_map.size() == 0) {
-        for (size_t i=0; i<RID_map_size; i++) {
-            RID_map[RID_map_keys[i]] = RID_map_values[i];
-        }
+    for (size_t i=0; i<RID_map_size; i++) {
+        RID_map[RID_map_keys[i]] = RID_map_values[i];
     }
 
-    if (PCSC_cardnames_map.size() == 0) {
-        for (size_t i=0; i<PCSC_cardnames_map_size; i++) {
-            PCSC_cardnames_map[PCSC_cardnames_map_keys[i]] = PCSC_cardnames_map_values[i];
-        }
+    for (size_t i=0; i<PCSC_cardnames_map_size; i++) {
+        PCSC_cardnames_map[PCSC_cardnames_map_keys[i]] = PCSC_cardnames_map_values[i];
     }
 }
 
+// maps are filled only once, it's safe to call from multiple threads
+static void initRIDMap()
+{
+    std::call_once(RID_map_once, fillRIDMap);
+}
+
 static std::string decodeRID(const Bytes & rid)
 {
     std::stringstream ss;
@@ -533,4 +492,177 @@ static std::string decodeCardName(const Bytes & rid, const Bytes & card_name)
     return ss.str();
 }
 
-}
\ No newline at end of file
+static const Byte PCSC_RID[] = {0xA0, 0x00, 0x00, 0x03, 0x06};
+
+/*
+ * Fills derived ATRInfo fields from already stored raw ones
+ */
+static void decodeInfo(ATRInfo & info, const Bytes & bytes)
+{
+    info.inverse_convention = (info.ts == 0x3f);
+
+    // TD1 absent means T=0, see ISO 7816-3, section "8.2.3 Interface bytes TA TB TC TD"
+    if (!HAS_BYTE(info.td_present, 1)) {
+        info.protocols = 1;
+    }
+    for (size_t i=1; i<=7; i++) {
+        // T=15 is not a protocol but global interface bytes indicator
+        if (HAS_BYTE(info.td_present, i) && LN(info.td[i]) != 15) {
+            info.protocols |= 1 << LN(info.td[i]);
+        }
+    }
+
+    // default values are used when TA1 is absent
+    Byte ta1 = HAS_BYTE(info.ta_present, 1) ? info.ta[1] : 0x11;
+    info.fi = Fi_table[HN(ta1)];
+    info.di = Di_table[LN(ta1)];
+    info.f_max = f_max_table[HN(ta1)];
+
+    info.extra_guard_time = info.tc[1];
+
+    if (info.has_tck) {
+        Byte checksum = 0;
+        for (size_t i=1; i<bytes.size(); i++) {
+            checksum ^= bytes[i];
+        }
+        info.tck_valid = (checksum == 0);
+    }
+
+    // try to detect PICC, see section 3.1.3.2.3.1 of PC/SC specification
+    info.is_picc = (info.ts == 0x3b && HN(info.t0) == 0x8
+        && HAS_BYTE(info.td_present, 1) && info.td[1] == 0x80
+        && HAS_BYTE(info.td_present, 2) && info.td[2] == 0x01);
+
+    const Byte * hb = info.historical_bytes;
+    size_t hb_size = info.historical_bytes_size;
+
+    if (hb_size == 0 || hb[0] != 0x80) {
+        // proprietary format
+        return;
+    }
+
+    if (hb_size >= 2 && hb[1] == 0x4f) {
+        // PC/SC part 3 PICC historical bytes, "80 4F 0C RID[5] SS C0 C1 00 00 00 00"
+        if (hb_size >= 11) {
+            info.has_picc_application = true;
+            memcpy(info.picc_rid, hb+3, sizeof(info.picc_rid));
+            info.picc_standard = hb[8];
+            info.picc_card_name = hb[9]*256 + hb[10];
+        }
+        return;
+    }
+
+    // compact TLV objects, see ISO 7816-4, section "8.1.1 Historical bytes"
+    size_t i = 1;
+    while (i < hb_size) {
+        Byte length = LN(hb[i]);
+        if (i + 1 + length > hb_size) {
+            // malformed object
+            break;
+        }
+        ATRCompactTLV & tlv = info.hb_tlv[info.hb_tlv_count];
+        tlv.tag = HN(hb[i]);
+        tlv.length = length;
+        tlv.offset = i + 1;
+        info.hb_tlv_count++;
+        i += length + 1;
+    }
+}
+
+static void classify(ATRParsed * p)
+{
+    const ATRInfo & info = p->info;
+    ATRClassification & c = p->classification;
+
+    c.features = 0;
+    c.card_name.clear();
+
+    // the first offered protocol
+    c.protocol = HAS_BYTE(info.td_present, 1) ? LN(info.td[1]) : 0;
+
+    if (info.is_picc) {
+        c.features |= ATR_FEATURE_BIT(ATR_FEATURE_PICC);
+
+        if (info.has_picc_application
+            && memcmp(info.picc_rid, PCSC_RID, sizeof(PCSC_RID)) == 0)
+        {
+            int card_name = info.picc_card_name;
+            switch (card_name) {
+            case 0x0001:
+                c.features |= ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_1K);
+                break;
+            case 0x0002:
+                c.features |= ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_4K);
+                break;
+            case 0x0026:
+                c.features |= ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_MINI);
+                break;
+            case 0x0003:
+                break;
+            case 0xff88:
+                c.features |= ATR_FEATURE_BIT(ATR_FEATURE_INFINEON_SLE_66R35);
+                c.features |= ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_1K);
+                break;
+            }
+
+            std::map<int, std::string>::const_iterator name = PCSC_cardnames_map.find(card_name);
+            if (name != PCSC_cardnames_map.end()) {
+                c.card_name = name->second;
+            }
+        }
+    } else {
+        c.features |= ATR_FEATURE_BIT(ATR_FEATURE_ICC);
+    }
+
+    char family[40];
+    if (info.is_picc && info.has_picc_application) {
+        const Byte * rid = info.picc_rid;
+        snprintf(family, sizeof(family), "picc-t%d-%02x%02x%02x%02x%02x-%04x", c.protocol,
+            rid[0], rid[1], rid[2], rid[3], rid[4], info.picc_card_name);
+    } else {
+        snprintf(family, sizeof(family), "%s-t%d", info.is_picc ? "picc" : "icc", c.protocol);
+    }
+    c.family = family;
+}
+
+static bool lookupATRCache(const Bytes & atr, ATRParsed * p)
+{
+    std::lock_guard<std::mutex> lock(atr_cache_mutex);
+
+    std::map<Bytes, ATRCacheEntry>::iterator i = atr_cache.find(atr);
+    if (i == atr_cache.end()) {
+        return false;
+    }
+
+    ATRCacheEntry & e = i->second;
+    *p = e.parsed;
+
+    // move to the head of LRU list
+    atr_cache_lru.splice(atr_cache_lru.begin(), atr_cache_lru, e.lru_pos);
+
+    return true;
+}
+
+static void storeATRCache(const Bytes & atr, const ATRParsed * p)
+{
+    std::lock_guard<std::mutex> lock(atr_cache_mutex);
+
+    if (atr_cache.find(atr) != atr_cache.end()) {
+        // another thread parsed the same ATR
+        return;
+    }
+
+    if (atr_cache.size() >= ATR_CACHE_SIZE) {
+        // drop least recently used entry
+        atr_cache.erase(atr_cache_lru.back());
+        atr_cache_lru.pop_back();
+    }
+
+    atr_cache_lru.push_front(atr);
+
+    ATRCacheEntry & e = atr_cache[atr];
+    e.parsed = *p;
+    e.lru_pos = atr_cache_lru.begin();
+}
+
+}
@@ -55,7 +55,7 @@ BerTlv::BerTlv(const Bytes & tag, const Bytes & data)
     }
 
     // parse data as a list of BER-TLV encoded values
-    uint16_t p = 0;
+    size_t p = 0;
 
     while (true) {
         if (p >= data.size()) {
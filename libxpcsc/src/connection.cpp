@@ -29,6 +29,7 @@
 #include <string>
 #include <iostream>
 #include <cstring>
+#include <chrono>
 
 #include "../include/xpcsc.hpp"
 #include "debug.hpp"
@@ -42,15 +43,47 @@ namespace xpcsc {
 
 // void make_runtime_error(LONG, const std::string &);
 
+// 65536 bytes of extended length response and status word
+static const LONG RECV_BUFFER_SIZE = 65538;
+
 struct Connection::Private
 {
     SCARDCONTEXT context;
 
+    TransmitMetrics metrics;
+
+    // latency budget parameters, see set_timing()
+    bool timing;
+    ATRInfo atr_info;
+    double slow_factor;
+    unsigned long overhead;
+
+    // reader name and card, see attach_virtual_card()
+    std::vector<std::pair<std::string, VirtualCard *> > virtual_cards;
+
+    // allocated once, large enough for extended length responses
+    std::unique_ptr<Byte[]> recv_buffer;
+
     Private() {
         context = 0;
+        memset(&metrics, 0, sizeof(metrics));
+        timing = false;
+        recv_buffer.reset(new Byte[RECV_BUFFER_SIZE]);
+    }
+
+    VirtualCard * virtual_card(const std::string & reader_name) const {
+        for (auto i = virtual_cards.begin(); i != virtual_cards.end(); i++) {
+            if (i->first == reader_name) {
+                return i->second;
+            }
+        }
+        return 0;
     }
 };
 
+// virtual cards are always "connected" using T=1
+static SCARD_IO_REQUEST virtual_pci = {SCARD_PROTOCOL_T1, sizeof(SCARD_IO_REQUEST)};
+
 Connection::Connection()
 {
     p = new Private;
@@ -71,10 +104,17 @@ void Connection::init()
 
 Strings Connection::readers()
 {
-    CONTEXT_READY_CHECK();
-
     Strings r;
 
+    for (auto i = p->virtual_cards.begin(); i != p->virtual_cards.end(); i++) {
+        r.push_back(i->first);
+    }
+    if (p->context == 0 && r.size() != 0) {
+        return r;
+    }
+
+    CONTEXT_READY_CHECK();
+
     DWORD readers_buffer_size;
 
     PCSC_CALL( SCardListReaders(p->context, NULL, 0, &readers_buffer_size) );
@@ -104,6 +144,14 @@ xpcsc::Reader Connection::wait_for_reader_card(const std::string & reader_name,
 {
     xpcsc::Reader reader;
 
+    VirtualCard * card = p->virtual_card(reader_name);
+    if (card != 0) {
+        card->power_up();
+        reader.card = card;
+        reader.send_pci = &virtual_pci;
+        return reader;
+    }
+
     CONTEXT_READY_CHECK();
 
     SCARD_READERSTATE sc_reader_states[1];
@@ -160,6 +208,9 @@ void Connection::disconnect_card(const xpcsc::Reader & reader, DWORD disposition
     //   SCARD_EJECT_CARD - Eject the card.
 
     // don't need to check for card
+    if (reader.card != 0) {
+        return;
+    }
 
     PCSC_CALL(SCardDisconnect(reader.handle, disposition));
 }
@@ -174,6 +225,10 @@ Bytes Connection::atr(const xpcsc::Reader & reader)
     DWORD atr_size = MAX_ATR_SIZE;
     BYTE atr[MAX_ATR_SIZE];
 
+    if (reader.card != 0) {
+        return reader.card->atr();
+    }
+
     PCSC_CALL(SCardStatus(reader.handle, reader_friendly_name, &reader_friendly_name_size, 
         &state, &protocol, atr, &atr_size));
 
@@ -184,20 +239,17 @@ Bytes Connection::atr(const xpcsc::Reader & reader)
 
 void Connection::transmit(const xpcsc::Reader & reader, const Bytes & command, Bytes * response)
 {
-    const LONG recv_buffer_size = 1024;
+    const LONG recv_buffer_size = RECV_BUFFER_SIZE;
     LONG send_buffer_size = command.length();
     DWORD recv_length = recv_buffer_size;
     Bytes collector;
 
     // PRINT_DEBUG("[D] Command length: " << send_buffer_size);
 
-    std::unique_ptr<Byte[]> recv_buffer(new Byte[recv_buffer_size]);
-    // Byte *recv_buffer = new Byte[recv_buffer_size];
+    std::unique_ptr<Byte[]> & recv_buffer = p->recv_buffer;
 
     try {
-        PCSC_CALL( SCardTransmit(reader.handle, reader.send_pci, 
-            command.data(), send_buffer_size, NULL,
-            recv_buffer.get(), &recv_length) );
+        exchange(reader, command.data(), send_buffer_size, recv_buffer.get(), &recv_length);
 
         // analyze response status, if it's 61XX then more data available
         if (recv_length < 2) {
@@ -218,9 +270,7 @@ void Connection::transmit(const xpcsc::Reader & reader, const Bytes & command, B
                 cmd_get_response[4] = size;
 
                 recv_length = recv_buffer_size;
-                PCSC_CALL( SCardTransmit(reader.handle, reader.send_pci, 
-                    cmd_get_response, 5, NULL,
-                    recv_buffer.get(), &recv_length) );
+                exchange(reader, cmd_get_response, 5, recv_buffer.get(), &recv_length);
 
                 if (recv_length < 2) {
                     throw ConnectionError("Invalid response (length<2)");
@@ -253,8 +303,132 @@ void Connection::transmit(const xpcsc::Reader & reader, const Bytes & command, B
 }
 
 
+/*
+ * Single exchange with card, all transmit() traffic goes here
+ */
+void Connection::exchange(const xpcsc::Reader & reader, const Byte * command, size_t command_size,
+    Byte * response, DWORD * response_size)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (reader.card != 0) {
+        Bytes r;
+        reader.card->transmit(command, command_size, r);
+        if (r.size() > *response_size) {
+            throw ConnectionError("Virtual card response is too long");
+        }
+        memcpy(response, r.data(), r.size());
+        *response_size = r.size();
+    } else {
+        PCSC_CALL( SCardTransmit(reader.handle, reader.send_pci,
+            command, command_size, NULL,
+            response, response_size) );
+    }
+
+    unsigned long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    TransmitMetrics & m = p->metrics;
+    m.apdus++;
+    m.total_time += elapsed;
+
+    if (p->timing) {
+        int protocol = (reader.send_pci->dwProtocol == SCARD_PROTOCOL_T1) ? 1 : 0;
+        unsigned long expected = estimate_transfer_time(p->atr_info, protocol, command_size, *response_size);
+        double budget = p->slow_factor * expected + p->overhead;
+
+        m.expected_time += expected;
+        if (elapsed > budget) {
+            m.slow_apdus++;
+            PRINT_DEBUG("[D] Slow exchange: " << elapsed << "us, expected " << expected << "us");
+        }
+        if (elapsed / budget > m.worst_ratio) {
+            m.worst_ratio = elapsed / budget;
+        }
+    }
+}
+
+void Connection::set_timing(const ATRInfo & info, double slow_factor, unsigned long overhead)
+{
+    p->atr_info = info;
+    p->slow_factor = slow_factor;
+    p->overhead = overhead;
+    p->timing = true;
+}
+
+unsigned long Connection::latency_budget(const xpcsc::Reader & reader, size_t command_size, size_t response_size) const
+{
+    if (!p->timing) {
+        return 0;
+    }
+
+    int protocol = (reader.send_pci->dwProtocol == SCARD_PROTOCOL_T1) ? 1 : 0;
+    unsigned long expected = estimate_transfer_time(p->atr_info, protocol, command_size, response_size);
+    return p->slow_factor * expected + p->overhead;
+}
+
+void Connection::attach_virtual_card(const std::string & reader_name, VirtualCard * card)
+{
+    for (auto i = p->virtual_cards.begin(); i != p->virtual_cards.end(); i++) {
+        if (i->first == reader_name) {
+            p->virtual_cards.erase(i);
+            break;
+        }
+    }
+    if (card != 0) {
+        p->virtual_cards.push_back(std::make_pair(reader_name, card));
+    }
+}
+
+void Connection::begin_transaction(const xpcsc::Reader & reader)
+{
+    if (reader.card != 0) {
+        return;
+    }
+    PCSC_CALL(SCardBeginTransaction(reader.handle));
+}
+
+void Connection::end_transaction(const xpcsc::Reader & reader, DWORD disposition)
+{
+    if (reader.card != 0) {
+        return;
+    }
+    PCSC_CALL(SCardEndTransaction(reader.handle, disposition));
+}
+
+CardTransaction::CardTransaction(Connection & c, const Reader & reader)
+    : c(c), reader(reader)
+{
+    c.begin_transaction(reader);
+}
+
+CardTransaction::~CardTransaction()
+{
+    try {
+        c.end_transaction(reader);
+    } catch (PCSCError & e) {
+        // card could be removed already, nothing to end then
+        PRINT_DEBUG("[D] End transaction failed: " << e.what());
+    }
+}
+
+const TransmitMetrics & Connection::metrics() const
+{
+    return p->metrics;
+}
+
+void Connection::reset_metrics()
+{
+    memset(&p->metrics, 0, sizeof(p->metrics));
+}
+
+
 void Connection::wait_for_card_remove(const std::string & reader_name)
 {
+    if (p->virtual_card(reader_name) != 0) {
+        return;
+    }
+
     CONTEXT_READY_CHECK();
 
     SCARD_READERSTATE sc_reader_states[1];
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file emvsession.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * EMV application read, see EMV 4.3 Book 3, sections 10.1-10.2.
+ */
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte CMD_SELECT[] = {0x00, 0xA4, 0x04, 0x00};
+static const Byte CMD_GPO[] = {0x80, 0xA8, 0x00, 0x00};
+static const Byte CMD_READ_RECORD[] = {0x00, 0xB2, 0x00, 0x00, 0x00};
+
+static const uint32_t TAG_GPO_FORMAT_1 = 0x80;
+static const uint32_t TAG_COMMAND_TEMPLATE = 0x83;
+static const uint32_t TAG_AIP = 0x82;
+static const uint32_t TAG_AFL = 0x94;
+static const uint32_t TAG_PDOL = 0x9F38;
+
+// nesting limit for broken or hostile data
+static const int MAX_DEPTH = 8;
+
+struct TagValue {
+    uint32_t tag;
+    size_t offset;
+    size_t size;
+};
+
+struct EMVReadSession::Private
+{
+    Connection * c;
+    Reader reader;
+
+    LeCache * le_cache;
+    std::string family;
+
+    // data of all responses, values point into it
+    Bytes buffer;
+    // SELECT response data is at the buffer start
+    size_t fci_size;
+    std::vector<TagValue> values;
+    std::vector<uint32_t> tags;
+
+    size_t records_read;
+    size_t records_skipped;
+    uint16_t status;
+
+    Bytes command;
+    Bytes response;
+
+    // response data is appended to buffer, its offset is returned
+    bool send(size_t & offset) {
+        c->transmit(reader, command, &response);
+        uint16_t sw = c->response_status(response);
+        if (sw != 0x9000) {
+            status = sw;
+            return false;
+        }
+        offset = buffer.size();
+        buffer.append(response, 0, response.size() - 2);
+        return true;
+    }
+
+    const TagValue * find(uint32_t tag) const {
+        for (auto i = values.begin(); i != values.end(); i++) {
+            if (i->tag == tag) {
+                return &(*i);
+            }
+        }
+        return 0;
+    }
+
+    void add(uint32_t tag, size_t offset, size_t size) {
+        // first occurrence wins
+        if (find(tag) != 0) {
+            return;
+        }
+        TagValue v = {tag, offset, size};
+        values.push_back(v);
+        tags.push_back(tag);
+    }
+
+    bool index(size_t pos, size_t end, int depth);
+    bool found_all(const std::vector<uint32_t> & wanted) const;
+    bool read_record(const Bytes & aid, Byte sfi, Byte record);
+};
+
+// BER-TLV tag at "pos" of "data", pos is moved after it
+static bool read_tag(const Byte * data, size_t & pos, size_t end, uint32_t & tag)
+{
+    if (pos >= end) {
+        return false;
+    }
+    Byte b = data[pos++];
+    tag = b;
+    if ((b & 0x1F) == 0x1F) {
+        // subsequent bytes, the last one has bit 8 cleared
+        size_t n = 0;
+        do {
+            if (pos >= end || ++n > 3) {
+                return false;
+            }
+            b = data[pos++];
+            tag = (tag << 8) | b;
+        } while (b & 0x80);
+    }
+    return true;
+}
+
+bool EMVReadSession::Private::index(size_t pos, size_t end, int depth)
+{
+    const Byte * data = buffer.data();
+
+    while (pos < end) {
+        // padding between data objects
+        if (data[pos] == 0x00 || data[pos] == 0xFF) {
+            pos++;
+            continue;
+        }
+
+        Byte first = data[pos];
+        uint32_t tag;
+        if (!read_tag(data, pos, end, tag) || pos >= end) {
+            return false;
+        }
+
+        size_t length = data[pos++];
+        if (length & 0x80) {
+            size_t n = length & 0x7F;
+            if (n == 0 || n > 3 || pos + n > end) {
+                return false;
+            }
+            length = 0;
+            for (size_t i = 0; i < n; i++) {
+                length = (length << 8) | data[pos++];
+            }
+        }
+        if (pos + length > end) {
+            return false;
+        }
+
+        add(tag, pos, length);
+
+        // constructed data object
+        if ((first & 0x20) && depth < MAX_DEPTH && !index(pos, pos + length, depth + 1)) {
+            return false;
+        }
+        pos += length;
+    }
+    return true;
+}
+
+bool EMVReadSession::Private::found_all(const std::vector<uint32_t> & wanted) const
+{
+    if (wanted.empty()) {
+        return false;
+    }
+    for (auto i = wanted.begin(); i != wanted.end(); i++) {
+        if (find(*i) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EMVReadSession::Private::read_record(const Bytes & aid, Byte sfi, Byte record)
+{
+    command.assign(CMD_READ_RECORD, sizeof(CMD_READ_RECORD));
+    command[2] = record;
+    command[3] = (sfi << 3) | 0x04;
+    if (le_cache) {
+        command[4] = le_cache->lookup(family, aid, sfi, record);
+    }
+
+    c->transmit(reader, command, &response);
+    uint16_t sw = c->response_status(response);
+    if ((sw >> 8) == 0x6C) {
+        // repeat with proper Le
+        command[4] = sw & 0xFF;
+        c->transmit(reader, command, &response);
+        sw = c->response_status(response);
+        if (sw == 0x9000 && le_cache) {
+            le_cache->store(family, aid, sfi, record, command[4]);
+        }
+    }
+    if (sw != 0x9000) {
+        status = sw;
+        return false;
+    }
+
+    size_t offset = buffer.size();
+    buffer.append(response, 0, response.size() - 2);
+    records_read++;
+    if (!index(offset, buffer.size(), 0)) {
+        PRINT_DEBUG("[D] Malformed record " << int(record) << " of SFI " << int(sfi));
+    }
+    return true;
+}
+
+EMVReadSession::EMVReadSession(Connection & c, const Reader & reader)
+{
+    p = new Private;
+    p->c = &c;
+    p->reader = reader;
+    p->le_cache = 0;
+    p->fci_size = 0;
+    p->records_read = 0;
+    p->records_skipped = 0;
+    p->status = 0;
+}
+
+EMVReadSession::~EMVReadSession()
+{
+    delete p;
+}
+
+void EMVReadSession::set_le_cache(LeCache * cache, const std::string & family)
+{
+    p->le_cache = cache;
+    p->family = family;
+}
+
+bool EMVReadSession::read(const Bytes & aid, const std::vector<uint32_t> & tags)
+{
+    p->buffer.clear();
+    p->fci_size = 0;
+    p->values.clear();
+    p->tags.clear();
+    p->records_read = 0;
+    p->records_skipped = 0;
+    p->status = 0;
+
+    CardTransaction transaction(*p->c, p->reader);
+    size_t offset;
+
+    // SELECT application
+    p->command.assign(CMD_SELECT, sizeof(CMD_SELECT));
+    p->command.push_back(static_cast<Byte>(aid.size()));
+    p->command.append(aid);
+    p->command.push_back(0x00);
+    if (!p->send(offset)) {
+        return false;
+    }
+    p->fci_size = p->buffer.size();
+    if (!p->index(offset, p->buffer.size(), 0)) {
+        PRINT_DEBUG("[D] Malformed FCI");
+    }
+
+    // PDOL data, zeroes of requested lengths
+    size_t pdol_length = 0;
+    const TagValue * pdol = p->find(TAG_PDOL);
+    if (pdol) {
+        size_t pos = pdol->offset;
+        size_t end = pdol->offset + pdol->size;
+        uint32_t tag;
+        while (read_tag(p->buffer.data(), pos, end, tag) && pos < end) {
+            pdol_length += p->buffer[pos++];
+        }
+    }
+    if (pdol_length > 0xFD) {
+        p->status = 0;
+        return false;
+    }
+
+    // GET PROCESSING OPTIONS
+    p->command.assign(CMD_GPO, sizeof(CMD_GPO));
+    p->command.push_back(static_cast<Byte>(pdol_length + 2));
+    p->command.push_back(TAG_COMMAND_TEMPLATE);
+    p->command.push_back(static_cast<Byte>(pdol_length));
+    p->command.append(pdol_length, 0);
+    p->command.push_back(0x00);
+    if (!p->send(offset)) {
+        return false;
+    }
+
+    // format 1 is primitive: AIP followed by AFL
+    if (offset < p->buffer.size() && p->buffer[offset] == TAG_GPO_FORMAT_1) {
+        size_t pos = offset;
+        if (!p->index(pos, p->buffer.size(), 0)) {
+            PRINT_DEBUG("[D] Malformed GET PROCESSING OPTIONS response");
+        }
+        const TagValue * v = p->find(TAG_GPO_FORMAT_1);
+        if (v && v->size >= 2) {
+            p->add(TAG_AIP, v->offset, 2);
+            p->add(TAG_AFL, v->offset + 2, v->size - 2);
+        }
+    } else if (!p->index(offset, p->buffer.size(), 0)) {
+        PRINT_DEBUG("[D] Malformed GET PROCESSING OPTIONS response");
+    }
+
+    // copy AFL, buffer grows while records are read
+    const TagValue * afl_value = p->find(TAG_AFL);
+    Bytes afl;
+    if (afl_value) {
+        afl.assign(p->buffer, afl_value->offset, afl_value->size);
+    }
+
+    // AFL entries: SFI, first record, last record, records for offline authentication
+    for (size_t i = 0; i + 4 <= afl.size(); i += 4) {
+        Byte sfi = afl[i] >> 3;
+        for (size_t record = afl[i+1]; record <= afl[i+2] && record != 0; record++) {
+            if (p->found_all(tags)) {
+                p->records_skipped++;
+                continue;
+            }
+            if (!p->read_record(aid, sfi, record)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool EMVReadSession::find(uint32_t tag, BytesView & value) const
+{
+    const TagValue * v = p->find(tag);
+    if (v == 0) {
+        return false;
+    }
+    value.data = p->buffer.data() + v->offset;
+    value.size = v->size;
+    return true;
+}
+
+Bytes EMVReadSession::value(uint32_t tag) const
+{
+    BytesView v;
+    if (!find(tag, v)) {
+        return Bytes();
+    }
+    return Bytes(v.data, v.size);
+}
+
+Bytes EMVReadSession::fci() const
+{
+    return Bytes(p->buffer, 0, p->fci_size);
+}
+
+const std::vector<uint32_t> & EMVReadSession::found_tags() const
+{
+    return p->tags;
+}
+
+size_t EMVReadSession::records_read() const
+{
+    return p->records_read;
+}
+
+size_t EMVReadSession::records_skipped() const
+{
+    return p->records_skipped;
+}
+
+uint16_t EMVReadSession::last_status() const
+{
+    return p->status;
+}
+
+}
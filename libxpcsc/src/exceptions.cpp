@@ -64,6 +64,18 @@ ATRParseError::ATRParseError(const char * what)
     : std::runtime_error(what)
 {}
 
+ATRDatabaseError::ATRDatabaseError(const char * what)
+    : std::runtime_error(what)
+{}
+
+MifareKeyDictionaryError::MifareKeyDictionaryError(const char * what)
+    : std::runtime_error(what)
+{}
+
+MifareKeyCacheError::MifareKeyCacheError(const char * what)
+    : std::runtime_error(what)
+{}
+
 APDUParseError::APDUParseError(const char * what)
     : std::runtime_error(what)
 {}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file fcicache.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Applications of recently seen cards.
+ */
+
+#include <list>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte CMD_GET_UID[] = {0xFF, 0xCA, 0x00, 0x00, 0x00};
+static const Byte CMD_SELECT[] = {0x00, 0xA4, 0x04, 0x00};
+
+struct FCICacheEntry {
+    Bytes identity;
+    CardApplications apps;
+};
+
+// identity is ATR length, ATR and UID; contact cards have no UID
+static bool has_uid(const Bytes & identity)
+{
+    return !identity.empty() && identity.size() > size_t(identity[0]) + 1;
+}
+
+struct FCICache::Private
+{
+    // the most recent card first, list is short so search is linear
+    std::list<FCICacheEntry> entries;
+    size_t capacity;
+
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long stale;
+    unsigned long atr_only;
+
+    std::list<FCICacheEntry>::iterator find(const Bytes & identity) {
+        for (auto i = entries.begin(); i != entries.end(); i++) {
+            if (i->identity == identity) {
+                return i;
+            }
+        }
+        return entries.end();
+    }
+};
+
+FCICache::FCICache(size_t capacity)
+{
+    p = new Private;
+    p->capacity = capacity > 0 ? capacity : 1;
+    p->hits = 0;
+    p->misses = 0;
+    p->stale = 0;
+    p->atr_only = 0;
+}
+
+FCICache::~FCICache()
+{
+    delete p;
+}
+
+Bytes FCICache::card_identity(Connection & c, const Reader & reader)
+{
+    Bytes atr = c.atr(reader);
+    Bytes identity(1, static_cast<Byte>(atr.size()));
+    identity.append(atr);
+
+    Bytes response;
+    c.transmit(reader, Bytes(CMD_GET_UID, sizeof(CMD_GET_UID)), &response);
+    if (c.response_status(response) == 0x9000) {
+        identity.append(response, 0, response.size() - 2);
+    }
+    return identity;
+}
+
+const CardApplications * FCICache::lookup(const Bytes & identity)
+{
+    auto i = p->find(identity);
+    if (i == p->entries.end()) {
+        p->misses++;
+        return 0;
+    }
+    p->hits++;
+    if (!has_uid(identity)) {
+        p->atr_only++;
+    }
+    p->entries.splice(p->entries.begin(), p->entries, i);
+    return &i->apps;
+}
+
+void FCICache::reject(const Bytes & identity)
+{
+    auto i = p->find(identity);
+    if (i == p->entries.end()) {
+        return;
+    }
+    p->entries.erase(i);
+    p->stale++;
+    if (!has_uid(identity)) {
+        p->atr_only--;
+    }
+}
+
+const CardApplications * FCICache::confirm(Connection & c, const Reader & reader, const Bytes & identity)
+{
+    const CardApplications * apps = lookup(identity);
+    if (apps == 0) {
+        return 0;
+    }
+    const CardApplication & app = apps->front();
+    Bytes command(CMD_SELECT, sizeof(CMD_SELECT));
+    command.push_back(static_cast<Byte>(app.aid.size()));
+    command.append(app.aid);
+    command.push_back(0x00);
+
+    Bytes response;
+    c.transmit(reader, command, &response);
+    if (c.response_status(response) != 0x9000
+        || (!app.fci.empty() && response.compare(0, response.size() - 2, app.fci) != 0))
+    {
+        PRINT_DEBUG("[D] Cached FCI doesn't match card: " << format(app.aid));
+        reject(identity);
+        return 0;
+    }
+    if (app.fci.empty()) {
+        // application was listed in directory only, next taps are compared with this FCI;
+        // lookup() made the entry the first one
+        p->entries.front().apps.front().fci.assign(response, 0, response.size() - 2);
+    }
+    return apps;
+}
+
+void FCICache::store(const Bytes & identity, const CardApplications & apps)
+{
+    // nothing to prove such entry with
+    if (apps.size() == 0) {
+        return;
+    }
+
+    auto i = p->find(identity);
+    if (i != p->entries.end()) {
+        i->apps = apps;
+        p->entries.splice(p->entries.begin(), p->entries, i);
+        return;
+    }
+
+    FCICacheEntry entry;
+    entry.identity = identity;
+    entry.apps = apps;
+    p->entries.push_front(entry);
+    if (p->entries.size() > p->capacity) {
+        p->entries.pop_back();
+    }
+}
+
+size_t FCICache::size() const
+{
+    return p->entries.size();
+}
+
+unsigned long FCICache::hits() const
+{
+    return p->hits;
+}
+
+unsigned long FCICache::misses() const
+{
+    return p->misses;
+}
+
+unsigned long FCICache::stale() const
+{
+    return p->stale;
+}
+
+unsigned long FCICache::atr_only() const
+{
+    return p->atr_only;
+}
+
+double FCICache::hit_rate() const
+{
+    unsigned long lookups = p->hits + p->misses;
+    if (lookups == 0) {
+        return 0;
+    }
+    return double(p->hits - p->stale - p->atr_only) / lookups;
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file imagewriter.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Writing MIFARE Classic card image, only changed blocks are written.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const size_t BLOCK_SIZE = 16;
+static const size_t KEY_SIZE = 6;
+
+// trailer bytes that can be read back: access bits and general purpose byte
+static const size_t TRAILER_ACCESS_OFFSET = 6;
+static const size_t TRAILER_ACCESS_SIZE = 4;
+
+// READ BINARY length is one byte, so 16-block sectors of 4K card are read in parts
+static const size_t MAX_READ_BLOCKS = 0xFF / BLOCK_SIZE;
+
+static bool read_sector(MifareClassicSession & session, size_t first, size_t count, Bytes & data)
+{
+    size_t parts = (count + MAX_READ_BLOCKS - 1) / MAX_READ_BLOCKS;
+    size_t part_size = (count + parts - 1) / parts;
+    Bytes part;
+
+    data.clear();
+    for (size_t block = first; block < first + count; block += part_size) {
+        size_t size = std::min(part_size, first + count - block);
+        if (!session.read_blocks(block, size, part)) {
+            return false;
+        }
+        data.append(part);
+    }
+    return true;
+}
+
+static const Byte * sector_key(const MifareCachedKeys & keys, Byte sector, MifareKeyType key_type)
+{
+    for (MifareCachedKeys::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        if (it->sector == sector && it->key_type == key_type) {
+            return it->key;
+        }
+    }
+    return 0;
+}
+
+bool mifare_write_image(MifareClassicSession & session, const Bytes & current,
+    const Bytes & target, const MifareCachedKeys & keys, MifareWriteReport & report)
+{
+    report.blocks_written = 0;
+    report.blocks_unchanged = 0;
+    report.sectors_written = 0;
+    report.failed_block = 0;
+    report.verify_failed = false;
+
+    size_t blocks = std::min<size_t>(std::min(current.size(), target.size()) / BLOCK_SIZE, 256);
+
+    for (size_t sector = 0; sector < 40; sector++) {
+        size_t first = mifare_sector_first_block(sector);
+        size_t count = mifare_sector_blocks(sector);
+        if (first >= blocks) {
+            break;
+        }
+        count = std::min(count, blocks - first);
+        size_t trailer = mifare_sector_first_block(sector) + mifare_sector_blocks(sector) - 1;
+
+        const Byte * key_a = sector_key(keys, sector, MifareKeyA);
+        const Byte * key_b = sector_key(keys, sector, MifareKeyB);
+
+        // blocks to write, trailer is the last one
+        std::vector<Byte> changed;
+        for (size_t block = std::max<size_t>(first, 1); block < first + count; block++) {
+            Bytes was = current.substr(block * BLOCK_SIZE, BLOCK_SIZE);
+            if (block == trailer) {
+                // keys read back as zeroes, so known keys are compared instead
+                if (key_a) {
+                    was.replace(0, KEY_SIZE, key_a, KEY_SIZE);
+                }
+                if (key_b) {
+                    was.replace(10, KEY_SIZE, key_b, KEY_SIZE);
+                }
+            }
+            if (target.compare(block * BLOCK_SIZE, BLOCK_SIZE, was) == 0) {
+                report.blocks_unchanged++;
+            } else {
+                changed.push_back(block);
+            }
+        }
+        if (changed.size() == 0) {
+            continue;
+        }
+
+        // key B is the write key in all access conditions but transport one
+        MifareKeyType key_type = key_b ? MifareKeyB : MifareKeyA;
+        const Byte * key = key_b ? key_b : key_a;
+        bool other_tried = (key_a == 0 || key_b == 0);
+        if (key == 0) {
+            PRINT_DEBUG("[D] No key for sector " << sector);
+            report.failed_block = changed[0];
+            return false;
+        }
+
+        for (size_t i = 0; i < changed.size(); i++) {
+            Byte block = changed[i];
+            Bytes data = target.substr(block * BLOCK_SIZE, BLOCK_SIZE);
+
+            while (!session.authenticate(block, key_type, key) || !session.update_block(block, data)) {
+                if (other_tried) {
+                    report.failed_block = block;
+                    return false;
+                }
+                PRINT_DEBUG("[D] Block " << int(block) << " write failed, trying the other key");
+                other_tried = true;
+                key_type = (key_type == MifareKeyB) ? MifareKeyA : MifareKeyB;
+                key = (key_type == MifareKeyB) ? key_b : key_a;
+            }
+            report.blocks_written++;
+        }
+        report.sectors_written++;
+
+        // read sector back, new trailer could forbid reading with old authentication
+        Bytes data;
+        if (!read_sector(session, first, count, data)) {
+            bool retried = false;
+            if (changed.back() == trailer) {
+                size_t offset = trailer * BLOCK_SIZE + ((key_type == MifareKeyA) ? 0 : 10);
+                Bytes new_key = target.substr(offset, KEY_SIZE);
+                retried = session.authenticate(first, key_type, new_key.c_str())
+                    && read_sector(session, first, count, data);
+            }
+            if (!retried) {
+                report.failed_block = first;
+                report.verify_failed = true;
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < changed.size(); i++) {
+            Byte block = changed[i];
+            size_t offset = (block - first) * BLOCK_SIZE;
+            bool same = (block == trailer)
+                ? data.compare(offset + TRAILER_ACCESS_OFFSET, TRAILER_ACCESS_SIZE,
+                    target, block * BLOCK_SIZE + TRAILER_ACCESS_OFFSET, TRAILER_ACCESS_SIZE) == 0
+                : data.compare(offset, BLOCK_SIZE, target, block * BLOCK_SIZE, BLOCK_SIZE) == 0;
+            if (!same) {
+                PRINT_DEBUG("[D] Block " << int(block) << " doesn't match written data");
+                report.failed_block = block;
+                report.verify_failed = true;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
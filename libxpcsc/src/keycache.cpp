@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file keycache.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Per-card MIFARE Classic keys cache.
+ *
+ * File format:
+ *
+ *   magic "XMFKCH\0\1"
+ *   card records, appended one after another:
+ *     marker 0xA5, UID length, UID, keys count,
+ *     keys (sector, key type, 6 bytes of key) ...,
+ *     checksum (sum of all previous record bytes modulo 256)
+ *
+ * Records are appended (O_APPEND) with single write() call, so runs sharing
+ * the file don't overwrite each other; a short write is truncated back. Broken
+ * record left by crashed run could still be followed by valid ones: on open
+ * reading resumes at the next valid record and only a broken tail is cut off.
+ */
+
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../include/xpcsc.hpp"
+#include "mapped_file.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte KEYCACHE_MAGIC[8] = {'X', 'M', 'F', 'K', 'C', 'H', 0, 1};
+static const Byte RECORD_MARKER = 0xA5;
+static const size_t MAX_UID_SIZE = 10;
+static const size_t MAX_KEYS = 80;
+static const size_t KEY_SIZE = 6;
+static const size_t KEY_ENTRY_SIZE = 2 + KEY_SIZE;
+
+struct MifareKeyCache::Private
+{
+    int fd;
+    // UID -> offset of the latest card record
+    std::unordered_map<std::string, off_t> index;
+
+    Private() : fd(-1) {}
+
+    void close() {
+        if (fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+        index.clear();
+    }
+};
+
+static std::string uidKey(const Bytes & uid)
+{
+    return std::string(reinterpret_cast<const char *>(uid.data()), uid.size());
+}
+
+// size of valid record at data or 0
+static size_t recordSize(const Byte * data, size_t size)
+{
+    if (size < 3 || data[0] != RECORD_MARKER || data[1] == 0 || data[1] > MAX_UID_SIZE) {
+        return 0;
+    }
+    size_t uid_size = data[1];
+    if (size < 2 + uid_size + 1) {
+        return 0;
+    }
+    size_t count = data[2 + uid_size];
+    size_t total = 2 + uid_size + 1 + count*KEY_ENTRY_SIZE + 1;
+    if (count > MAX_KEYS || size < total) {
+        return 0;
+    }
+
+    Byte sum = 0;
+    for (size_t i = 0; i < total - 1; i++) {
+        sum += data[i];
+    }
+    return (sum == data[total - 1]) ? total : 0;
+}
+
+MifareKeyCache::MifareKeyCache()
+{
+    p = new Private;
+}
+
+MifareKeyCache::~MifareKeyCache()
+{
+    p->close();
+    delete p;
+}
+
+void MifareKeyCache::open(const std::string & path)
+{
+    p->close();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd == -1) {
+        throw MifareKeyCacheError("Cannot open keys cache file");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw MifareKeyCacheError("Cannot open keys cache file");
+    }
+
+    if (st.st_size == 0) {
+        if (write(fd, KEYCACHE_MAGIC, sizeof(KEYCACHE_MAGIC)) != sizeof(KEYCACHE_MAGIC)) {
+            ::close(fd);
+            throw MifareKeyCacheError("Cannot write keys cache file");
+        }
+        p->fd = fd;
+        return;
+    }
+
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(KEYCACHE_MAGIC)
+        || memcmp(file.data(), KEYCACHE_MAGIC, sizeof(KEYCACHE_MAGIC)) != 0)
+    {
+        ::close(fd);
+        throw MifareKeyCacheError("Not a keys cache file");
+    }
+
+    const Byte * data = file.data();
+    size_t size = file.size();
+    size_t offset = sizeof(KEYCACHE_MAGIC);
+
+    // end of the last valid record
+    size_t valid_end = offset;
+
+    while (offset < size) {
+        size_t length = recordSize(data + offset, size - offset);
+        if (length == 0) {
+            // skip broken record, the next one starts with marker
+            const void * marker = memchr(data + offset + 1, RECORD_MARKER, size - offset - 1);
+            offset = marker ? static_cast<const Byte *>(marker) - data : size;
+            continue;
+        }
+        if (offset != valid_end) {
+            PRINT_DEBUG("[D] Broken keys cache record skipped, bytes: " << (offset - valid_end));
+        }
+        Bytes uid(data + offset + 2, data[offset + 1]);
+        p->index[uidKey(uid)] = offset;
+        offset += length;
+        valid_end = offset;
+    }
+
+    if (valid_end < size) {
+        PRINT_DEBUG("[D] Broken keys cache tail dropped, bytes: " << (size - valid_end));
+        if (ftruncate(fd, valid_end) != 0) {
+            ::close(fd);
+            p->index.clear();
+            throw MifareKeyCacheError("Cannot repair keys cache file");
+        }
+    }
+
+    p->fd = fd;
+
+    PRINT_DEBUG("[D] Keys cache loaded, cards: " << p->index.size());
+}
+
+size_t MifareKeyCache::size() const
+{
+    return p->index.size();
+}
+
+bool MifareKeyCache::lookup(const Bytes & uid, MifareCachedKeys & keys) const
+{
+    keys.clear();
+
+    auto it = p->index.find(uidKey(uid));
+    if (it == p->index.end()) {
+        return false;
+    }
+
+    Byte record[3 + MAX_UID_SIZE + MAX_KEYS*KEY_ENTRY_SIZE + 1];
+    ssize_t size = pread(p->fd, record, sizeof(record), it->second);
+    if (size <= 0 || recordSize(record, size) == 0) {
+        return false;
+    }
+
+    const Byte * entry = record + 2 + uid.size();
+    size_t count = *entry++;
+    for (size_t i = 0; i < count; i++, entry += KEY_ENTRY_SIZE) {
+        MifareCachedKey key;
+        key.sector = entry[0];
+        key.key_type = (entry[1] == MifareKeyB) ? MifareKeyB : MifareKeyA;
+        memcpy(key.key, entry + 2, KEY_SIZE);
+        keys.push_back(key);
+    }
+
+    return true;
+}
+
+void MifareKeyCache::store(const Bytes & uid, const MifareCachedKeys & keys)
+{
+    if (p->fd == -1) {
+        throw MifareKeyCacheError("Keys cache is not opened");
+    }
+    if (uid.size() == 0 || uid.size() > MAX_UID_SIZE || keys.size() > MAX_KEYS) {
+        throw MifareKeyCacheError("Invalid keys cache record");
+    }
+
+    Bytes record;
+    record.push_back(RECORD_MARKER);
+    record.push_back(uid.size());
+    record.append(uid);
+    record.push_back(keys.size());
+    for (auto it = keys.begin(); it != keys.end(); it++) {
+        record.push_back(it->sector);
+        record.push_back(it->key_type);
+        record.append(it->key, KEY_SIZE);
+    }
+    Byte sum = 0;
+    for (size_t i = 0; i < record.size(); i++) {
+        sum += record[i];
+    }
+    record.push_back(sum);
+
+    // O_APPEND: record goes to the current end even if another process appended meanwhile
+    ssize_t written = write(p->fd, record.data(), record.size());
+    off_t end = lseek(p->fd, 0, SEEK_CUR);
+    if (written != (ssize_t)record.size()) {
+        if (written > 0 && end != -1 && ftruncate(p->fd, end - written) != 0) {
+            PRINT_DEBUG("[D] Cannot cut off partially written keys cache record");
+        }
+        throw MifareKeyCacheError("Cannot write keys cache file");
+    }
+    if (end == -1) {
+        throw MifareKeyCacheError("Cannot write keys cache file");
+    }
+
+    p->index[uidKey(uid)] = end - written;
+}
+
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file keydictionary.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Compiled MIFARE Classic keys dictionary.
+ *
+ * Binary format (integers are little-endian uint32):
+ *
+ *   magic "XMFKEY\0\1"
+ *   keys count
+ *   keys, 6 bytes each, in source order without duplicates
+ *
+ * Keys are used directly from the mapping, so opening even huge dictionary
+ * costs nothing.
+ */
+
+#include <istream>
+#include <ostream>
+#include <fstream>
+#include <vector>
+#include <unordered_set>
+#include <cstring>
+#include <cctype>
+
+#include "../include/xpcsc.hpp"
+#include "mapped_file.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte KEYDICT_MAGIC[8] = {'X', 'M', 'F', 'K', 'E', 'Y', 0, 1};
+static const size_t HEADER_SIZE = 8 + 4;
+static const size_t KEY_SIZE = 6;
+
+struct MifareKeyDictionary::Private
+{
+    MappedFile file;
+
+    const Byte * keys;
+    size_t count;
+};
+
+MifareKeyDictionary::MifareKeyDictionary()
+{
+    p = new Private;
+    p->keys = 0;
+    p->count = 0;
+}
+
+MifareKeyDictionary::~MifareKeyDictionary()
+{
+    delete p;
+}
+
+void MifareKeyDictionary::open(const std::string & path)
+{
+    p->count = 0;
+
+    if (!p->file.open(path)) {
+        throw MifareKeyDictionaryError("Cannot open keys dictionary file");
+    }
+
+    const Byte * data = p->file.data();
+    size_t size = p->file.size();
+
+    if (size < HEADER_SIZE || memcmp(data, KEYDICT_MAGIC, sizeof(KEYDICT_MAGIC)) != 0) {
+        p->file.close();
+        throw MifareKeyDictionaryError("Not a keys dictionary file");
+    }
+
+    size_t count = read_le32(data + 8);
+    if (size != HEADER_SIZE + count*KEY_SIZE) {
+        p->file.close();
+        throw MifareKeyDictionaryError("Corrupted keys dictionary file");
+    }
+
+    p->keys = data + HEADER_SIZE;
+    p->count = count;
+
+    PRINT_DEBUG("[D] Keys dictionary loaded, keys: " << count);
+}
+
+bool MifareKeyDictionary::is_compiled(const std::string & path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(KEYDICT_MAGIC)];
+
+    if (!file.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return memcmp(magic, KEYDICT_MAGIC, sizeof(KEYDICT_MAGIC)) == 0;
+}
+
+size_t MifareKeyDictionary::size() const
+{
+    return p->count;
+}
+
+const Byte * MifareKeyDictionary::key(size_t i) const
+{
+    if (i >= p->count) {
+        return 0;
+    }
+    return p->keys + i*KEY_SIZE;
+}
+
+static bool nibble(char c, Byte & value)
+{
+    if (c >= '0' && c <= '9') {
+        value = c - '0';
+        return true;
+    }
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') {
+        value = c - 'a' + 10;
+        return true;
+    }
+    return false;
+}
+
+// parses exactly 12 hex digits
+static bool parseKey(const std::string & text, Byte * key)
+{
+    if (text.size() != KEY_SIZE*2) {
+        return false;
+    }
+    for (size_t i = 0; i < KEY_SIZE; i++) {
+        Byte h, l;
+        if (!nibble(text[i*2], h) || !nibble(text[i*2+1], l)) {
+            return false;
+        }
+        key[i] = (h << 4) | l;
+    }
+    return true;
+}
+
+size_t MifareKeyDictionary::compile(std::istream & source, std::ostream & target)
+{
+    Bytes keys;
+    std::unordered_set<uint64_t> seen;
+    std::string line;
+
+    while (std::getline(source, line)) {
+        size_t pos = line.find('#');
+        if (pos != std::string::npos) {
+            line.erase(pos);
+        }
+
+        // text dictionary has one key per line, keys file has "SECTOR:KEY_A:KEY_B:USAGE"
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (start <= line.size()) {
+            size_t end = line.find(':', start);
+            if (end == std::string::npos) {
+                end = line.size();
+            }
+            std::string field;
+            for (size_t i = start; i < end; i++) {
+                if (!isspace(line[i])) {
+                    field.push_back(line[i]);
+                }
+            }
+            fields.push_back(field);
+            start = end + 1;
+        }
+        if (fields.size() == 4) {
+            fields.erase(fields.begin());
+            fields.pop_back();
+        } else if (fields.size() != 1) {
+            PRINT_DEBUG("[D] Unsupported keys line skipped: " << line);
+            continue;
+        }
+
+        for (auto it = fields.begin(); it != fields.end(); it++) {
+            Byte key[KEY_SIZE];
+            if (it->empty() || *it == "-") {
+                continue;
+            }
+            if (!parseKey(*it, key)) {
+                PRINT_DEBUG("[D] Invalid key skipped: " << *it);
+                continue;
+            }
+
+            uint64_t packed = 0;
+            for (size_t i = 0; i < KEY_SIZE; i++) {
+                packed = (packed << 8) | key[i];
+            }
+            if (!seen.insert(packed).second) {
+                continue;
+            }
+            keys.append(key, KEY_SIZE);
+        }
+    }
+
+    size_t count = keys.size() / KEY_SIZE;
+    Byte header[HEADER_SIZE];
+    memcpy(header, KEYDICT_MAGIC, sizeof(KEYDICT_MAGIC));
+    write_le32(header + 8, count);
+
+    target.write(reinterpret_cast<const char *>(header), sizeof(header));
+    target.write(reinterpret_cast<const char *>(keys.data()), keys.size());
+
+    if (!target) {
+        throw MifareKeyDictionaryError("Failed to write keys dictionary");
+    }
+
+    return count;
+}
+
+}
@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file keysearch.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * MIFARE Classic key search ordered by learned hit rates.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstring>
+#include <cstdio>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const size_t KEY_SIZE = 6;
+static const size_t MAX_SECTORS = 40;
+
+// well-known MIFARE Classic keys: factory defaults, transport and
+// public samples, most common ones first
+static const char * DEFAULT_KEYS[] = {
+    "ffffffffffff", "a0a1a2a3a4a5", "b0b1b2b3b4b5", "d3f7d3f7d3f7",
+    "000000000000", "aabbccddeeff", "4d3a99c351dd", "1a982c7e459a",
+    "714c5c886e97", "587ee5f9350f", "a0478cc39091", "533cb6c723f6",
+    "8fd0a4f256e9", "a5a4a3a2a1a0", "a0b0c0d0e0f0", "a1b1c1d1e1f1",
+    "fc00018778f7", "00000ffe2488", "5c598c9c58b5", "e4d2770a89be",
+    "434f4d4d4f41", "434f4d4d4f42", "47524f555041", "47524f555042",
+    "505249564141", "505249564142", "0297927c0f77", "ee0042f88840",
+    "722bfcc5375f", "f1d83f964314", "54726176656c", "776974687573",
+    "4b0b20107ccb", "6e6f20797574", "010203040506", "123456789abc",
+    "abcdef123456", "111111111111", "222222222222", "333333333333",
+    "444444444444", "555555555555", "666666666666", "777777777777",
+    "888888888888", "999999999999", "aaaaaaaaaaaa", "bbbbbbbbbbbb",
+    "cccccccccccc", "dddddddddddd", "eeeeeeeeeeee", "0123456789ab"
+};
+
+// 48-bit key packed into integer, used as map key
+typedef uint64_t PackedKey;
+
+static PackedKey pack_key(const Byte * key)
+{
+    PackedKey k = 0;
+    for (size_t i = 0; i < KEY_SIZE; i++) {
+        k = (k << 8) | key[i];
+    }
+    return k;
+}
+
+static void unpack_key(PackedKey k, Byte * key)
+{
+    for (size_t i = KEY_SIZE; i > 0; i--) {
+        key[i - 1] = k & 0xFF;
+        k >>= 8;
+    }
+}
+
+struct KeyCounter {
+    unsigned long hits;
+    unsigned long tries;
+
+    KeyCounter() : hits(0), tries(0) {}
+};
+
+typedef std::unordered_map<PackedKey, KeyCounter> KeyCounters;
+
+struct FamilyStats {
+    KeyCounters sectors[MAX_SECTORS];
+    KeyCounters all;
+};
+
+// Laplace-smoothed hit rate with prior taken from coarser statistics
+static double smoothed_rate(const KeyCounters & counters, PackedKey key, double prior)
+{
+    const double weight = 2.0;
+    auto it = counters.find(key);
+    if (it == counters.end()) {
+        return prior;
+    }
+    return (it->second.hits + weight * prior) / (it->second.tries + weight);
+}
+
+// run of dictionary keys: compiled dictionary used in place or keys added one by one
+struct KeySource {
+    const MifareKeyDictionary * dictionary;
+    // packed 6-byte keys when dictionary is 0, the same layout as in compiled file
+    Bytes keys;
+
+    KeySource(const MifareKeyDictionary * d) : dictionary(d) {}
+
+    size_t size() const {
+        return dictionary ? dictionary->size() : keys.size() / KEY_SIZE;
+    }
+    const Byte * key(size_t i) const {
+        return dictionary ? dictionary->key(i) : keys.data() + i*KEY_SIZE;
+    }
+};
+
+struct MifareKeySearch::Private
+{
+    std::vector<KeySource> sources;
+    // dictionaries opened by load_keys()
+    std::vector<std::unique_ptr<MifareKeyDictionary> > dictionaries;
+    // keys added one by one, so they are not repeated
+    std::unordered_set<PackedKey> added;
+    size_t size;
+
+    std::map<std::string, FamilyStats> families;
+    KeyCounters global;
+
+    size_t last_attempts;
+};
+
+MifareKeySearch::MifareKeySearch()
+{
+    p = new Private;
+    p->size = 0;
+    p->last_attempts = 0;
+
+    for (size_t i = 0; i < sizeof(DEFAULT_KEYS) / sizeof(DEFAULT_KEYS[0]); i++) {
+        add_key(parse_apdu(DEFAULT_KEYS[i]).data());
+    }
+}
+
+MifareKeySearch::~MifareKeySearch()
+{
+    delete p;
+}
+
+void MifareKeySearch::add_key(const Byte * key)
+{
+    if (!p->added.insert(pack_key(key)).second) {
+        return;
+    }
+    if (p->sources.empty() || p->sources.back().dictionary != 0) {
+        p->sources.push_back(KeySource(0));
+    }
+    p->sources.back().keys.append(key, KEY_SIZE);
+    p->size++;
+}
+
+void MifareKeySearch::add_keys(const MifareKeyDictionary & dictionary)
+{
+    p->sources.push_back(KeySource(&dictionary));
+    p->size += dictionary.size();
+}
+
+size_t MifareKeySearch::load_keys(const std::string & path)
+{
+    if (MifareKeyDictionary::is_compiled(path)) {
+        std::unique_ptr<MifareKeyDictionary> dictionary(new MifareKeyDictionary);
+        dictionary->open(path);
+        add_keys(*dictionary);
+        p->dictionaries.push_back(std::move(dictionary));
+        return p->dictionaries.back()->size();
+    }
+
+    std::ifstream file(path);
+    std::string line;
+    size_t count = 0;
+
+    while (std::getline(file, line)) {
+        size_t pos = line.find('#');
+        if (pos != std::string::npos) {
+            line.erase(pos);
+        }
+        line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+        if (line.empty()) {
+            continue;
+        }
+
+        Bytes key;
+        try {
+            key = parse_apdu(line);
+        } catch (APDUParseError & e) {
+            PRINT_DEBUG("[D] Invalid key line: " << line);
+            continue;
+        }
+        if (key.size() != KEY_SIZE) {
+            PRINT_DEBUG("[D] Invalid key length: " << line);
+            continue;
+        }
+        add_key(key.data());
+        count++;
+    }
+
+    return count;
+}
+
+size_t MifareKeySearch::size() const
+{
+    return p->size;
+}
+
+bool MifareKeySearch::load_stats(const std::string & path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.at(0) == '#') {
+            continue;
+        }
+
+        std::istringstream s(line);
+        std::string family;
+        unsigned int sector;
+        std::string key_str;
+        KeyCounter counter;
+
+        if (!(s >> family >> sector >> key_str >> counter.hits >> counter.tries)
+            || sector >= MAX_SECTORS || counter.hits > counter.tries)
+        {
+            return false;
+        }
+
+        Bytes key;
+        try {
+            key = parse_apdu(key_str);
+        } catch (APDUParseError & e) {
+            return false;
+        }
+        if (key.size() != KEY_SIZE) {
+            return false;
+        }
+
+        PackedKey k = pack_key(key.data());
+        FamilyStats & fs = p->families[family];
+        KeyCounter * counters[3] = {&fs.sectors[sector][k], &fs.all[k], &p->global[k]};
+        for (size_t i = 0; i < 3; i++) {
+            counters[i]->hits += counter.hits;
+            counters[i]->tries += counter.tries;
+        }
+
+        // keys that worked before are worth trying even if not in dictionary
+        add_key(key.data());
+    }
+
+    return true;
+}
+
+bool MifareKeySearch::save_stats(const std::string & path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char key_str[KEY_SIZE * 2 + 1];
+    file << "# family sector key hits tries" << std::endl;
+    for (auto fi = p->families.begin(); fi != p->families.end(); fi++) {
+        for (size_t sector = 0; sector < MAX_SECTORS; sector++) {
+            const KeyCounters & counters = fi->second.sectors[sector];
+            for (auto ki = counters.begin(); ki != counters.end(); ki++) {
+                snprintf(key_str, sizeof(key_str), "%012llx", (unsigned long long)ki->first);
+                file << fi->first << ' ' << sector << ' ' << key_str << ' '
+                    << ki->second.hits << ' ' << ki->second.tries << std::endl;
+            }
+        }
+    }
+
+    return file.good();
+}
+
+// score of tried key, negative so the best keys are first; ties are ordered by key
+typedef std::pair<double, PackedKey> ScoredKey;
+
+// Calls f(key) for dictionary keys of the sector, best first, until it returns true;
+// keys repeated in several sources are passed once. Only tried keys have rate
+// different from prior: those with hits are tried first, then the rest of dictionary
+// is walked in place, keys that only failed go last. Stats must not change meanwhile.
+template <typename F>
+static void for_each_candidate(const std::vector<KeySource> & sources, const KeyCounters & global,
+    const FamilyStats & fs, Byte sector, F f)
+{
+    const KeyCounters & sector_counters = fs.sectors[sector < MAX_SECTORS ? sector : 0];
+    const double prior = 0.5;
+    std::unordered_set<PackedKey> seen;
+    Byte key[KEY_SIZE];
+
+    auto score = [&](PackedKey k) {
+        double rate = smoothed_rate(global, k, prior);
+        rate = smoothed_rate(fs.all, k, rate);
+        rate = smoothed_rate(sector_counters, k, rate);
+        return ScoredKey(-rate, k);
+    };
+
+    // keys that never hit anywhere have rate below prior, so they are scored only if needed
+    std::vector<ScoredKey> best;
+    for (auto it = global.begin(); it != global.end(); it++) {
+        if (it->second.hits != 0) {
+            best.push_back(score(it->first));
+        }
+    }
+    std::sort(best.begin(), best.end());
+
+    for (auto si = best.begin(); si != best.end() && -si->first > prior; si++) {
+        seen.insert(si->second);
+        unpack_key(si->second, key);
+        if (f(key)) {
+            return;
+        }
+    }
+
+    for (auto src = sources.begin(); src != sources.end(); src++) {
+        size_t count = src->size();
+        for (size_t i = 0; i < count; i++) {
+            const Byte * k = src->key(i);
+            PackedKey packed = pack_key(k);
+            if (global.count(packed) == 0 && seen.insert(packed).second && f(k)) {
+                return;
+            }
+        }
+    }
+
+    std::vector<ScoredKey> rest;
+    rest.reserve(global.size());
+    for (auto it = global.begin(); it != global.end(); it++) {
+        if (seen.count(it->first) == 0) {
+            rest.push_back(score(it->first));
+        }
+    }
+    std::sort(rest.begin(), rest.end());
+
+    for (auto si = rest.begin(); si != rest.end(); si++) {
+        unpack_key(si->second, key);
+        if (f(key)) {
+            return;
+        }
+    }
+}
+
+static const FamilyStats & family_stats(const std::map<std::string, FamilyStats> & families, const std::string & family)
+{
+    static const FamilyStats empty;
+
+    auto fi = families.find(family);
+    return (fi == families.end()) ? empty : fi->second;
+}
+
+void MifareKeySearch::candidates(const std::string & family, Byte sector, std::vector<Bytes> & keys) const
+{
+    keys.clear();
+    for_each_candidate(p->sources, p->global, family_stats(p->families, family), sector,
+        [&keys](const Byte * key) {
+            keys.push_back(Bytes(key, KEY_SIZE));
+            return false;
+        });
+}
+
+void MifareKeySearch::record(const std::string & family, Byte sector, const Byte * key, bool hit)
+{
+    if (sector >= MAX_SECTORS) {
+        return;
+    }
+
+    PackedKey k = pack_key(key);
+    FamilyStats & fs = p->families[family];
+    KeyCounter * counters[3] = {&fs.sectors[sector][k], &fs.all[k], &p->global[k]};
+    for (size_t i = 0; i < 3; i++) {
+        counters[i]->tries++;
+        if (hit) {
+            counters[i]->hits++;
+        }
+    }
+}
+
+bool MifareKeySearch::search(MifareClassicSession & session, const std::string & family, Byte sector,
+    MifareKeyType & key_type, Bytes & key)
+{
+    const Byte block = mifare_sector_first_block(sector);
+    const MifareKeyType types[2] = {MifareKeyB, MifareKeyA};
+    Bytes data;
+    bool found = false;
+    std::vector<Bytes> tried;
+
+    p->last_attempts = 0;
+    for_each_candidate(p->sources, p->global, family_stats(p->families, family), sector,
+        [&](const Byte * k) {
+            p->last_attempts++;
+            tried.push_back(Bytes(k, KEY_SIZE));
+            for (size_t t = 0; t < 2; t++) {
+                // key B authenticates but can't read when it's readable itself (e.g. FF 07 80 trailer),
+                // read drops authentication, so key A is tried next
+                if (session.authenticate(block, types[t], k) && session.read_block(block, data)) {
+                    key_type = types[t];
+                    key.assign(k, KEY_SIZE);
+                    found = true;
+                    break;
+                }
+            }
+            return found;
+        });
+
+    // candidates order depends on stats, so they are updated after the walk
+    for (auto it = tried.begin(); it != tried.end(); it++) {
+        record(family, sector, it->data(), found && it + 1 == tried.end());
+    }
+
+    return found;
+}
+
+size_t MifareKeySearch::last_attempts() const
+{
+    return p->last_attempts;
+}
+
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file lecache.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * READ RECORD Le values learned from previous reads.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+struct LeEntry {
+    std::string family;
+    Bytes aid;
+    Byte sfi;
+    Byte record;
+    Byte le;
+};
+
+static std::string entry_key(const std::string & family, const Bytes & aid, Byte sfi, Byte record)
+{
+    std::string key(family);
+    key += ' ';
+    key.append(aid.begin(), aid.end());
+    key += static_cast<char>(sfi);
+    key += static_cast<char>(record);
+    return key;
+}
+
+struct LeCache::Private
+{
+    std::unordered_map<std::string, LeEntry> entries;
+    bool modified;
+};
+
+LeCache::LeCache()
+{
+    p = new Private;
+    p->modified = false;
+}
+
+LeCache::~LeCache()
+{
+    delete p;
+}
+
+bool LeCache::load(const std::string & path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.at(0) == '#') {
+            continue;
+        }
+
+        std::istringstream s(line);
+        std::string aid_str;
+        unsigned int sfi;
+        unsigned int record;
+        unsigned int le;
+        LeEntry e;
+
+        if (!(s >> e.family >> aid_str >> sfi >> record >> le)
+            || sfi > 30 || record > 0xFF || le == 0 || le > 0xFF)
+        {
+            return false;
+        }
+
+        try {
+            e.aid = parse_apdu(aid_str);
+        } catch (APDUParseError & ex) {
+            return false;
+        }
+
+        e.sfi = sfi;
+        e.record = record;
+        e.le = le;
+        p->entries[entry_key(e.family, e.aid, e.sfi, e.record)] = e;
+    }
+
+    p->modified = false;
+    return true;
+}
+
+bool LeCache::save(const std::string & path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "# family aid sfi record le" << std::endl;
+    for (auto i = p->entries.begin(); i != p->entries.end(); i++) {
+        const LeEntry & e = i->second;
+        std::string aid = format(e.aid);
+        aid.erase(std::remove(aid.begin(), aid.end(), ' '), aid.end());
+        file << e.family << ' ' << aid << ' ' << int(e.sfi) << ' '
+            << int(e.record) << ' ' << int(e.le) << std::endl;
+    }
+
+    return file.good();
+}
+
+Byte LeCache::lookup(const std::string & family, const Bytes & aid, Byte sfi, Byte record) const
+{
+    auto i = p->entries.find(entry_key(family, aid, sfi, record));
+    return (i == p->entries.end()) ? 0 : i->second.le;
+}
+
+void LeCache::store(const std::string & family, const Bytes & aid, Byte sfi, Byte record, Byte le)
+{
+    if (le == 0) {
+        return;
+    }
+
+    LeEntry & e = p->entries[entry_key(family, aid, sfi, record)];
+    if (e.le == le && e.family == family) {
+        return;
+    }
+
+    e.family = family;
+    e.aid = aid;
+    e.sfi = sfi;
+    e.record = record;
+    e.le = le;
+    p->modified = true;
+}
+
+size_t LeCache::size() const
+{
+    return p->entries.size();
+}
+
+bool LeCache::modified() const
+{
+    return p->modified;
+}
+
+}
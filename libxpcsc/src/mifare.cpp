@@ -0,0 +1,516 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file mifare.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * MIFARE Classic commands, see PC/SC specification part 3, section 3.2.2.1
+ * and ACR122U API documentation.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+// template for Load Keys command
+static const Byte CMD_LOAD_KEYS[] = {0xFF, 0x82, 0x00, 0x00, 
+    0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+// template for General Auth command
+static const Byte CMD_GENERAL_AUTH[] = {0xFF, 0x86, 0x00, 0x00, 
+    0x05, 0x01, 0x00, 0x00, 0x60, 0x00};
+
+// template for Read Binary command
+static const Byte CMD_READ_BINARY[] = {0xFF, 0xB0, 0x00, 0x00, 0x10};
+
+// template for Update Binary command
+static const Byte CMD_UPDATE_BINARY[] = {0xFF, 0xD6, 0x00, 0x00, 0x10};
+
+// Get Data command, card UID
+static const Byte CMD_GET_UID[] = {0xFF, 0xCA, 0x00, 0x00, 0x00};
+
+// template for Value Block Operation command (ACR122), value is MSB first
+static const Byte CMD_VALUE_OPERATION[] = {0xFF, 0xD7, 0x00, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+// template for Restore Value Block command (ACR122), restore and transfer
+static const Byte CMD_RESTORE_VALUE[] = {0xFF, 0xD7, 0x00, 0x00,
+    0x02, 0x03, 0x00};
+
+// template for Read Value Block command (ACR122)
+static const Byte CMD_READ_VALUE[] = {0xFF, 0xB1, 0x00, 0x00, 0x04};
+
+enum ValueOperation {
+    ValueStore = 0x00,
+    ValueIncrement = 0x01,
+    ValueDecrement = 0x02
+};
+
+static const size_t KEY_SIZE = 6;
+static const size_t BLOCK_SIZE = 16;
+static const size_t MAX_KEY_SLOTS = 16;
+
+Byte mifare_block_sector(Byte block)
+{
+    // 4K cards: sectors 32-39 consist of 16 blocks
+    if (block >= 128) {
+        return 32 + (block - 128) / 16;
+    }
+    return block / 4;
+}
+
+Byte mifare_sector_first_block(Byte sector)
+{
+    // 4K card: 32 sectors of 4 blocks, then 8 sectors of 16 blocks
+    if (sector >= 32) {
+        return 128 + (sector - 32) * 16;
+    }
+    return sector * 4;
+}
+
+Byte mifare_sector_blocks(Byte sector)
+{
+    return (sector >= 32) ? 16 : 4;
+}
+
+Byte mifare_block_access_group(Byte block)
+{
+    Byte sector = mifare_block_sector(block);
+    Byte index = block - mifare_sector_first_block(sector);
+
+    if (mifare_sector_blocks(sector) == 16) {
+        return (index == 15) ? 3 : index / 5;
+    }
+    return index;
+}
+
+Byte mifare_sectors(const ATRClassification & classification)
+{
+    if (classification.features & ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_4K)) {
+        return 40;
+    }
+    if (classification.features & ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_1K)) {
+        return 16;
+    }
+    if (classification.features & ATR_FEATURE_BIT(ATR_FEATURE_MIFARE_MINI)) {
+        return 5;
+    }
+    return 0;
+}
+
+void mifare_plan_read(const BlocksAccessBits & bits, MifareKeyType current,
+    Byte available_keys, MifareReadPlan & plan)
+{
+    Byte current_mask = (current == MifareKeyA) ? MifareAccessKeyA : MifareAccessKeyB;
+    MifareKeyType other = (current == MifareKeyA) ? MifareKeyB : MifareKeyA;
+    Byte other_mask = (current == MifareKeyA) ? MifareAccessKeyB : MifareAccessKeyA;
+
+    plan.authentications = 0;
+    for (size_t i = 0; i < 4; i++) {
+        Byte keys = mifare_read_access(bits, i) & available_keys;
+
+        if (keys & current_mask) {
+            plan.block_key[i] = current;
+        } else if (keys & other_mask) {
+            plan.block_key[i] = other;
+            plan.authentications = 1;
+        } else {
+            plan.block_key[i] = MifareKeyNone;
+        }
+    }
+}
+
+Bytes mifare_value_block(int32_t value, Byte address)
+{
+    Bytes block(BLOCK_SIZE, 0);
+    uint32_t v = static_cast<uint32_t>(value);
+
+    for (size_t i = 0; i < 4; i++) {
+        Byte b = (v >> (8 * i)) & 0xFF;
+        block[i] = b;
+        block[4 + i] = ~b;
+        block[8 + i] = b;
+    }
+    block[12] = address;
+    block[13] = ~address;
+    block[14] = address;
+    block[15] = ~address;
+    return block;
+}
+
+struct MifareClassicSession::Private
+{
+    Connection * c;
+    Reader reader;
+
+    // reader key slots contents
+    struct KeySlot {
+        bool loaded;
+        Byte key[KEY_SIZE];
+        // for LRU replacement
+        unsigned long used;
+    };
+    KeySlot slots[MAX_KEY_SLOTS];
+    Byte slots_count;
+    unsigned long tick;
+
+    // current authentication state
+    bool authenticated;
+    Byte sector;
+    MifareKeyType key_type;
+    Byte auth_key[KEY_SIZE];
+
+    unsigned long sent;
+    unsigned long avoided;
+
+    // multi-block READ BINARY support: -1 unknown, 0 no, 1 yes
+    int multi_block;
+
+    Bytes command;
+    Bytes response;
+
+    bool send() {
+        sent++;
+        c->transmit(reader, command, &response);
+        return c->response_status(response) == 0x9000;
+    }
+
+    bool value_operation(Byte block, ValueOperation op, uint32_t value) {
+        command.assign(CMD_VALUE_OPERATION, sizeof(CMD_VALUE_OPERATION));
+        command[3] = block;
+        command[5] = op;
+        for (size_t i = 0; i < 4; i++) {
+            command[6 + i] = (value >> (8 * (3 - i))) & 0xFF;
+        }
+
+        if (!send()) {
+            authenticated = false;
+            return false;
+        }
+        return true;
+    }
+
+    // slot holding the key or slot to replace
+    Byte find_slot(const Byte * key) {
+        Byte found = 0;
+        for (Byte i = 0; i < slots_count; i++) {
+            if (!slots[i].loaded) {
+                if (slots[found].loaded) {
+                    found = i;
+                }
+                continue;
+            }
+            if (memcmp(slots[i].key, key, KEY_SIZE) == 0) {
+                return i;
+            }
+            if (slots[found].loaded && slots[i].used < slots[found].used) {
+                found = i;
+            }
+        }
+        return found;
+    }
+};
+
+MifareClassicSession::MifareClassicSession(Connection & c, const Reader & reader, Byte key_slots)
+{
+    p = new Private;
+    p->c = &c;
+    p->reader = reader;
+    p->slots_count = (key_slots == 0) ? 1 : std::min<size_t>(key_slots, MAX_KEY_SLOTS);
+    p->tick = 0;
+    reset();
+}
+
+MifareClassicSession::~MifareClassicSession()
+{
+    delete p;
+}
+
+void MifareClassicSession::card_changed(const Reader & reader)
+{
+    p->reader = reader;
+    p->authenticated = false;
+    p->sent = 0;
+    p->avoided = 0;
+}
+
+void MifareClassicSession::reset()
+{
+    for (size_t i = 0; i < MAX_KEY_SLOTS; i++) {
+        p->slots[i].loaded = false;
+    }
+    p->multi_block = -1;
+    card_changed(p->reader);
+}
+
+bool MifareClassicSession::read_uid(Bytes & uid)
+{
+    p->command.assign(CMD_GET_UID, sizeof(CMD_GET_UID));
+    if (!p->send()) {
+        return false;
+    }
+
+    uid = p->c->response_data(p->response);
+    return true;
+}
+
+bool MifareClassicSession::load_key(const Byte * key, Byte slot)
+{
+    if (slot >= MAX_KEY_SLOTS) {
+        return false;
+    }
+
+    Private::KeySlot & ks = p->slots[slot];
+    ks.used = ++p->tick;
+
+    if (ks.loaded && memcmp(ks.key, key, KEY_SIZE) == 0) {
+        p->avoided++;
+        return true;
+    }
+
+    p->command.assign(CMD_LOAD_KEYS, sizeof(CMD_LOAD_KEYS));
+    p->command[3] = slot;
+    p->command.replace(5, KEY_SIZE, key, KEY_SIZE);
+
+    // slot contents is unknown until reader confirms
+    ks.loaded = false;
+    if (!p->send()) {
+        return false;
+    }
+
+    ks.loaded = true;
+    memcpy(ks.key, key, KEY_SIZE);
+    return true;
+}
+
+bool MifareClassicSession::authenticate(Byte block, MifareKeyType key_type, const Byte * key)
+{
+    Byte sector = mifare_block_sector(block);
+
+    if (p->authenticated && p->sector == sector && p->key_type == key_type
+        && memcmp(p->auth_key, key, KEY_SIZE) == 0)
+    {
+        // neither LOAD KEYS nor GENERAL AUTHENTICATE is required
+        p->avoided += 2;
+        return true;
+    }
+
+    Byte slot = p->find_slot(key);
+    while (!load_key(key, slot)) {
+        if (slot == 0) {
+            return false;
+        }
+        // reader doesn't have that many key slots, use fewer
+        PRINT_DEBUG("[D] Key slot " << int(slot) << " is not supported by reader");
+        p->slots_count = slot;
+        slot = p->find_slot(key);
+    }
+
+    p->command.assign(CMD_GENERAL_AUTH, sizeof(CMD_GENERAL_AUTH));
+    p->command[7] = block;
+    p->command[8] = key_type;
+    p->command[9] = slot;
+
+    // card drops authentication state on failure
+    p->authenticated = false;
+    if (!p->send()) {
+        PRINT_DEBUG("[D] Authentication failed, block " << int(block));
+        return false;
+    }
+
+    p->authenticated = true;
+    p->sector = sector;
+    p->key_type = key_type;
+    memcpy(p->auth_key, key, KEY_SIZE);
+    return true;
+}
+
+bool MifareClassicSession::read_block(Byte block, Bytes & data)
+{
+    p->command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
+    p->command[3] = block;
+
+    if (!p->send() || p->response.size() != BLOCK_SIZE + 2) {
+        p->authenticated = false;
+        return false;
+    }
+
+    data.assign(p->response, 0, BLOCK_SIZE);
+    return true;
+}
+
+bool MifareClassicSession::read_blocks(Byte block, Byte count, Bytes & data)
+{
+    Bytes block_data;
+
+    if (count == 0 || count * BLOCK_SIZE > 0xFF
+        || mifare_block_sector(block) != mifare_block_sector(block + count - 1))
+    {
+        return false;
+    }
+
+    if (count > 1 && p->multi_block != 0) {
+        // authentication to restore after failed probe
+        bool authenticated = p->authenticated && p->sector == mifare_block_sector(block);
+        MifareKeyType key_type = p->key_type;
+        Byte key[KEY_SIZE];
+        memcpy(key, p->auth_key, KEY_SIZE);
+
+        p->command.assign(CMD_READ_BINARY, sizeof(CMD_READ_BINARY));
+        p->command[3] = block;
+        p->command[4] = count * BLOCK_SIZE;
+
+        if (p->send() && p->response.size() == count * BLOCK_SIZE + 2) {
+            p->multi_block = 1;
+            data.assign(p->response, 0, count * BLOCK_SIZE);
+            return true;
+        }
+
+        // card drops authentication state on failed read
+        p->authenticated = false;
+        if (p->multi_block == 1) {
+            // reader is capable, so blocks are not readable
+            return false;
+        }
+
+        // blocks could be unreadable with current key, so capability is known
+        // only after block by block reading succeeds
+        if (!authenticated || !authenticate(mifare_sector_first_block(mifare_block_sector(block)), key_type, key)) {
+            return false;
+        }
+    }
+
+    data.clear();
+    for (Byte i = 0; i < count; i++) {
+        if (!read_block(block + i, block_data)) {
+            return false;
+        }
+        data.append(block_data);
+    }
+
+    if (count > 1 && p->multi_block == -1) {
+        PRINT_DEBUG("[D] Multi-block reads are not supported by reader");
+        p->multi_block = 0;
+    }
+    return true;
+}
+
+void MifareClassicSession::set_multi_block_read(bool enabled)
+{
+    p->multi_block = enabled ? -1 : 0;
+}
+
+bool MifareClassicSession::multi_block_read() const
+{
+    return p->multi_block != 0;
+}
+
+bool MifareClassicSession::update_block(Byte block, const Bytes & data)
+{
+    if (data.size() != BLOCK_SIZE) {
+        return false;
+    }
+
+    p->command.assign(CMD_UPDATE_BINARY, sizeof(CMD_UPDATE_BINARY));
+    p->command[3] = block;
+    p->command.append(data);
+
+    if (!p->send()) {
+        p->authenticated = false;
+        return false;
+    }
+    return true;
+}
+
+bool MifareClassicSession::store_value(Byte block, int32_t value)
+{
+    return p->value_operation(block, ValueStore, static_cast<uint32_t>(value));
+}
+
+bool MifareClassicSession::read_value(Byte block, int32_t & value)
+{
+    p->command.assign(CMD_READ_VALUE, sizeof(CMD_READ_VALUE));
+    p->command[3] = block;
+
+    // reader rejects blocks that are not in value block format
+    if (!p->send() || p->response.size() != 4 + 2) {
+        p->authenticated = false;
+        return false;
+    }
+
+    uint32_t v = 0;
+    for (size_t i = 0; i < 4; i++) {
+        v = (v << 8) | p->response[i];
+    }
+    value = static_cast<int32_t>(v);
+    return true;
+}
+
+bool MifareClassicSession::increment_value(Byte block, uint32_t amount)
+{
+    return p->value_operation(block, ValueIncrement, amount);
+}
+
+bool MifareClassicSession::decrement_value(Byte block, uint32_t amount)
+{
+    return p->value_operation(block, ValueDecrement, amount);
+}
+
+bool MifareClassicSession::restore_value(Byte source, Byte target)
+{
+    if (mifare_block_sector(source) != mifare_block_sector(target)) {
+        return false;
+    }
+
+    p->command.assign(CMD_RESTORE_VALUE, sizeof(CMD_RESTORE_VALUE));
+    p->command[3] = source;
+    p->command[6] = target;
+
+    if (!p->send()) {
+        p->authenticated = false;
+        return false;
+    }
+    return true;
+}
+
+unsigned long MifareClassicSession::apdus_sent() const
+{
+    return p->sent;
+}
+
+unsigned long MifareClassicSession::apdus_avoided() const
+{
+    return p->avoided;
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file timing.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * Rough model of APDU transfer time on the wire.
+ */
+
+#include "../include/xpcsc.hpp"
+
+namespace xpcsc {
+
+// typical reader clock, MHz; ISO 7816-3 allows 1..5 MHz during activation
+static const double DEFAULT_CLOCK = 4.0;
+
+// ISO 14443 default bit rate, kbit/s
+static const double PICC_BIT_RATE = 106.0;
+
+// ISO 14443 frame delay time and reader overhead per frame, microseconds
+static const double PICC_FRAME_DELAY = 100.0;
+
+// T=1 default information field size for the card
+static const size_t T1_IFSC = 32;
+
+static size_t t1_blocks(size_t size)
+{
+    return size == 0 ? 1 : (size + T1_IFSC - 1) / T1_IFSC;
+}
+
+unsigned long estimate_transfer_time(const ATRInfo & info, int protocol,
+    size_t command_size, size_t response_size)
+{
+    if (info.is_picc) {
+        // each byte takes 9 bits (8 data + parity), every frame adds PCB and CRC
+        double bytes = command_size + response_size + 6;
+        return static_cast<unsigned long>(bytes * 9 * 1000 / PICC_BIT_RATE + 2 * PICC_FRAME_DELAY);
+    }
+
+    int fi = info.fi > 0 ? info.fi : 372;
+    int di = info.di > 0 ? info.di : 1;
+    double clock = DEFAULT_CLOCK;
+    if (info.f_max > 0 && info.f_max < clock) {
+        clock = info.f_max;
+    }
+
+    // elementary time unit, microseconds
+    double etu = fi / (di * clock);
+
+    // character frame is 12 etu plus extra guard time N,
+    // N=255 means minimal frame: 12 etu for T=0 and 11 etu for T=1
+    double char_time;
+    if (info.extra_guard_time == 255) {
+        char_time = (protocol == 1) ? 11 : 12;
+    } else {
+        char_time = 12 + info.extra_guard_time;
+    }
+
+    double chars;
+    if (protocol == 1) {
+        // prologue (NAD, PCB, LEN) and LRC epilogue in every block,
+        // each chained block is acknowledged by 4 bytes R-block
+        size_t cmd_blocks = t1_blocks(command_size);
+        size_t resp_blocks = t1_blocks(response_size);
+        chars = command_size + response_size
+            + 4 * (cmd_blocks + resp_blocks)
+            + 4 * (cmd_blocks - 1 + resp_blocks - 1);
+        // block guard time 22 etu between blocks of opposite direction
+        chars += 22.0 * (cmd_blocks + resp_blocks) / char_time;
+    } else {
+        // procedure byte after header, response data is fetched
+        // with separate GET RESPONSE (5 bytes header + procedure byte)
+        chars = command_size + 1 + response_size;
+        if (response_size > 2) {
+            chars += 5 + 1 + 2;
+        }
+    }
+
+    return static_cast<unsigned long>(chars * char_time * etu);
+}
+
+}
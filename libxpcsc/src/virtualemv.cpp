@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file virtualemv.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * EMV card emulation from profile file, see EMV 4.3 Book 1, section 11
+ * and Book 3, section 6.5 for commands.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <chrono>
+#include <thread>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte SW_OK[] = {0x90, 0x00};
+static const Byte SW_WRONG_LENGTH[] = {0x67, 0x00};
+static const Byte SW_CONDITIONS_NOT_SATISFIED[] = {0x69, 0x85};
+static const Byte SW_FILE_NOT_FOUND[] = {0x6A, 0x82};
+static const Byte SW_RECORD_NOT_FOUND[] = {0x6A, 0x83};
+static const Byte SW_INS_NOT_SUPPORTED[] = {0x6D, 0x00};
+
+static const Byte SELECT_NEXT = 0x02;
+
+// contact card, T=0, no historical bytes
+static const Byte DEFAULT_ATR[] = {0x3B, 0x60, 0x00, 0x00};
+
+const Bytes TAG_PDOL = {0x9F, 0x38};
+
+struct EMVFile {
+    Bytes name;
+    Bytes fci;
+    Bytes gpo;
+    // GET PROCESSING OPTIONS command data length expected
+    size_t pdol_length;
+    // key is (SFI << 8) | record
+    std::map<uint16_t, Bytes> records;
+};
+
+struct VirtualEMVCard::Private
+{
+    Bytes atr;
+    int protocol;
+    std::vector<EMVFile> files;
+
+    unsigned long latency;
+    unsigned long apdus;
+
+    // selected file index, -1 if none
+    int selected;
+    // T=0 response data waiting for GET RESPONSE
+    Bytes pending;
+
+    void clear() {
+        atr.assign(DEFAULT_ATR, sizeof(DEFAULT_ATR));
+        protocol = 0;
+        files.clear();
+        selected = -1;
+        pending.clear();
+    }
+
+    void answer(const Byte * command, size_t command_size, Bytes & response);
+    // response data of case 4 command (command data and response data)
+    void answer_data(const Bytes & data, Bytes & response);
+    // response data of case 2 command, "le" is requested length
+    void answer_data(const Bytes & data, Byte le, Bytes & response);
+};
+
+void VirtualEMVCard::Private::answer_data(const Bytes & data, Bytes & response)
+{
+    if (protocol == 0 && data.size() != 0) {
+        // T=0 can't return data of command with data, card asks for GET RESPONSE
+        pending = data;
+        response.push_back(0x61);
+        response.push_back(static_cast<Byte>(data.size()));
+        return;
+    }
+    response.assign(data);
+    response.append(SW_OK, 2);
+}
+
+void VirtualEMVCard::Private::answer_data(const Bytes & data, Byte le, Bytes & response)
+{
+    // Le 00 means 256 bytes for T=0 and "everything available" for T=1
+    if (data.size() > 0xFF || (static_cast<Byte>(data.size()) != le && (le != 0 || protocol == 0))) {
+        response.push_back(0x6C);
+        response.push_back(static_cast<Byte>(data.size()));
+        return;
+    }
+    response.assign(data);
+    response.append(SW_OK, 2);
+}
+
+void VirtualEMVCard::Private::answer(const Byte * command, size_t command_size, Bytes & response)
+{
+    response.clear();
+
+    if (command_size < 4) {
+        response.assign(SW_WRONG_LENGTH, 2);
+        return;
+    }
+
+    Byte ins = command[1];
+    Byte p1 = command[2];
+    Byte p2 = command[3];
+    size_t lc = (command_size > 5) ? command[4] : 0;
+    if (command_size > 5 && command_size < 5 + lc) {
+        response.assign(SW_WRONG_LENGTH, 2);
+        return;
+    }
+    Bytes data(command + 5, lc);
+    // Le of case 2 command
+    Byte le = (command_size == 5) ? command[4] : 0;
+
+    // GET RESPONSE is valid only right after "61xx"
+    Bytes pending_data;
+    pending_data.swap(pending);
+
+    if (ins == 0xC0) {
+        if (pending_data.empty()) {
+            response.assign(SW_CONDITIONS_NOT_SATISFIED, 2);
+            return;
+        }
+        answer_data(pending_data, le, response);
+        if (response.size() == 2) {
+            pending.swap(pending_data);
+        }
+        return;
+    }
+
+    if (ins == 0xA4 && p1 == 0x04) {
+        // SELECT by DF name, the first file or the next one with name starting with "data"
+        int start = 0;
+        if ((p2 & 0x03) == SELECT_NEXT && selected >= 0 && files[selected].name.compare(0, data.size(), data) == 0) {
+            start = selected + 1;
+        }
+        for (size_t i = start; i < files.size(); i++) {
+            if (files[i].name.compare(0, data.size(), data) == 0) {
+                selected = i;
+                answer_data(files[i].fci, response);
+                return;
+            }
+        }
+        response.assign(SW_FILE_NOT_FOUND, 2);
+        return;
+    }
+
+    if (ins == 0xA8 && command[0] == 0x80) {
+        if (selected < 0 || files[selected].gpo.empty()) {
+            response.assign(SW_CONDITIONS_NOT_SATISFIED, 2);
+            return;
+        }
+        // command template with PDOL data
+        const EMVFile & file = files[selected];
+        if (data.size() < 2 || data[0] != 0x83 || data[1] != data.size() - 2 || data[1] != file.pdol_length) {
+            response.assign(SW_WRONG_LENGTH, 2);
+            return;
+        }
+        answer_data(file.gpo, response);
+        return;
+    }
+
+    if (ins == 0xB2) {
+        if (selected < 0 || (p2 & 0x07) != 0x04) {
+            response.assign(SW_CONDITIONS_NOT_SATISFIED, 2);
+            return;
+        }
+        const EMVFile & file = files[selected];
+        auto r = file.records.find(((p2 >> 3) << 8) | p1);
+        if (r == file.records.end()) {
+            response.assign(SW_RECORD_NOT_FOUND, 2);
+            return;
+        }
+        answer_data(r->second, le, response);
+        return;
+    }
+
+    response.assign(SW_INS_NOT_SUPPORTED, 2);
+}
+
+// length of PDOL data: sum of data object lengths in FCI tag 9F38
+static size_t pdol_length(const Bytes & fci)
+{
+    std::unique_ptr<BerTlv> tlv(BerTlv::parse(fci));
+    std::vector<const BerTlv *> stack(1, tlv.get());
+    Bytes pdol;
+
+    while (!stack.empty()) {
+        const BerTlv * t = stack.back();
+        stack.pop_back();
+        if (t->is_raw()) {
+            if (t->get_tag() == TAG_PDOL) {
+                pdol = t->get_data();
+                break;
+            }
+            continue;
+        }
+        const BerTlvList & children = t->get_children();
+        for (auto i = children.begin(); i != children.end(); i++) {
+            stack.push_back(i->get());
+        }
+    }
+
+    // tags are skipped, the next byte is length
+    size_t length = 0;
+    for (size_t i = 0; i < pdol.size(); i++) {
+        if ((pdol[i] & 0x1F) == 0x1F) {
+            while (++i < pdol.size() && (pdol[i] & 0x80)) {
+            }
+        }
+        if (++i < pdol.size()) {
+            length += pdol[i];
+        }
+    }
+    return length;
+}
+
+static Bytes parse_name(const std::string & s)
+{
+    if (s.size() >= 2 && s[0] == '"' && s[s.size() - 1] == '"') {
+        return Bytes(s.begin() + 1, s.end() - 1);
+    }
+    return parse_apdu(s);
+}
+
+VirtualEMVCard::VirtualEMVCard()
+{
+    p = new Private;
+    p->latency = 0;
+    p->apdus = 0;
+    p->clear();
+}
+
+VirtualEMVCard::~VirtualEMVCard()
+{
+    delete p;
+}
+
+bool VirtualEMVCard::load(const std::string & path)
+{
+    std::ifstream file(path);
+    if (file.fail()) {
+        p->clear();
+        return false;
+    }
+    return load(file);
+}
+
+bool VirtualEMVCard::load(std::istream & profile)
+{
+    p->clear();
+
+    std::string line;
+    size_t line_number = 0;
+
+    try {
+        while (std::getline(profile, line)) {
+            line_number++;
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+
+            std::istringstream ss(line);
+            std::string keyword;
+            if (!(ss >> keyword)) {
+                continue;
+            }
+            std::string rest;
+            std::getline(ss >> std::ws, rest);
+            while (!rest.empty() && (rest[rest.size() - 1] == ' ' || rest[rest.size() - 1] == '\r')) {
+                rest.erase(rest.size() - 1);
+            }
+
+            if (keyword == "atr") {
+                p->atr = parse_apdu(rest);
+            } else if (keyword == "protocol" && (rest == "0" || rest == "1")) {
+                p->protocol = rest[0] - '0';
+            } else if (keyword == "file" && !rest.empty()) {
+                EMVFile file;
+                file.name = parse_name(rest);
+                file.pdol_length = 0;
+                p->files.push_back(file);
+            } else if (keyword == "fci" && !p->files.empty()) {
+                p->files.back().fci = parse_apdu(rest);
+                p->files.back().pdol_length = pdol_length(p->files.back().fci);
+            } else if (keyword == "gpo" && !p->files.empty()) {
+                p->files.back().gpo = parse_apdu(rest);
+            } else if (keyword == "record" && !p->files.empty()) {
+                std::istringstream rs(rest);
+                unsigned int sfi;
+                unsigned int number;
+                if (!(rs >> sfi >> number) || sfi == 0 || sfi > 30 || number == 0 || number > 0xFF) {
+                    throw std::invalid_argument("wrong SFI or record number");
+                }
+                std::getline(rs >> std::ws, rest);
+                p->files.back().records[(sfi << 8) | number] = parse_apdu(rest);
+            } else {
+                throw std::invalid_argument("unknown statement");
+            }
+        }
+    } catch (std::exception & e) {
+        PRINT_DEBUG("[D] Broken virtual card profile line " << line_number << ": " << e.what());
+        p->clear();
+        return false;
+    }
+
+    return !profile.bad();
+}
+
+void VirtualEMVCard::set_latency(unsigned long latency)
+{
+    p->latency = latency;
+}
+
+unsigned long VirtualEMVCard::apdus() const
+{
+    return p->apdus;
+}
+
+Bytes VirtualEMVCard::atr()
+{
+    return p->atr;
+}
+
+void VirtualEMVCard::power_up()
+{
+    p->selected = -1;
+    p->pending.clear();
+}
+
+void VirtualEMVCard::transmit(const Byte * command, size_t command_size, Bytes & response)
+{
+    p->apdus++;
+    if (p->latency != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(p->latency));
+    }
+    p->answer(command, command_size, response);
+}
+
+}
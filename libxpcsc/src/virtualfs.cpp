@@ -0,0 +1,681 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file virtualfs.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * ISO 7816-4 file system card emulation: SELECT, READ BINARY, READ RECORD
+ * and GET RESPONSE with T=0 and T=1 answers, see ISO/IEC 7816-4.
+ */
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include "../include/xpcsc.hpp"
+#include "mapped_file.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const Byte SW_OK[] = {0x90, 0x00};
+static const Byte SW_END_OF_FILE[] = {0x62, 0x82};
+static const Byte SW_WRONG_LENGTH[] = {0x67, 0x00};
+static const Byte SW_INCOMPATIBLE_FILE[] = {0x69, 0x81};
+static const Byte SW_CONDITIONS_NOT_SATISFIED[] = {0x69, 0x85};
+static const Byte SW_NO_CURRENT_EF[] = {0x69, 0x86};
+static const Byte SW_FILE_NOT_FOUND[] = {0x6A, 0x82};
+static const Byte SW_RECORD_NOT_FOUND[] = {0x6A, 0x83};
+static const Byte SW_WRONG_P1P2[] = {0x6B, 0x00};
+static const Byte SW_INS_NOT_SUPPORTED[] = {0x6D, 0x00};
+
+static const uint16_t MF_FID = 0x3F00;
+static const char RECORDS_SUFFIX[] = ".records";
+
+// T=0 and T=1 cards, no historical bytes
+static const Byte ATR_T0[] = {0x3B, 0x00};
+static const Byte ATR_T1[] = {0x3B, 0x80, 0x01, 0x81};
+
+typedef enum {
+    FSNodeDF = 0,
+    FSNodeTransparent,
+    FSNodeRecords
+} FSNodeType;
+
+struct FSNode {
+    uint16_t fid;
+    FSNodeType type;
+    // index in node list, -1 for MF
+    int parent;
+    std::vector<int> children;
+
+    // transparent EF contents, 0 for empty file
+    std::unique_ptr<MappedFile> file;
+    std::vector<Bytes> records;
+
+    size_t size() const {
+        return file ? file->size() : 0;
+    }
+};
+
+struct VirtualFileSystemCard::Private
+{
+    // MF is the first one
+    std::vector<FSNode> nodes;
+
+    int protocol;
+    bool extended_length;
+    unsigned long latency;
+    unsigned long apdus;
+
+    int current_df;
+    // -1 if none
+    int current_ef;
+    // T=0 response data waiting for GET RESPONSE
+    Bytes pending;
+    size_t pending_offset;
+
+    void clear() {
+        nodes.clear();
+        FSNode mf;
+        mf.fid = MF_FID;
+        mf.type = FSNodeDF;
+        mf.parent = -1;
+        nodes.push_back(std::move(mf));
+        current_df = 0;
+        current_ef = -1;
+        pending.clear();
+    }
+
+    bool load_dir(const std::string & path, int parent);
+
+    int child(int df, uint16_t fid) const {
+        const std::vector<int> & c = nodes[df].children;
+        for (auto i = c.begin(); i != c.end(); i++) {
+            if (nodes[*i].fid == fid) {
+                return *i;
+            }
+        }
+        return -1;
+    }
+
+    int find_sfi(Byte sfi) const {
+        const std::vector<int> & c = nodes[current_df].children;
+        for (auto i = c.begin(); i != c.end(); i++) {
+            if (nodes[*i].type != FSNodeDF && (nodes[*i].fid & 0x1F) == sfi) {
+                return *i;
+            }
+        }
+        return -1;
+    }
+
+    // DF becomes current one, EF becomes current EF in its parent DF
+    void make_current(int node) {
+        if (nodes[node].type == FSNodeDF) {
+            current_df = node;
+            current_ef = -1;
+        } else {
+            current_df = nodes[node].parent;
+            current_ef = node;
+        }
+    }
+
+    int select_fid(uint16_t fid) const;
+    Bytes fcp(int node) const;
+    void answer(const Byte * command, size_t command_size, Bytes & response);
+    // response data of case 4 command
+    void answer_data(const Bytes & data, Bytes & response);
+    // response data of case 2 command, "le" is requested length (65536 max),
+    // "partial" is true if data is shorter than requested because of file end
+    void answer_data(const Byte * data, size_t size, size_t le, bool partial, Bytes & response);
+};
+
+static bool parse_fid(const std::string & name, uint16_t & fid)
+{
+    if (name.size() < 4) {
+        return false;
+    }
+    fid = 0;
+    for (size_t i = 0; i < 4; i++) {
+        char c = tolower(name[i]);
+        if (c >= '0' && c <= '9') {
+            fid = (fid << 4) | (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            fid = (fid << 4) | (c - 'a' + 10);
+        } else {
+            return false;
+        }
+    }
+    // name continues with separator
+    return name.size() == 4 || !isxdigit(name[4]);
+}
+
+static bool has_suffix(const std::string & s, const char * suffix)
+{
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool VirtualFileSystemCard::Private::load_dir(const std::string & path, int parent)
+{
+    DIR * dir = opendir(path.c_str());
+    if (dir == 0) {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != 0) {
+        if (entry->d_name[0] != '.') {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    // stable FID order regardless of directory order
+    std::sort(names.begin(), names.end());
+
+    for (auto i = names.begin(); i != names.end(); i++) {
+        std::string full = path + "/" + *i;
+        uint16_t fid;
+        struct stat st;
+        if (!parse_fid(*i, fid) || fid == MF_FID || child(parent, fid) != -1 || stat(full.c_str(), &st) != 0) {
+            PRINT_DEBUG("[D] Wrong virtual card file: " << full);
+            return false;
+        }
+
+        FSNode node;
+        node.fid = fid;
+        node.parent = parent;
+
+        if (S_ISDIR(st.st_mode)) {
+            node.type = FSNodeDF;
+        } else if (has_suffix(*i, RECORDS_SUFFIX)) {
+            node.type = FSNodeRecords;
+            std::ifstream f(full);
+            std::string line;
+            while (std::getline(f, line)) {
+                if (line.size() != 0 && line[line.size() - 1] == '\r') {
+                    line.erase(line.size() - 1);
+                }
+                if (line.size() != 0) {
+                    node.records.push_back(parse_apdu(line));
+                }
+            }
+            if (f.bad() || node.records.size() > 0xFE) {
+                return false;
+            }
+        } else {
+            node.type = FSNodeTransparent;
+            if (st.st_size != 0) {
+                node.file.reset(new MappedFile);
+                if (!node.file->open(full)) {
+                    return false;
+                }
+            }
+        }
+
+        int index = nodes.size();
+        nodes.push_back(std::move(node));
+        nodes[parent].children.push_back(index);
+
+        if (nodes[index].type == FSNodeDF && !load_dir(full, index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// child of current DF, current DF itself, its parent or sibling, then MF
+int VirtualFileSystemCard::Private::select_fid(uint16_t fid) const
+{
+    if (fid == MF_FID) {
+        return 0;
+    }
+    int node = child(current_df, fid);
+    if (node != -1) {
+        return node;
+    }
+    if (nodes[current_df].fid == fid) {
+        return current_df;
+    }
+    int parent = nodes[current_df].parent;
+    if (parent != -1) {
+        if (nodes[parent].fid == fid) {
+            return parent;
+        }
+        node = child(parent, fid);
+        if (node != -1 && nodes[node].type == FSNodeDF) {
+            return node;
+        }
+    }
+    return -1;
+}
+
+Bytes VirtualFileSystemCard::Private::fcp(int node) const
+{
+    const FSNode & n = nodes[node];
+    Bytes content;
+
+    if (n.type == FSNodeTransparent) {
+        // file size, 4 bytes for large files
+        size_t size = n.size();
+        content.push_back(0x80);
+        if (size > 0xFFFF) {
+            content.push_back(4);
+            content.push_back((size >> 24) & 0xFF);
+            content.push_back((size >> 16) & 0xFF);
+        } else {
+            content.push_back(2);
+        }
+        content.push_back((size >> 8) & 0xFF);
+        content.push_back(size & 0xFF);
+    }
+
+    // file descriptor byte: DF, working transparent EF, working linear variable EF
+    content.push_back(0x82);
+    content.push_back(0x01);
+    content.push_back(n.type == FSNodeDF ? 0x38 : (n.type == FSNodeTransparent ? 0x01 : 0x04));
+
+    content.push_back(0x83);
+    content.push_back(0x02);
+    content.push_back(n.fid >> 8);
+    content.push_back(n.fid & 0xFF);
+
+    Bytes result;
+    result.push_back(0x62);
+    result.push_back(static_cast<Byte>(content.size()));
+    result.append(content);
+    return result;
+}
+
+void VirtualFileSystemCard::Private::answer_data(const Bytes & data, Bytes & response)
+{
+    if (protocol == 0 && data.size() != 0) {
+        // T=0 can't return data of command with data, card asks for GET RESPONSE
+        pending = data;
+        pending_offset = 0;
+        response.push_back(0x61);
+        response.push_back(data.size() > 0xFF ? 0x00 : static_cast<Byte>(data.size()));
+        return;
+    }
+    response.assign(data);
+    response.append(SW_OK, 2);
+}
+
+void VirtualFileSystemCard::Private::answer_data(const Byte * data, size_t size, size_t le, bool partial, Bytes & response)
+{
+    if (protocol == 0 && size != le && size != 0) {
+        // T=0: exact Le only
+        response.push_back(0x6C);
+        response.push_back(static_cast<Byte>(size));
+        return;
+    }
+    response.assign(data, size);
+    if (partial) {
+        response.append(SW_END_OF_FILE, 2);
+    } else {
+        response.append(SW_OK, 2);
+    }
+}
+
+void VirtualFileSystemCard::Private::answer(const Byte * command, size_t command_size, Bytes & response)
+{
+    response.clear();
+
+    if (command_size < 4) {
+        response.assign(SW_WRONG_LENGTH, 2);
+        return;
+    }
+
+    Byte ins = command[1];
+    Byte p1 = command[2];
+    Byte p2 = command[3];
+
+    // command body: Lc and data, Le; short or extended (T=1 only) length fields
+    size_t lc = 0;
+    size_t le = 0;
+    bool has_le = false;
+    const Byte * data = command + 5;
+    size_t body = command_size - 4;
+
+    if (body == 0) {
+    } else if (body == 1) {
+        has_le = true;
+        le = command[4] ? command[4] : 0x100;
+    } else if (command[4] != 0) {
+        lc = command[4];
+        if (body != 1 + lc && body != 2 + lc) {
+            response.assign(SW_WRONG_LENGTH, 2);
+            return;
+        }
+        if (body == 2 + lc) {
+            has_le = true;
+            le = command[command_size - 1] ? command[command_size - 1] : 0x100;
+        }
+    } else {
+        // extended length: 00 Le1 Le2 or 00 Lc1 Lc2 data [Le1 Le2]
+        if (protocol == 0 || !extended_length || body < 3) {
+            response.assign(SW_WRONG_LENGTH, 2);
+            return;
+        }
+        size_t n = (command[5] << 8) | command[6];
+        if (body == 3) {
+            has_le = true;
+            le = n ? n : 0x10000;
+        } else {
+            lc = n;
+            data = command + 7;
+            if (body != 3 + lc && body != 5 + lc) {
+                response.assign(SW_WRONG_LENGTH, 2);
+                return;
+            }
+            if (body == 5 + lc) {
+                has_le = true;
+                n = (command[command_size - 2] << 8) | command[command_size - 1];
+                le = n ? n : 0x10000;
+            }
+        }
+    }
+
+    // GET RESPONSE is valid only right after "61xx"
+    Bytes pending_data;
+    size_t pending_from = pending_offset;
+    pending_data.swap(pending);
+
+    if (ins == 0xC0) {
+        if (pending_from >= pending_data.size()) {
+            response.assign(SW_CONDITIONS_NOT_SATISFIED, 2);
+            return;
+        }
+        size_t available = pending_data.size() - pending_from;
+        if (!has_le || le > available) {
+            response.push_back(0x6C);
+            response.push_back(available > 0xFF ? 0x00 : static_cast<Byte>(available));
+            pending.swap(pending_data);
+            return;
+        }
+        response.assign(pending_data, pending_from, le);
+        available -= le;
+        if (available == 0) {
+            response.append(SW_OK, 2);
+        } else {
+            response.push_back(0x61);
+            response.push_back(available > 0xFF ? 0x00 : static_cast<Byte>(available));
+            pending.swap(pending_data);
+            pending_offset = pending_from + le;
+        }
+        return;
+    }
+
+    if (ins == 0xA4) {
+        int node = -1;
+        if (p1 == 0x00 && lc == 0) {
+            node = 0;
+        } else if (p1 == 0x00 && lc == 2) {
+            node = select_fid((data[0] << 8) | data[1]);
+        } else if (p1 == 0x03 && lc == 0) {
+            node = nodes[current_df].parent;
+        } else if ((p1 == 0x08 || p1 == 0x09) && lc != 0 && lc % 2 == 0) {
+            // path without MF
+            node = (p1 == 0x08) ? 0 : current_df;
+            for (size_t i = 0; i < lc && node != -1; i += 2) {
+                uint16_t fid = (data[i] << 8) | data[i+1];
+                if (nodes[node].type != FSNodeDF) {
+                    node = -1;
+                } else if (!(i == 0 && p1 == 0x08 && fid == MF_FID)) {
+                    node = child(node, fid);
+                }
+            }
+        } else {
+            response.assign(SW_WRONG_P1P2, 2);
+            return;
+        }
+
+        if (node == -1) {
+            response.assign(SW_FILE_NOT_FOUND, 2);
+            return;
+        }
+        make_current(node);
+        if ((p2 & 0x0C) == 0x0C) {
+            response.assign(SW_OK, 2);
+        } else {
+            answer_data(fcp(node), response);
+        }
+        return;
+    }
+
+    if (ins == 0xB0 || ins == 0xB1) {
+        int ef = current_ef;
+        size_t offset;
+        if (ins == 0xB0 && (p1 & 0x80)) {
+            // short EF identifier, offset is P2
+            ef = find_sfi(p1 & 0x1F);
+            if (ef == -1) {
+                response.assign(SW_FILE_NOT_FOUND, 2);
+                return;
+            }
+            offset = p2;
+        } else if (ins == 0xB0) {
+            offset = ((p1 & 0x7F) << 8) | p2;
+        } else {
+            // offset data object 54
+            if (lc < 3 || lc > 6 || data[0] != 0x54 || data[1] != lc - 2) {
+                response.assign(SW_WRONG_LENGTH, 2);
+                return;
+            }
+            offset = 0;
+            for (size_t i = 2; i < lc; i++) {
+                offset = (offset << 8) | data[i];
+            }
+        }
+
+        if (ef == -1) {
+            response.assign(SW_NO_CURRENT_EF, 2);
+            return;
+        }
+        if (nodes[ef].type != FSNodeTransparent) {
+            response.assign(SW_INCOMPATIBLE_FILE, 2);
+            return;
+        }
+        make_current(ef);
+
+        const FSNode & n = nodes[ef];
+        if (offset > n.size() || (offset == n.size() && n.size() != 0)) {
+            response.assign(SW_WRONG_P1P2, 2);
+            return;
+        }
+        if (!has_le) {
+            response.assign(SW_WRONG_LENGTH, 2);
+            return;
+        }
+        const Byte * contents = n.file ? n.file->data() + offset : 0;
+        size_t available = n.size() - offset;
+
+        if (ins == 0xB0) {
+            size_t size = std::min(le, available);
+            answer_data(contents, size, le, size < le, response);
+            return;
+        }
+
+        // data in discretionary data object 53, Le counts its header too
+        size_t size = 0;
+        for (size_t header = 2; header <= 4; header++) {
+            if (le <= header) {
+                break;
+            }
+            size_t s = std::min(le - header, available);
+            size_t needed = (s < 0x80) ? 2 : (s < 0x100 ? 3 : 4);
+            if (needed == header && s > size) {
+                size = s;
+            }
+        }
+        Bytes wrapped;
+        wrapped.push_back(0x53);
+        if (size >= 0x100) {
+            wrapped.push_back(0x82);
+            wrapped.push_back(size >> 8);
+        } else if (size >= 0x80) {
+            wrapped.push_back(0x81);
+        }
+        wrapped.push_back(size & 0xFF);
+        wrapped.append(contents, size);
+        if (protocol == 0) {
+            answer_data(wrapped, response);
+        } else {
+            response.assign(wrapped);
+            response.append(size == available && wrapped.size() < le ? SW_END_OF_FILE : SW_OK, 2);
+        }
+        return;
+    }
+
+    if (ins == 0xB2) {
+        // record P1 of current EF (P2 04) or EF with short identifier
+        int ef = current_ef;
+        if ((p2 & 0x07) != 0x04) {
+            response.assign(SW_WRONG_P1P2, 2);
+            return;
+        }
+        if (p2 >> 3) {
+            ef = find_sfi(p2 >> 3);
+            if (ef == -1) {
+                response.assign(SW_FILE_NOT_FOUND, 2);
+                return;
+            }
+        }
+        if (ef == -1) {
+            response.assign(SW_NO_CURRENT_EF, 2);
+            return;
+        }
+        if (nodes[ef].type != FSNodeRecords) {
+            response.assign(SW_INCOMPATIBLE_FILE, 2);
+            return;
+        }
+        make_current(ef);
+
+        const std::vector<Bytes> & records = nodes[ef].records;
+        if (p1 == 0 || p1 > records.size()) {
+            response.assign(SW_RECORD_NOT_FOUND, 2);
+            return;
+        }
+        const Bytes & record = records[p1 - 1];
+        if (!has_le || (le != record.size() && (protocol == 0 || le != 0x100))) {
+            // Le 00 reads the whole record with T=1
+            response.push_back(0x6C);
+            response.push_back(static_cast<Byte>(record.size()));
+            return;
+        }
+        response.assign(record);
+        response.append(SW_OK, 2);
+        return;
+    }
+
+    response.assign(SW_INS_NOT_SUPPORTED, 2);
+}
+
+VirtualFileSystemCard::VirtualFileSystemCard()
+{
+    p = new Private;
+    p->protocol = 0;
+    p->extended_length = false;
+    p->latency = 0;
+    p->apdus = 0;
+    p->pending_offset = 0;
+    p->clear();
+}
+
+VirtualFileSystemCard::~VirtualFileSystemCard()
+{
+    delete p;
+}
+
+bool VirtualFileSystemCard::load(const std::string & path)
+{
+    p->clear();
+    try {
+        if (p->load_dir(path, 0)) {
+            return true;
+        }
+    } catch (APDUParseError & e) {
+        PRINT_DEBUG("[D] Broken record in virtual card directory: " << e.what());
+    }
+    p->clear();
+    return false;
+}
+
+void VirtualFileSystemCard::set_protocol(int protocol)
+{
+    p->protocol = (protocol == 1) ? 1 : 0;
+}
+
+void VirtualFileSystemCard::set_extended_length(bool enabled)
+{
+    p->extended_length = enabled;
+}
+
+void VirtualFileSystemCard::set_latency(unsigned long latency)
+{
+    p->latency = latency;
+}
+
+unsigned long VirtualFileSystemCard::apdus() const
+{
+    return p->apdus;
+}
+
+Bytes VirtualFileSystemCard::atr()
+{
+    if (p->protocol == 1) {
+        return Bytes(ATR_T1, sizeof(ATR_T1));
+    }
+    return Bytes(ATR_T0, sizeof(ATR_T0));
+}
+
+void VirtualFileSystemCard::power_up()
+{
+    p->current_df = 0;
+    p->current_ef = -1;
+    p->pending.clear();
+}
+
+void VirtualFileSystemCard::transmit(const Byte * command, size_t command_size, Bytes & response)
+{
+    p->apdus++;
+    if (p->latency != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(p->latency));
+    }
+    p->answer(command, command_size, response);
+}
+
+}
@@ -0,0 +1,612 @@
+/*
+ * Copyright (c) 2017, Sergey Stolyarov <sergei@regolit.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file virtualmifare.cpp
+ * @author Sergey Stolyarov <sergei@regolit.com>
+ *
+ * MIFARE Classic card emulation, access conditions are from MF1S50yyX
+ * datasheet, section 8.7.
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <memory>
+
+#include "../include/xpcsc.hpp"
+#include "debug.hpp"
+
+namespace xpcsc {
+
+static const size_t KEY_SIZE = 6;
+static const size_t BLOCK_SIZE = 16;
+static const Byte KEY_SLOTS = 2;
+
+static const Byte A = MifareAccessKeyA;
+static const Byte B = MifareAccessKeyB;
+static const Byte AB = MifareAccessKeyA | MifareAccessKeyB;
+
+enum DataOperation {
+    DataRead = 0,
+    DataWrite,
+    DataIncrement,
+    // decrement, transfer and restore
+    DataDecrement
+};
+
+// keys allowed for data block operations, indexed by C1C2C3 value
+static const Byte DATA_ACCESS[8][4] = {
+    {AB, AB, AB, AB},   // 000, transport configuration
+    {AB, 0,  0,  AB},   // 001, value block
+    {AB, 0,  0,  0},    // 010
+    {B,  B,  0,  0},    // 011
+    {AB, B,  0,  0},    // 100
+    {B,  0,  0,  0},    // 101
+    {AB, B,  B,  AB},   // 110, value block
+    {0,  0,  0,  0}     // 111
+};
+
+enum TrailerPart {
+    TrailerKeyAWrite = 0,
+    TrailerAccessRead,
+    TrailerAccessWrite,
+    TrailerKeyBRead,
+    TrailerKeyBWrite
+};
+
+// keys allowed for sector trailer parts, indexed by C1C2C3 value
+static const Byte TRAILER_ACCESS[8][5] = {
+    {A, A,  0, A, A},   // 000
+    {A, A,  A, A, A},   // 001, transport configuration
+    {0, A,  0, A, 0},   // 010
+    {B, AB, B, 0, B},   // 011
+    {B, AB, 0, 0, B},   // 100
+    {0, AB, B, 0, 0},   // 101
+    {0, AB, 0, 0, 0},   // 110
+    {0, AB, 0, 0, 0}    // 111
+};
+
+static const Byte SW_OK[] = {0x90, 0x00};
+static const Byte SW_FAILED[] = {0x63, 0x00};
+static const Byte SW_WRONG_LENGTH[] = {0x67, 0x00};
+static const Byte SW_INS_NOT_SUPPORTED[] = {0x6D, 0x00};
+static const Byte SW_CLA_NOT_SUPPORTED[] = {0x6E, 0x00};
+
+struct VirtualMifareCard::Private
+{
+    Byte sectors;
+    Bytes uid;
+    Bytes image;
+
+    unsigned long latency;
+    bool multi_block;
+
+    // reader key slots
+    Byte keys[KEY_SLOTS][KEY_SIZE];
+    bool key_loaded[KEY_SLOTS];
+
+    bool authenticated;
+    Byte sector;
+    Byte key_access;
+
+    unsigned long apdus;
+    unsigned long failures;
+
+    Byte * block(Byte number) {
+        return &image[number * BLOCK_SIZE];
+    }
+
+    Byte blocks() const {
+        return mifare_sector_first_block(sectors - 1) + mifare_sector_blocks(sectors - 1) - 1;
+    }
+
+    Byte * trailer(Byte sector) {
+        return block(mifare_sector_first_block(sector) + mifare_sector_blocks(sector) - 1);
+    }
+
+    bool is_trailer(Byte number) const {
+        Byte s = mifare_block_sector(number);
+        return number == mifare_sector_first_block(s) + mifare_sector_blocks(s) - 1;
+    }
+
+    // C1C2C3 value of the block group, false if sector trailer access bits are broken
+    bool access_bits(Byte number, Byte & value) {
+        const Byte * t = trailer(mifare_block_sector(number));
+        if (!mifare_access_bits_valid(t[6], t[7], t[8])) {
+            return false;
+        }
+        BlocksAccessBits bits;
+        parse_access_bits(t[7], t[8], &bits);
+        value = bits[mifare_block_access_group(number)] & 0x07;
+        return true;
+    }
+
+    bool key_b_readable(Byte sector) {
+        Byte trailer_bits;
+        return access_bits(mifare_sector_first_block(sector) + mifare_sector_blocks(sector) - 1, trailer_bits)
+            && (TRAILER_ACCESS[trailer_bits][TrailerKeyBRead] & A);
+    }
+
+    // authenticated sector and key allow data block operation
+    bool data_allowed(Byte number, DataOperation op) {
+        Byte sector = mifare_block_sector(number);
+        Byte bits;
+        if (!authenticated || this->sector != sector || !access_bits(number, bits)) {
+            return false;
+        }
+        Byte keys = DATA_ACCESS[bits][op];
+        // readable key B is just data
+        if (key_b_readable(sector)) {
+            keys &= ~B;
+        }
+        return (keys & key_access) != 0;
+    }
+
+    bool trailer_allowed(Byte sector, TrailerPart part) {
+        Byte bits;
+        Byte number = mifare_sector_first_block(sector) + mifare_sector_blocks(sector) - 1;
+        if (!authenticated || this->sector != sector || !access_bits(number, bits)) {
+            return false;
+        }
+        Byte keys = TRAILER_ACCESS[bits][part];
+        if (key_b_readable(sector) && part != TrailerKeyAWrite) {
+            keys &= ~B;
+        }
+        return (keys & key_access) != 0;
+    }
+
+    bool read_block(Byte number, Bytes & data);
+    bool write_block(Byte number, const Byte * data);
+    bool read_value(Byte number, int32_t & value);
+    bool authenticate(Byte number, Byte key_type, Byte slot);
+    bool value_operation(const Byte * command, size_t command_size);
+    void answer(const Byte * command, size_t command_size, Bytes & response);
+};
+
+bool VirtualMifareCard::Private::read_block(Byte number, Bytes & data)
+{
+    if (!is_trailer(number)) {
+        if (!data_allowed(number, DataRead)) {
+            return false;
+        }
+        data.append(block(number), BLOCK_SIZE);
+        return true;
+    }
+
+    Byte sector = mifare_block_sector(number);
+    if (!trailer_allowed(sector, TrailerAccessRead)) {
+        return false;
+    }
+    // key A is never readable
+    const Byte * t = block(number);
+    data.append(KEY_SIZE, 0);
+    data.append(t + 6, 4);
+    if (trailer_allowed(sector, TrailerKeyBRead)) {
+        data.append(t + 10, KEY_SIZE);
+    } else {
+        data.append(KEY_SIZE, 0);
+    }
+    return true;
+}
+
+bool VirtualMifareCard::Private::write_block(Byte number, const Byte * data)
+{
+    // manufacturer block
+    if (number == 0) {
+        return false;
+    }
+
+    if (!is_trailer(number)) {
+        if (!data_allowed(number, DataWrite)) {
+            return false;
+        }
+        memcpy(block(number), data, BLOCK_SIZE);
+        return true;
+    }
+
+    // parts that can't be written with current key are kept
+    Byte sector = mifare_block_sector(number);
+    bool key_a = trailer_allowed(sector, TrailerKeyAWrite);
+    bool access = trailer_allowed(sector, TrailerAccessWrite);
+    bool key_b = trailer_allowed(sector, TrailerKeyBWrite);
+    if (!key_a && !access && !key_b) {
+        return false;
+    }
+
+    Byte * t = block(number);
+    if (key_a) {
+        memcpy(t, data, KEY_SIZE);
+    }
+    if (access) {
+        memcpy(t + 6, data + 6, 4);
+    }
+    if (key_b) {
+        memcpy(t + 10, data + 10, KEY_SIZE);
+    }
+    return true;
+}
+
+bool VirtualMifareCard::Private::read_value(Byte number, int32_t & value)
+{
+    if (is_trailer(number) || !data_allowed(number, DataRead)) {
+        return false;
+    }
+
+    const Byte * b = block(number);
+    uint32_t v = b[0] | (b[1] << 8) | (b[2] << 16) | (uint32_t(b[3]) << 24);
+    if (Bytes(b, BLOCK_SIZE) != mifare_value_block(static_cast<int32_t>(v), b[12])) {
+        return false;
+    }
+    value = static_cast<int32_t>(v);
+    return true;
+}
+
+bool VirtualMifareCard::Private::authenticate(Byte number, Byte key_type, Byte slot)
+{
+    authenticated = false;
+    if (number > blocks() || slot >= KEY_SLOTS || !key_loaded[slot]
+        || (key_type != MifareKeyA && key_type != MifareKeyB))
+    {
+        return false;
+    }
+
+    Byte s = mifare_block_sector(number);
+    const Byte * t = trailer(s);
+    const Byte * key = (key_type == MifareKeyA) ? t : t + 10;
+    if (memcmp(key, keys[slot], KEY_SIZE) != 0) {
+        return false;
+    }
+
+    authenticated = true;
+    sector = s;
+    key_access = (key_type == MifareKeyA) ? A : B;
+    return true;
+}
+
+// FF D7 00 BLOCK 05 OP VALUE or FF D7 00 SOURCE 02 03 TARGET
+bool VirtualMifareCard::Private::value_operation(const Byte * command, size_t command_size)
+{
+    Byte number = command[3];
+    if (number > blocks() || is_trailer(number)) {
+        return false;
+    }
+
+    if (command_size == 7 && command[4] == 0x02 && command[5] == 0x03) {
+        // restore to internal register, then transfer
+        Byte target = command[6];
+        int32_t value;
+        if (target > blocks() || is_trailer(target) || mifare_block_sector(target) != mifare_block_sector(number)
+            || !data_allowed(number, DataDecrement) || !data_allowed(target, DataDecrement)
+            || !read_value(number, value))
+        {
+            return false;
+        }
+        memcpy(block(target), mifare_value_block(value, block(number)[12]).data(), BLOCK_SIZE);
+        return true;
+    }
+
+    if (command_size != 10 || command[4] != 0x05) {
+        return false;
+    }
+
+    int32_t amount = static_cast<int32_t>((uint32_t(command[6]) << 24) | (command[7] << 16)
+        | (command[8] << 8) | command[9]);
+    int32_t value;
+
+    switch (command[5]) {
+    case 0x00:
+        // store: block is formatted as value block
+        return write_block(number, mifare_value_block(amount, number).data());
+    case 0x01:
+        if (!data_allowed(number, DataIncrement) || !data_allowed(number, DataDecrement)
+            || !read_value(number, value))
+        {
+            return false;
+        }
+        value = static_cast<int32_t>(static_cast<uint32_t>(value) + static_cast<uint32_t>(amount));
+        break;
+    case 0x02:
+        if (!data_allowed(number, DataDecrement) || !read_value(number, value)) {
+            return false;
+        }
+        value = static_cast<int32_t>(static_cast<uint32_t>(value) - static_cast<uint32_t>(amount));
+        break;
+    default:
+        return false;
+    }
+
+    memcpy(block(number), mifare_value_block(value, block(number)[12]).data(), BLOCK_SIZE);
+    return true;
+}
+
+void VirtualMifareCard::Private::answer(const Byte * command, size_t command_size, Bytes & response)
+{
+    response.clear();
+
+    if (command_size < 5) {
+        response.assign(SW_WRONG_LENGTH, 2);
+        return;
+    }
+    if (command[0] != 0xFF) {
+        response.assign(SW_CLA_NOT_SUPPORTED, 2);
+        return;
+    }
+
+    bool ok = false;
+    Byte number = command[3];
+
+    switch (command[1]) {
+    case 0xCA:
+        // GET DATA, UID
+        response.assign(uid);
+        ok = true;
+        break;
+    case 0x82:
+        // LOAD KEYS
+        if (command_size == 11 && command[3] < KEY_SLOTS) {
+            memcpy(keys[command[3]], command + 5, KEY_SIZE);
+            key_loaded[command[3]] = true;
+            ok = true;
+        }
+        break;
+    case 0x86:
+        // GENERAL AUTHENTICATE
+        if (command_size == 10 && command[5] == 0x01) {
+            ok = authenticate(command[7], command[8], command[9]);
+        }
+        break;
+    case 0xB0: {
+        // READ BINARY, Le is 16 bytes per block
+        Byte le = command[4];
+        Byte count = le / BLOCK_SIZE;
+        if (le == 0 || le % BLOCK_SIZE != 0 || number > blocks()
+            || (count > 1 && !multi_block)
+            || mifare_block_sector(number) != mifare_block_sector(number + count - 1))
+        {
+            break;
+        }
+        ok = true;
+        for (Byte i = 0; i < count && ok; i++) {
+            ok = read_block(number + i, response);
+        }
+        break;
+    }
+    case 0xD6:
+        // UPDATE BINARY
+        if (command_size == 5 + BLOCK_SIZE && command[4] == BLOCK_SIZE && number <= blocks()) {
+            ok = write_block(number, command + 5);
+        }
+        break;
+    case 0xB1: {
+        // READ VALUE BLOCK, MSB first
+        int32_t value;
+        if (number <= blocks() && read_value(number, value)) {
+            uint32_t v = static_cast<uint32_t>(value);
+            for (int i = 3; i >= 0; i--) {
+                response.push_back((v >> (8 * i)) & 0xFF);
+            }
+            ok = true;
+        }
+        break;
+    }
+    case 0xD7:
+        // VALUE BLOCK OPERATION, RESTORE VALUE BLOCK
+        ok = value_operation(command, command_size);
+        break;
+    default:
+        response.assign(SW_INS_NOT_SUPPORTED, 2);
+        failures++;
+        return;
+    }
+
+    if (!ok) {
+        // card halts on any failed command
+        authenticated = false;
+        failures++;
+        response.assign(SW_FAILED, 2);
+        return;
+    }
+    response.append(SW_OK, 2);
+}
+
+VirtualMifareCard::VirtualMifareCard(Byte sectors, const Bytes & uid)
+{
+    p = new Private;
+    p->sectors = (sectors == 5 || sectors == 40) ? sectors : 16;
+    p->uid = uid.substr(0, 4);
+    p->uid.resize(4, 0);
+    p->latency = 0;
+    p->multi_block = true;
+    memset(p->keys, 0, sizeof(p->keys));
+    memset(p->key_loaded, 0, sizeof(p->key_loaded));
+    p->authenticated = false;
+    p->apdus = 0;
+    p->failures = 0;
+
+    // blank card
+    p->image.assign((p->blocks() + 1) * BLOCK_SIZE, 0);
+    static const Byte transport_trailer[BLOCK_SIZE] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x80, 0x69,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    for (Byte s = 0; s < p->sectors; s++) {
+        memcpy(p->trailer(s), transport_trailer, BLOCK_SIZE);
+    }
+
+    // manufacturer block: UID, BCC, SAK, ATQA
+    Byte * b = p->block(0);
+    memcpy(b, p->uid.data(), 4);
+    b[4] = b[0] ^ b[1] ^ b[2] ^ b[3];
+    b[5] = (p->sectors == 40) ? 0x18 : (p->sectors == 5 ? 0x09 : 0x08);
+    b[6] = (p->sectors == 40) ? 0x02 : 0x04;
+    b[7] = 0x00;
+}
+
+VirtualMifareCard::~VirtualMifareCard()
+{
+    delete p;
+}
+
+bool VirtualMifareCard::load_image(const Bytes & image)
+{
+    if (image.size() != p->image.size()) {
+        return false;
+    }
+    p->image = image;
+    return true;
+}
+
+const Bytes & VirtualMifareCard::image() const
+{
+    return p->image;
+}
+
+void VirtualMifareCard::set_latency(unsigned long latency)
+{
+    p->latency = latency;
+}
+
+void VirtualMifareCard::set_multi_block_read(bool enabled)
+{
+    p->multi_block = enabled;
+}
+
+unsigned long VirtualMifareCard::apdus() const
+{
+    return p->apdus;
+}
+
+unsigned long VirtualMifareCard::failures() const
+{
+    return p->failures;
+}
+
+Bytes VirtualMifareCard::atr()
+{
+    // PC/SC part 3 contactless storage card ATR, TCK is XOR of T0 to the last historical byte
+    Byte atr[] = {0x3B, 0x8F, 0x80, 0x01, 0x80, 0x4F, 0x0C, 0xA0, 0x00, 0x00, 0x03, 0x06, 0x03,
+        0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00};
+    atr[14] = (p->sectors == 40) ? 0x02 : (p->sectors == 5 ? 0x26 : 0x01);
+
+    Byte tck = 0;
+    for (size_t i = 1; i < sizeof(atr) - 1; i++) {
+        tck ^= atr[i];
+    }
+    atr[sizeof(atr) - 1] = tck;
+    return Bytes(atr, sizeof(atr));
+}
+
+void VirtualMifareCard::power_up()
+{
+    // reader keeps loaded keys
+    p->authenticated = false;
+}
+
+void VirtualMifareCard::transmit(const Byte * command, size_t command_size, Bytes & response)
+{
+    p->apdus++;
+    if (p->latency != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(p->latency));
+    }
+    p->answer(command, command_size, response);
+}
+
+static const char VIRTUAL_MIFARE_VARIABLE[] = "XPCSC_VIRTUAL_MIFARE";
+static const char VIRTUAL_MIFARE_READER[] = "Virtual MIFARE Classic reader";
+// UID of blank card
+static const Byte VIRTUAL_MIFARE_UID[] = {0x04, 0xA1, 0xB2, 0xC3};
+
+struct VirtualMifareImageFile::Private
+{
+    std::string path;
+    std::unique_ptr<VirtualMifareCard> card;
+};
+
+VirtualMifareImageFile::VirtualMifareImageFile()
+{
+    p = new Private;
+}
+
+VirtualMifareImageFile::~VirtualMifareImageFile()
+{
+    if (p->card) {
+        std::ofstream file(p->path, std::ios::binary | std::ios::trunc);
+        const Bytes & image = p->card->image();
+        file.write(reinterpret_cast<const char *>(image.data()), image.size());
+        if (file.fail()) {
+            PRINT_DEBUG("[D] Cannot write virtual card image: " << p->path);
+        }
+    }
+    delete p;
+}
+
+bool VirtualMifareImageFile::attach(Connection & c)
+{
+    const char * path = getenv(VIRTUAL_MIFARE_VARIABLE);
+    if (path == 0 || path[0] == 0) {
+        return false;
+    }
+
+    Bytes image;
+    std::ifstream file(path, std::ios::binary);
+    if (file.is_open()) {
+        std::stringstream data;
+        data << file.rdbuf();
+        if (file.bad()) {
+            throw ConnectionError("Cannot read virtual card image");
+        }
+        const std::string & s = data.str();
+        image.assign(s.begin(), s.end());
+    }
+
+    Byte sectors = 16;
+    Bytes uid(VIRTUAL_MIFARE_UID, sizeof(VIRTUAL_MIFARE_UID));
+    if (image.size() != 0) {
+        if (image.size() == 5 * 4 * BLOCK_SIZE) {
+            sectors = 5;
+        } else if (image.size() == 4096) {
+            sectors = 40;
+        } else if (image.size() != 16 * 4 * BLOCK_SIZE) {
+            throw ConnectionError("Virtual card image size must be 320, 1024 or 4096 bytes");
+        }
+        uid = image.substr(0, 4);
+    }
+
+    std::unique_ptr<VirtualMifareCard> card(new VirtualMifareCard(sectors, uid));
+    if (image.size() != 0) {
+        card->load_image(image);
+    }
+    p->path = path;
+    p->card = std::move(card);
+    c.attach_virtual_card(VIRTUAL_MIFARE_READER, p->card.get());
+    return true;
+}
+
+}